@@ -163,6 +163,7 @@ macro(pism_find_prerequisites)
   find_package (GSL REQUIRED)
   find_package (NetCDF REQUIRED)
   find_package (FFTW REQUIRED)
+  find_package (Threads REQUIRED)
   find_package (HDF5 COMPONENTS C HL)
 
   # Optional libraries
@@ -238,7 +239,8 @@ macro(pism_set_dependencies)
     ${NETCDF_LIBRARIES}
     ${MPI_C_LIBRARIES}
     ${HDF5_LIBRARIES}
-    ${HDF5_HL_LIBRARIES})
+    ${HDF5_HL_LIBRARIES}
+    ${CMAKE_THREAD_LIBS_INIT})
 
   # optional libraries
   if (Pism_USE_JANSSON)
@@ -43,16 +43,27 @@ AgeColumnSystem::AgeColumnSystem(const std::vector<double>& storage_grid,
   m_nu = m_dt / m_dz; // derived constant
 }
 
-void AgeColumnSystem::init(int i, int j, double thickness) {
+//! Initialize the system for the column (i, j).
+/*!
+  If `velocity` is not NULL, ice velocity on the fine grid is copied from it instead of
+  being interpolated from the 3D fields. `velocity` has to be initialized using the same
+  column.
+ */
+void AgeColumnSystem::init(int i, int j, double thickness,
+                           const columnSystemCtx *velocity) {
   init_column(i, j, thickness);
 
   if (m_ks == 0) {
     return;
   }
 
-  coarse_to_fine(m_u3, i, j, &m_u[0]);
-  coarse_to_fine(m_v3, i, j, &m_v[0]);
-  coarse_to_fine(m_w3, i, j, &m_w[0]);
+  if (velocity != NULL) {
+    copy_velocity(*velocity);
+  } else {
+    coarse_to_fine(m_u3, i, j, &m_u[0]);
+    coarse_to_fine(m_v3, i, j, &m_v[0]);
+    coarse_to_fine(m_w3, i, j, &m_w[0]);
+  }
 
   coarse_to_fine(m_age3, m_i, m_j,   &m_A[0]);
   coarse_to_fine(m_age3, m_i, m_j+1, &m_A_n[0]);
@@ -35,7 +35,8 @@ public:
                   const IceModelVec3 &v3,
                   const IceModelVec3 &w3);
 
-  void init(int i, int j, double thickness);
+  void init(int i, int j, double thickness,
+            const columnSystemCtx *velocity = NULL);
 
   void solve(std::vector<double> &x);
 protected:
@@ -19,10 +19,14 @@
 
 #include "AgeModel.hh"
 
+#include <cmath>                // floor, ceil, fabs
+#include <algorithm>            // std::max, std::min
+
 #include "pism/age/AgeColumnSystem.hh"
 #include "pism/util/error_handling.hh"
 #include "pism/util/Vars.hh"
 #include "pism/util/io/PIO.hh"
+#include "pism/util/pism_utilities.hh"
 
 namespace pism {
 
@@ -58,8 +62,21 @@ void AgeModelInputs::check() const {
 AgeModel::AgeModel(IceGrid::ConstPtr grid, stressbalance::StressBalance *stress_balance)
   : Component_TS(grid), m_stress_balance(stress_balance) {
 
+  m_semi_lagrangian = m_config->get_boolean("age.semi_lagrangian");
+
   // FIXME: should be able to use width=1...
-  const unsigned int WIDE_STENCIL = m_config->get_double("grid.max_stencil_width");
+  unsigned int WIDE_STENCIL = m_config->get_double("grid.max_stencil_width");
+
+  if (m_semi_lagrangian) {
+    // Departure points may be up to (width - 1) grid cells away, so a wider halo allows
+    // longer sub-steps. The halo cannot be wider than the smallest sub-domain.
+    const double
+      width      = m_config->get_double("age.semi_lagrangian_stencil_width"),
+      min_domain = GlobalMin(m_grid->com, std::min(m_grid->xm(), m_grid->ym()));
+
+    WIDE_STENCIL = std::max(WIDE_STENCIL,
+                            (unsigned int)std::max(std::min(width, min_domain), 2.0));
+  }
 
   m_ice_age.create(m_grid, "age", WITH_GHOSTS, WIDE_STENCIL);
   m_ice_age.set_attrs("model_state", "age of ice", "s", "" /* no standard name*/);
@@ -70,6 +87,10 @@ AgeModel::AgeModel(IceGrid::ConstPtr grid, stressbalance::StressBalance *stress_
   m_work.set_attrs("internal", "new values of age during time step", "s", "");
 }
 
+AgeModel::~AgeModel() {
+  // empty (defined here because AgeColumnSystem is an incomplete type in AgeModel.hh)
+}
+
 /*!
 Let \f$\tau(t,x,y,z)\f$ be the age of the ice.  Denote the three-dimensional
 velocity field within the ice fluid as \f$(u,v,w)\f$.  The age equation
@@ -111,6 +132,46 @@ void AgeModel::update(double t, double dt, const AgeModelInputs &inputs) {
 
   inputs.check();
 
+  if (m_semi_lagrangian) {
+    update_semi_lagrangian(dt, inputs);
+    return;
+  }
+
+  const IceModelVec2S &ice_thickness = *inputs.ice_thickness;
+
+  AgeColumnSweepGuard sweep_guard(this);
+  begin_column_sweep(dt, inputs);
+
+  IceModelVec::AccessList list(ice_thickness);
+
+  ParallelSection loop(m_grid->com);
+  try {
+    for (const auto &c : m_columns.icy()) {
+      update_column(c.i, c.j, ice_thickness(c.i, c.j));
+    }
+  } catch (...) {
+    loop.failed();
+  }
+  loop.check();
+
+  end_column_sweep();
+}
+
+/*!
+ * Prepare to update age column by column.
+ *
+ * Sets the age in ice-free columns. The caller has to call update_column() for every
+ * column in m_columns.icy(), i.e. every owned column containing at least one fine grid
+ * level of ice, and then end_column_sweep().
+ */
+void AgeModel::begin_column_sweep(double dt, const AgeModelInputs &inputs) {
+  inputs.check();
+
+  if (m_semi_lagrangian) {
+    throw RuntimeError(PISM_ERROR_LOCATION,
+                       "the semi-Lagrangian age scheme does not support column sweeps");
+  }
+
   const IceModelVec2S &ice_thickness = *inputs.ice_thickness;
 
   const IceModelVec3
@@ -118,54 +179,225 @@ void AgeModel::update(double t, double dt, const AgeModelInputs &inputs) {
     &v3 = *inputs.v3,
     &w3 = *inputs.w3;
 
-  AgeColumnSystem system(m_grid->z(), "age",
-                         m_grid->dx(), m_grid->dy(), dt,
-                         m_ice_age, u3, v3, w3); // linear system to solve in each column
+  // linear system to solve in each column
+  m_column_system.reset(new AgeColumnSystem(m_grid->z(), "age",
+                                            m_grid->dx(), m_grid->dy(), dt,
+                                            m_ice_age, u3, v3, w3));
 
-  size_t Mz_fine = system.z().size();
-  std::vector<double> x(Mz_fine);   // space for solution
+  m_column_solution.resize(m_column_system->z().size());
 
-  IceModelVec::AccessList list{&ice_thickness, &u3, &v3, &w3, &m_ice_age, &m_work};
+  m_sweep_access.reset(new IceModelVec::AccessList{&ice_thickness, &u3, &v3, &w3,
+        &m_ice_age, &m_work});
 
-  unsigned int Mz = m_grid->Mz();
+  m_columns.update(ice_thickness, m_column_system->dz());
 
-  ParallelSection loop(m_grid->com);
-  try {
+  // if no ice, set the entire column to zero age
+  for (const auto &c : m_columns.ice_free()) {
+    m_work.set_column(c.i, c.j, 0.0);
+  }
+}
+
+/*!
+ * Update age in the column (i, j).
+ *
+ * If `velocity` is not NULL, ice velocity is copied from this column system (which has to
+ * be initialized using the same column) instead of being interpolated again.
+ */
+void AgeModel::update_column(int i, int j, double ice_thickness,
+                             const columnSystemCtx *velocity) {
+  AgeColumnSystem &system = *m_column_system;
+  std::vector<double> &x = m_column_solution;
+
+  system.init(i, j, ice_thickness, velocity);
+
+  if (system.ks() == 0) {
+    // this column is in m_columns.ice_free() and was set in begin_column_sweep()
+    return;
+  }
+
+  // general case: solve advection PDE
+
+  // solve the system for this column; call checks that params set
+  system.solve(x);
+
+  // put solution in IceModelVec3
+  system.fine_to_coarse(x, i, j, m_work);
+
+  // Ensure that the age of the ice is non-negative.
+  //
+  // FIXME: this is a kludge. We need to ensure that our numerical method has the maximum
+  // principle instead. (We may still need this for correctness, though.)
+  const unsigned int Mz = m_grid->Mz();
+  double *column = m_work.get_column(i, j);
+  for (unsigned int k = 0; k < Mz; ++k) {
+    if (column[k] < 0.0) {
+      column[k] = 0.0;
+    }
+  }
+}
+
+//! Finish a column sweep and make new values of age available.
+void AgeModel::end_column_sweep() {
+  m_sweep_access.reset();
+  m_column_system.reset();
+
+  m_work.update_ghosts(m_ice_age);
+}
+
+//! Abandon a column sweep (if any), leaving the age unchanged.
+void AgeModel::cancel_column_sweep() {
+  m_sweep_access.reset();
+  m_column_system.reset();
+}
+
+AgeColumnSweepGuard::AgeColumnSweepGuard(AgeModel *age)
+  : m_age(age) {
+  // empty
+}
+
+AgeColumnSweepGuard::~AgeColumnSweepGuard() {
+  if (m_age != NULL) {
+    m_age->cancel_column_sweep();
+  }
+}
+
+/*!
+ * Semi-Lagrangian age transport.
+ *
+ * The age equation says that age increases by @f$ \Delta t @f$ along trajectories, so
+ *
+ * @f[ \tau(t + \Delta t, \mathbf{x}) = \tau(t, \mathbf{x}_d) + \Delta t, @f]
+ *
+ * where @f$ \mathbf{x}_d = \mathbf{x} - \Delta t\, (u, v, w) @f$ is the departure point
+ * (first order in time, using the velocity at the arrival point). The age at the departure
+ * point is computed using bilinear interpolation in the horizontal and linear interpolation
+ * in the vertical, so the result is non-negative.
+ *
+ * If the trajectory crosses the ice surface (or the base, where basal ice freezes on)
+ * during the step, the new age is the time spent in the ice. This corresponds to the zero
+ * age boundary condition of the upwinding scheme.
+ *
+ * This scheme does not restrict the time step. Departure points have to be within the
+ * ghost halo of the age field, though, so a long step is split into sub-steps moving ice
+ * by at most (stencil width - 1) grid cells, updating ghosts in between. The halo width is
+ * set by `age.semi_lagrangian_stencil_width`, so each sub-step can be several times longer
+ * than the CFL-limited step of the upwinding scheme.
+ *
+ * Note that the time step is still limited by the energy balance model (unless it is
+ * disabled): its horizontal advection is explicit.
+ */
+void AgeModel::update_semi_lagrangian(double dt, const AgeModelInputs &inputs) {
+
+  const IceModelVec2S &ice_thickness = *inputs.ice_thickness;
+
+  const IceModelVec3
+    &u3 = *inputs.u3,
+    &v3 = *inputs.v3,
+    &w3 = *inputs.w3;
+
+  const int
+    Mx = m_grid->Mx(),
+    My = m_grid->My();
+  const unsigned int Mz = m_grid->Mz();
+  const double
+    dx = m_grid->dx(),
+    dy = m_grid->dy();
+  const std::vector<double> &z = m_grid->z();
+
+  IceModelVec::AccessList list{&ice_thickness, &u3, &v3, &w3, &m_ice_age, &m_work};
+
+  // compute the number of sub-steps
+  int N = 1;
+  {
+    double max_shift = 0.0;
     for (Points p(*m_grid); p; p.next()) {
       const int i = p.i(), j = p.j();
 
-      system.init(i, j, ice_thickness(i, j));
+      const unsigned int ks = m_grid->kBelowHeight(ice_thickness(i, j));
+
+      const double
+        *u = u3.get_column(i, j),
+        *v = v3.get_column(i, j);
+
+      for (unsigned int k = 0; k <= ks; ++k) {
+        max_shift = std::max(max_shift,
+                             std::max(fabs(u[k]) * dt / dx, fabs(v[k]) * dt / dy));
+      }
+    }
+    max_shift = GlobalMax(m_grid->com, max_shift);
+
+    const double shift_limit = m_ice_age.get_stencil_width() - 1.0;
+    N = std::max(1, (int)ceil(max_shift / shift_limit));
+  }
+
+  const double h = dt / N;
 
-      if (system.ks() == 0) {
-        // if no ice, set the entire column to zero age
-        m_work.set_column(i, j, 0.0);
-      } else {
-        // general case: solve advection PDE
+  for (int n = 0; n < N; ++n) {
+    ParallelSection loop(m_grid->com);
+    try {
+      for (Points p(*m_grid); p; p.next()) {
+        const int i = p.i(), j = p.j();
 
-        // solve the system for this column; call checks that params set
-        system.solve(x);
+        const double H = ice_thickness(i, j);
+        const unsigned int ks = m_grid->kBelowHeight(H);
 
-        // put solution in IceModelVec3
-        system.fine_to_coarse(x, i, j, m_work);
+        double *result = m_work.get_column(i, j);
 
-        // Ensure that the age of the ice is non-negative.
-        //
-        // FIXME: this is a kludge. We need to ensure that our numerical method has the maximum
-        // principle instead. (We may still need this for correctness, though.)
-        double *column = m_work.get_column(i, j);
-        for (unsigned int k = 0; k < Mz; ++k) {
-          if (column[k] < 0.0) {
-            column[k] = 0.0;
+        if (ks == 0) {
+          // if no ice, set the entire column to zero age
+          m_work.set_column(i, j, 0.0);
+          continue;
+        }
+
+        const double
+          *u = u3.get_column(i, j),
+          *v = v3.get_column(i, j),
+          *w = w3.get_column(i, j);
+
+        for (unsigned int k = 0; k <= ks; ++k) {
+          const double z_d = z[k] - h * w[k];
+
+          if (z_d > H) {
+            // this ice entered through the surface during this step
+            result[k] = h * (H - z[k]) / (z_d - z[k]);
+          } else if (z_d < 0.0) {
+            // this ice froze on at the base during this step
+            result[k] = h * z[k] / (z[k] - z_d);
+          } else {
+            // Departure point in grid units. Clipping prevents wrapping around at domain
+            // boundaries (DMDAs used by PISM are periodic).
+            const double
+              x_d = std::min(std::max(i - h * u[k] / dx, 0.0), Mx - 1.0),
+              y_d = std::min(std::max(j - h * v[k] / dy, 0.0), My - 1.0);
+
+            const int
+              i0 = floor(x_d),
+              j0 = floor(y_d);
+
+            const double
+              a = x_d - i0,
+              b = y_d - j0;
+
+            result[k] = ((1.0 - a) * (1.0 - b) * m_ice_age.getValZ(i0,     j0,     z_d) +
+                         a         * (1.0 - b) * m_ice_age.getValZ(i0 + 1, j0,     z_d) +
+                         (1.0 - a) * b         * m_ice_age.getValZ(i0,     j0 + 1, z_d) +
+                         a         * b         * m_ice_age.getValZ(i0 + 1, j0 + 1, z_d) +
+                         h);
           }
         }
+
+        // set age of ice above the surface to zero
+        for (unsigned int k = ks + 1; k < Mz; ++k) {
+          result[k] = 0.0;
+        }
       }
+    } catch (...) {
+      loop.failed();
     }
-  } catch (...) {
-    loop.failed();
-  }
-  loop.check();
+    loop.check();
 
-  m_work.update_ghosts(m_ice_age);
+    m_work.update_ghosts(m_ice_age);
+  }
 }
 
 const IceModelVec3 & AgeModel::age() const {
@@ -182,6 +414,11 @@ MaxTimestep AgeModel::max_timestep_impl(double t) const {
                                   " Cannot compute max. time step.");
   }
 
+  if (m_semi_lagrangian) {
+    // the semi-Lagrangian scheme does not restrict the time step
+    return MaxTimestep("age model");
+  }
+
   return MaxTimestep(m_stress_balance->max_timestep_cfl_3d().dt_max.value(), "age model");
 }
 
@@ -20,12 +20,17 @@
 #ifndef AGEMODEL_H
 #define AGEMODEL_H
 
+#include <memory>
+
 #include "pism/util/iceModelVec.hh"
+#include "pism/util/ColumnSystem.hh"
 #include "pism/util/Component.hh"
 #include "pism/stressbalance/StressBalance.hh"
 
 namespace pism {
 
+class AgeColumnSystem;
+
 class AgeModelInputs {
 public:
   AgeModelInputs();
@@ -44,16 +49,27 @@ public:
 class AgeModel : public Component_TS {
 public:
   AgeModel(IceGrid::ConstPtr grid, stressbalance::StressBalance *stress_balance);
+  ~AgeModel();
 
   using Component_TS::update;
   void update(double t, double dt, const AgeModelInputs &inputs);
 
+  // Column-by-column update, used to update age in the same sweep as another column
+  // model (see update()).
+  void begin_column_sweep(double dt, const AgeModelInputs &inputs);
+  void update_column(int i, int j, double ice_thickness,
+                     const columnSystemCtx *velocity = NULL);
+  void end_column_sweep();
+  void cancel_column_sweep();
+
   void init(const InputOptions &opts);
 
   const IceModelVec3 & age() const;
 protected:
   void update_impl(double t, double dt);
 
+  void update_semi_lagrangian(double dt, const AgeModelInputs &inputs);
+
   MaxTimestep max_timestep_impl(double t) const;
   void define_model_state_impl(const PIO &output) const;
   void write_model_state_impl(const PIO &output) const;
@@ -61,6 +77,31 @@ protected:
   IceModelVec3 m_ice_age;
   IceModelVec3 m_work;
   stressbalance::StressBalance *m_stress_balance;
+
+  //! true if the semi-Lagrangian scheme is used
+  bool m_semi_lagrangian;
+
+  //! lists of icy and ice-free columns
+  ColumnIndex m_columns;
+
+  //! column system and the access list used during a column sweep
+  std::unique_ptr<AgeColumnSystem> m_column_system;
+  std::unique_ptr<IceModelVec::AccessList> m_sweep_access;
+  std::vector<double> m_column_solution;
+};
+
+//! Cancels an unfinished AgeModel column sweep when it goes out of scope.
+/*!
+ * Callers of AgeModel::begin_column_sweep() use this to release resources held by the
+ * sweep if an exception is thrown before AgeModel::end_column_sweep() is called. Does
+ * nothing if `age` is NULL or the sweep was finished.
+ */
+class AgeColumnSweepGuard {
+public:
+  AgeColumnSweepGuard(AgeModel *age);
+  ~AgeColumnSweepGuard();
+private:
+  AgeModel *m_age;
 };
 
 } // end of namespace pism
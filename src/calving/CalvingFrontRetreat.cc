@@ -29,7 +29,8 @@
 namespace pism {
 
 CalvingFrontRetreat::CalvingFrontRetreat(IceGrid::ConstPtr g, unsigned int mask_stencil_width)
-  : Component_TS(g) {
+  : Component_TS(g),
+    m_front(g, 1, not m_config->get_boolean("calving.front_retreat.narrow_band")) {
 
   m_tmp.create(m_grid, "temporary_storage", WITH_GHOSTS, 1);
   m_tmp.set_attrs("internal", "additional mass loss at points near the calving front",
@@ -40,19 +41,80 @@ CalvingFrontRetreat::CalvingFrontRetreat(IceGrid::ConstPtr g, unsigned int mask_
   m_horizontal_calving_rate.set_time_independent(false);
   m_horizontal_calving_rate.metadata().set_string("glaciological_units", "m year-1");
 
-  m_mask.create(m_grid, "m_mask", WITH_GHOSTS, mask_stencil_width);
+  // FrontBand needs 2 ghosts
+  m_mask.create(m_grid, "m_mask", WITH_GHOSTS, std::max(mask_stencil_width, 2U));
   m_mask.set_attrs("internal", "cell type mask", "", "");
 
   m_surface_topography.create(m_grid, "m_surface_topography", WITH_GHOSTS, 1);
   m_surface_topography.set_attrs("internal", "surface topography", "m", "surface_altitude");
 
   m_restrict_timestep = m_config->get_boolean("calving.front_retreat.use_cfl");
+
+  // These fields are updated at points near the calving front only (see
+  // zero_outside_band()).
+  m_tmp.set(0.0);
+  m_horizontal_calving_rate.set(0.0);
 }
 
 CalvingFrontRetreat::~CalvingFrontRetreat() {
   // empty
 }
 
+/*!
+ * Copy the cell type `mask` to m_mask (to get more ghosts) and update the list of points
+ * near the calving front.
+ *
+ * Sets m_mask to MASK_ICE_FREE_OCEAN outside the modeling domain. This is needed to avoid
+ * "wrapping around" in regional setups.
+ */
+void CalvingFrontRetreat::update_front(const IceModelVec2CellType &mask) const {
+  m_mask.copy_from(mask);
+
+  if (not m_config->get_boolean("calving.front_retreat.wrap_around")) {
+
+    IceModelVec::AccessList list(m_mask);
+
+    const int Mx = m_grid->Mx();
+    const int My = m_grid->My();
+
+    ParallelSection loop(m_grid->com);
+    try {
+      for (PointsWithGhosts p(*m_grid); p; p.next()) {
+        const int i = p.i(), j = p.j();
+
+        if (i < 0 or i >= Mx or j < 0 or j >= My) {
+          m_mask(i, j) = MASK_ICE_FREE_OCEAN;
+        }
+      }
+    } catch (...) {
+      loop.failed();
+    }
+    loop.check();
+  }
+
+  m_front.update(m_mask);
+}
+
+/*!
+ * Set `field` to zero at `points` that left the band and replace `points` with the
+ * current band.
+ *
+ * `points` has to contain all points where `field` may be non-zero. Fields updated at band
+ * points only then stay zero away from the front without full-grid passes.
+ */
+void CalvingFrontRetreat::zero_outside_band(IceModelVec2S &field,
+                                            std::vector<calving::FrontBand::Point> &points) const {
+  IceModelVec::AccessList list(field);
+
+  for (auto p : points) {
+    if (not m_front.contains(p.i, p.j)) {
+      field(p.i, p.j) = 0.0;
+    }
+  }
+
+  points = m_front.points();
+}
+
 /**
  * @brief Compute the maximum time-step length allowed by the CFL
  * condition applied to the calving rate.
@@ -81,15 +143,17 @@ MaxTimestep CalvingFrontRetreat::max_timestep_impl(double t) const {
 
   const IceModelVec2CellType &mask = *m_grid->variables().get_2d_cell_type("mask");
 
-  m_mask.copy_from(mask);
+  update_front(mask);
 
   IceModelVec2S &horizontal_calving_rate = m_tmp;
+  zero_outside_band(horizontal_calving_rate, m_tmp_points);
   compute_calving_rate(m_mask, horizontal_calving_rate);
 
   IceModelVec::AccessList list(horizontal_calving_rate);
 
-  for (Points pt(*m_grid); pt; pt.next()) {
-    const int i = pt.i(), j = pt.j();
+  // the calving rate is zero away from the front
+  for (auto p : m_front.points()) {
+    const int i = p.i, j = p.j;
 
     const double C = horizontal_calving_rate(i, j);
 
@@ -152,39 +216,16 @@ void CalvingFrontRetreat::update(double dt,
   GeometryCalculator gc(*m_config);
   gc.compute_surface(sea_level, bed_topography, ice_thickness, m_surface_topography);
 
-  // copy mask to temporary storage to get more ghosts
-  m_mask.copy_from(mask);
-
-  // Set the mask to MASK_ICE_FREE_OCEAN outside the modeling domain. This is needed to avoid
-  // "wrapping around" in regional setups.
-  if (not m_config->get_boolean("calving.front_retreat.wrap_around")) {
-
-    IceModelVec::AccessList list(m_mask);
-
-    const int Mx = m_grid->Mx();
-    const int My = m_grid->My();
-
-    ParallelSection loop(m_grid->com);
-    try {
-      for (PointsWithGhosts p(*m_grid); p; p.next()) {
-        const int i = p.i(), j = p.j();
-
-        if (i < 0 or i >= Mx or j < 0 or j >= My) {
-          m_mask(i, j) = MASK_ICE_FREE_OCEAN;
-        }
-      }
-    } catch (...) {
-      loop.failed();
-    }
-    loop.check();
-  }
+  update_front(mask);
 
   // use mask with a wide stencil to compute the calving rate
+  zero_outside_band(m_horizontal_calving_rate, m_rate_points);
   compute_calving_rate(m_mask, m_horizontal_calving_rate);
 
   const double dx = m_grid->dx();
 
-  m_tmp.set(0.0);
+  // m_tmp is zero away from the front; it is reset at band points in step 1 below
+  zero_outside_band(m_tmp, m_tmp_points);
 
   IceModelVec::AccessList list{&ice_thickness, &ice_thickness_bc_mask,
       &bed_topography, &mask, &Href, &m_tmp, &m_horizontal_calving_rate,
@@ -193,9 +234,11 @@ void CalvingFrontRetreat::update(double dt,
   // Prepare to loop over neighbors: directions
   const Direction dirs[] = {North, East, South, West};
 
-  // Step 1: Apply the computed horizontal calving rate:
-  for (Points pt(*m_grid); pt; pt.next()) {
-    const int i = pt.i(), j = pt.j();
+  // Step 1: Apply the computed horizontal calving rate (it is zero away from the front):
+  for (auto p : m_front.points()) {
+    const int i = p.i, j = p.j;
+
+    m_tmp(i, j) = 0.0;
 
     if (ice_thickness_bc_mask(i, j) > 0.5) {
       // don't modify cells marked as Dirichlet B.C. locations
@@ -264,8 +307,10 @@ void CalvingFrontRetreat::update(double dt,
   // due to calving front retreat.
   m_tmp.update_ghosts();
 
-  for (Points p(*m_grid); p; p.next()) {
-    const int i = p.i(), j = p.j();
+  // m_tmp is zero except at front points, so only their neighbors (which are in the band)
+  // need to be updated
+  for (auto p : m_front.points()) {
+    const int i = p.i, j = p.j;
 
     // Note: this condition has to match the one in step 1 above.
     if (ice_thickness_bc_mask.as_int(i, j) == 0 and
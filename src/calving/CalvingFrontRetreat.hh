@@ -23,6 +23,7 @@
 #include "pism/util/Component.hh"
 #include "pism/util/iceModelVec.hh"
 #include "pism/util/IceModelVec2CellType.hh"
+#include "FrontBand.hh"
 
 
 namespace pism {
@@ -53,10 +54,25 @@ protected:
 
   MaxTimestep max_timestep_impl(double t) const ;
 
+  //! Compute the calving rate at points in m_front. Called after m_front.update(mask).
+  /*!
+   * Implementations have to set `result` at all points in m_front. The caller ensures
+   * that `result` is zero elsewhere.
+   */
   virtual void compute_calving_rate(const IceModelVec2CellType &mask,
                                     IceModelVec2S &result) const = 0;
 
+  void update_front(const IceModelVec2CellType &mask) const;
+
+  void zero_outside_band(IceModelVec2S &field,
+                         std::vector<calving::FrontBand::Point> &points) const;
+
   mutable IceModelVec2CellType m_mask;
+  //! points near the calving front
+  mutable calving::FrontBand m_front;
+  //! points where m_tmp and m_horizontal_calving_rate may be non-zero (see
+  //! zero_outside_band())
+  mutable std::vector<calving::FrontBand::Point> m_tmp_points, m_rate_points;
   mutable IceModelVec2S m_tmp;
   IceModelVec2S m_horizontal_calving_rate, m_surface_topography;
   bool m_restrict_timestep;
@@ -73,8 +73,8 @@ void EigenCalving::compute_calving_rate(const IceModelVec2CellType &mask,
   IceModelVec::AccessList list{&mask, &result, &m_strain_rates};
 
   // Compute the horizontal calving rate
-  for (Points pt(*m_grid); pt; pt.next()) {
-    const int i = pt.i(), j = pt.j();
+  for (auto pt : m_front.points()) {
+    const int i = pt.i, j = pt.j;
 
     // Find partially filled or empty grid boxes on the icefree ocean, which
     // have floating ice neighbors after the mass continuity step
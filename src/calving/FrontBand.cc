@@ -0,0 +1,181 @@
+/* Copyright (C) 2018 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <algorithm>
+
+#include "FrontBand.hh"
+#include "pism/util/IceModelVec2CellType.hh"
+#include "pism/util/Mask.hh"
+#include "pism/util/error_handling.hh"
+
+namespace pism {
+namespace calving {
+
+FrontBand::FrontBand(IceGrid::ConstPtr grid, unsigned int width, bool whole_domain)
+  : m_grid(grid), m_width(width), m_whole_domain(whole_domain) {
+
+  const int W = m_width + 1;
+
+  // -1 is not a valid cell type, so the first update() call re-computes the whole band
+  m_mask.resize((m_grid->xm() + 2 * W) * (m_grid->ym() + 2 * W), -1);
+  m_in_band.resize(m_grid->xm() * m_grid->ym(), 0);
+}
+
+const std::vector<FrontBand::Point>& FrontBand::points() const {
+  return m_points;
+}
+
+//! Returns true if the owned point (i,j) is in the band.
+bool FrontBand::contains(int i, int j) const {
+  return m_in_band[(j - m_grid->ys()) * m_grid->xm() + (i - m_grid->xs())] != 0;
+}
+
+int FrontBand::ghosted_index(int i, int j) const {
+  const int W = m_width + 1;
+  return (j - m_grid->ys() + W) * (m_grid->xm() + 2 * W) + (i - m_grid->xs() + W);
+}
+
+//! Returns true if (i,j) is ice-free and has an icy neighbor.
+bool FrontBand::front(int i, int j) const {
+  const int stride = m_grid->xm() + 2 * (m_width + 1);
+  const int k = ghosted_index(i, j);
+
+  return (mask::ice_free(m_mask[k]) and
+          (mask::icy(m_mask[k + 1]) or mask::icy(m_mask[k - 1]) or
+           mask::icy(m_mask[k + stride]) or mask::icy(m_mask[k - stride])));
+}
+
+bool FrontBand::in_band(int i, int j) const {
+  if (m_whole_domain) {
+    return true;
+  }
+
+  for (int b = -m_width; b <= m_width; ++b) {
+    for (int a = -m_width; a <= m_width; ++a) {
+      if (front(i + a, j + b)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/*!
+ * Update the band using the cell type `mask`.
+ *
+ * `mask` has to have at least `width + 1` ghosts and they have to be up to date.
+ */
+void FrontBand::update(const IceModelVec2CellType &mask) {
+  const int W = m_width + 1;
+
+  if ((int)mask.get_stencil_width() < W) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "the cell type mask needs %d ghosts (has %d)",
+                                  W, mask.get_stencil_width());
+  }
+
+  const int
+    xs = m_grid->xs(),
+    xm = m_grid->xm(),
+    ys = m_grid->ys(),
+    ym = m_grid->ym();
+
+  // find points where the cell type changed
+  std::vector<Point> changed;
+  {
+    IceModelVec::AccessList list(mask);
+
+    for (PointsWithGhosts p(*m_grid, W); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      const int k = ghosted_index(i, j);
+      const int M = mask.as_int(i, j);
+
+      if (M != m_mask[k]) {
+        m_mask[k] = M;
+        changed.push_back({i, j});
+      }
+    }
+  }
+
+  if (changed.empty()) {
+    return;
+  }
+
+  // points added to the band
+  std::vector<Point> added;
+  bool removed = false;
+
+  auto check = [&](int i, int j) {
+    const int k = (j - ys) * xm + (i - xs);
+    const char flag = in_band(i, j) ? 1 : 0;
+
+    if (flag != m_in_band[k]) {
+      m_in_band[k] = flag;
+      if (flag) {
+        added.push_back({i, j});
+      } else {
+        removed = true;
+      }
+    }
+  };
+
+  // A change at a point affects front status of the point itself and its neighbors,
+  // so it affects band membership of points within m_width + 1 cells.
+  if (changed.size() * (2 * W + 1) * (2 * W + 1) > (size_t)(xm * ym)) {
+    // too many changes: it is cheaper to check all the points
+    for (Points p(*m_grid); p; p.next()) {
+      check(p.i(), p.j());
+    }
+  } else {
+    for (auto c : changed) {
+      const int
+        i_min = std::max(c.i - W, xs),
+        i_max = std::min(c.i + W, xs + xm - 1),
+        j_min = std::max(c.j - W, ys),
+        j_max = std::min(c.j + W, ys + ym - 1);
+
+      for (int j = j_min; j <= j_max; ++j) {
+        for (int i = i_min; i <= i_max; ++i) {
+          check(i, j);
+        }
+      }
+    }
+  }
+
+  if (removed) {
+    m_points.erase(std::remove_if(m_points.begin(), m_points.end(),
+                                  [&](const Point &p) {
+                                    return m_in_band[(p.j - ys) * xm + (p.i - xs)] == 0;
+                                  }),
+                   m_points.end());
+  }
+
+  if (not added.empty()) {
+    m_points.insert(m_points.end(), added.begin(), added.end());
+
+    std::sort(m_points.begin(), m_points.end(),
+              [](const Point &a, const Point &b) {
+                return a.j < b.j or (a.j == b.j and a.i < b.i);
+              });
+  }
+}
+
+} // end of namespace calving
+} // end of namespace pism
@@ -0,0 +1,85 @@
+/* Copyright (C) 2018 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _FRONTBAND_H_
+#define _FRONTBAND_H_
+
+#include <vector>
+
+#include "pism/util/IceGrid.hh"
+
+namespace pism {
+
+class IceModelVec2CellType;
+
+namespace calving {
+
+//! List of grid points near the calving front.
+/*!
+ * Contains owned grid points within `width` cells (in each direction) of a front point,
+ * i.e. of an ice-free point with at least one icy neighbor.
+ *
+ * The list is updated incrementally: update() finds points where the cell type changed
+ * since the last call and re-computes band membership of points near them only. Callers
+ * can then loop over the band instead of the whole subdomain:
+ *
+ *     for (auto p : band.points()) {
+ *       const int i = p.i, j = p.j;
+ *       ...
+ *     }
+ *
+ * Points are sorted in the same order as in a Points loop.
+ *
+ * If `whole_domain` is true the band contains all owned points. This is used to check
+ * that results do not depend on the band.
+ */
+class FrontBand {
+public:
+  FrontBand(IceGrid::ConstPtr grid, unsigned int width, bool whole_domain);
+
+  void update(const IceModelVec2CellType &mask);
+
+  struct Point {
+    int i, j;
+  };
+
+  const std::vector<Point>& points() const;
+
+  bool contains(int i, int j) const;
+private:
+  bool front(int i, int j) const;
+  bool in_band(int i, int j) const;
+  int ghosted_index(int i, int j) const;
+
+  IceGrid::ConstPtr m_grid;
+  int m_width;
+  bool m_whole_domain;
+
+  //! copy of the cell type mask (with `m_width + 1` ghosts)
+  std::vector<int> m_mask;
+  //! band membership flags of owned points
+  std::vector<char> m_in_band;
+  //! owned points in the band
+  std::vector<Point> m_points;
+};
+
+} // end of namespace calving
+} // end of namespace pism
+
+#endif /* _FRONTBAND_H_ */
@@ -50,7 +50,8 @@ void FrontalMelt::compute_calving_rate(const IceModelVec2CellType &mask,
                                        IceModelVec2S &result) const {
   GeometryCalculator gc(*m_config);
 
-  IceModelVec2S &shelf_base_mass_flux = m_tmp;
+  // Note: `result` may be m_tmp, so we can't use m_tmp here.
+  IceModelVec2S &shelf_base_mass_flux = m_shelf_base_mass_flux;
   m_ocean->shelf_base_mass_flux(shelf_base_mass_flux);
 
   const IceModelVec2S
@@ -68,8 +69,8 @@ void FrontalMelt::compute_calving_rate(const IceModelVec2CellType &mask,
 
   ParallelSection loop(m_grid->com);
   try {
-    for (Points p(*m_grid); p; p.next()) {
-      const int i = p.i(), j = p.j();
+    for (auto p : m_front.points()) {
+      const int i = p.i, j = p.j;
 
       if (mask.ice_free_ocean(i, j) and mask.next_to_ice(i, j)) {
         const double bed = bed_elevation(i, j);
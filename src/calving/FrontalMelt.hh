@@ -40,7 +40,7 @@ protected:
                             IceModelVec2S &result) const;
 
   const ocean::OceanModel *m_ocean;
-  IceModelVec2S m_shelf_base_mass_flux;
+  mutable IceModelVec2S m_shelf_base_mass_flux;
 };
 
 } // end of namespace pism
@@ -17,22 +17,38 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <vector>
+#include <algorithm>
+#include <climits>
+
 #include "IcebergRemover.hh"
-#include "connected_components.hh"
 #include "pism/util/Mask.hh"
 #include "pism/util/Vars.hh"
 #include "pism/util/error_handling.hh"
 #include "pism/util/IceGrid.hh"
 #include "pism/util/IceModelVec2CellType.hh"
+#include "pism/util/pism_utilities.hh"
 
 namespace pism {
 namespace calving {
 
+const int mask_grounded_ice = 1;
+const int mask_floating_ice = 2;
+
 IcebergRemover::IcebergRemover(IceGrid::ConstPtr g)
   : Component(g) {
 
-  m_iceberg_mask.create(m_grid, "iceberg_mask", WITHOUT_GHOSTS);
-  m_mask_p0 = m_iceberg_mask.allocate_proc0_copy();
+  // global labels are stored as doubles and sent as ints
+  if ((double)m_grid->Mx() * m_grid->My() >= INT_MAX) {
+    throw RuntimeError(PISM_ERROR_LOCATION, "grid is too big for the iceberg remover");
+  }
+
+  m_iceberg_mask.create(m_grid, "iceberg_mask", WITH_GHOSTS, 1);
+  m_labels.create(m_grid, "iceberg_labels", WITH_GHOSTS, 1);
+
+  m_last_mask.create(m_grid, "iceberg_mask_last", WITH_GHOSTS, 1);
+  // an impossible value: forces labeling during the first call
+  m_last_mask.set(-1.0);
 }
 
 IcebergRemover::~IcebergRemover() {
@@ -50,9 +66,6 @@ void IcebergRemover::init() {
  */
 void IcebergRemover::update(IceModelVec2CellType &mask,
                             IceModelVec2S &ice_thickness) {
-  const int
-    mask_grounded_ice = 1,
-    mask_floating_ice = 2;
 
   // prepare the mask that will be handed to the connected component
   // labeling code:
@@ -87,28 +100,22 @@ void IcebergRemover::update(IceModelVec2CellType &mask,
     }
   }
 
-  // identify icebergs using serial code on processor 0:
-  {
-    m_iceberg_mask.put_on_proc0(*m_mask_p0);
+  if (not may_create_icebergs()) {
+    // the last call removed all icebergs and recent changes did not create new ones
+    m_last_mask.copy_from(m_iceberg_mask);
+    mask.update_ghosts();
+    ice_thickness.update_ghosts();
+    return;
+  }
 
-    ParallelSection rank0(m_grid->com);
-    try {
-      if (m_grid->rank() == 0) {
-        petsc::VecArray mask_p0(*m_mask_p0);
-        label_connected_components(mask_p0.get(), m_grid->My(), m_grid->Mx(), true, mask_grounded_ice);
-      }
-    } catch (...) {
-      rank0.failed();
-    }
-    rank0.check();
+  m_last_mask.copy_from(m_iceberg_mask);
 
-    m_iceberg_mask.get_from_proc0(*m_mask_p0);
-  }
+  find_icebergs();
 
   // correct ice thickness and the cell type mask using the resulting
   // "iceberg" mask:
   {
-    IceModelVec::AccessList list{&ice_thickness, &mask, &m_iceberg_mask};
+    IceModelVec::AccessList list{&ice_thickness, &mask, &m_iceberg_mask, &m_last_mask};
 
     if (m_grid->variables().is_available("bc_mask")) {
       const IceModelVec2Int &bc_mask = *m_grid->variables().get_2d_mask("bc_mask");
@@ -122,6 +129,7 @@ void IcebergRemover::update(IceModelVec2CellType &mask,
         if (m_iceberg_mask(i,j) > 0.5 && bc_mask(i,j) < 0.5) {
           ice_thickness(i,j) = 0.0;
           mask(i,j)     = MASK_ICE_FREE_OCEAN;
+          m_last_mask(i,j) = 0.0;
         }
       }
     } else {
@@ -132,6 +140,7 @@ void IcebergRemover::update(IceModelVec2CellType &mask,
         if (m_iceberg_mask(i,j) > 0.5) {
           ice_thickness(i,j) = 0.0;
           mask(i,j)     = MASK_ICE_FREE_OCEAN;
+          m_last_mask(i,j) = 0.0;
         }
       }
     }
@@ -141,6 +150,396 @@ void IcebergRemover::update(IceModelVec2CellType &mask,
   // elevation can be updated redundantly)
   mask.update_ghosts();
   ice_thickness.update_ghosts();
+  m_last_mask.update_ghosts();
+}
+
+/*!
+ * Returns true if changes in the grounded/floating ice classification since the last call
+ * of update() could have created icebergs.
+ *
+ * The last call removed all icebergs, so all ice-filled cells in m_last_mask are
+ * connected to grounded ice. This stays true if
+ *
+ * - each new ice-filled cell is grounded or is adjacent to a cell that was and still is
+ *   ice-filled,
+ *
+ * - removing an ice-filled cell does not disconnect its neighbors, i.e. it had at most
+ *   one ice-filled neighbor or all its neighbors are still ice-filled and connected to
+ *   each other through the remaining cells of its 3x3 neighborhood,
+ *
+ * - each removed or no longer grounded cell is the last one in its component or has a
+ *   grounded ice-filled neighbor.
+ *
+ * These checks are local and conservative: if any of them fails we re-label all
+ * components. The cost is proportional to the number of changed cells (plus a comparison
+ * of two masks).
+ */
+bool IcebergRemover::may_create_icebergs() {
+  m_iceberg_mask.update_ghosts();
+
+  const int
+    Mx = m_grid->Mx(),
+    My = m_grid->My();
+
+  IceModelVec::AccessList list{&m_iceberg_mask, &m_last_mask};
+
+  // new and old classifications; cells outside the domain are ice-free
+  auto new_mask = [&](int i, int j) {
+    return (i >= 0 and i < Mx and j >= 0 and j < My) ? (int)m_iceberg_mask(i, j) : 0;
+  };
+  auto old_mask = [&](int i, int j) {
+    return (i >= 0 and i < Mx and j >= 0 and j < My) ? (int)m_last_mask(i, j) : 0;
+  };
+
+  // neighbors: east, north, west, south
+  const int di[] = {1, 0, -1, 0}, dj[] = {0, 1, 0, -1};
+  // the 3x3 neighborhood, counter-clockwise starting from the east
+  const int ri[] = {1, 1, 0, -1, -1, -1, 0, 1}, rj[] = {0, 1, 1, 1, 0, -1, -1, -1};
+
+  // returns true if removing the cell (i,j) cannot disconnect ice-filled cells
+  auto simple = [&](int i, int j) {
+    int degree = 0, removed = 0;
+    for (int n = 0; n < 4; ++n) {
+      if (old_mask(i + di[n], j + dj[n]) > 0) {
+        degree += 1;
+        removed += new_mask(i + di[n], j + dj[n]) == 0 ? 1 : 0;
+      }
+    }
+
+    if (degree <= 1) {
+      return true;
+    }
+
+    if (removed > 0) {
+      return false;
+    }
+
+    bool ring[8];
+    int start = -1;
+    for (int k = 0; k < 8; ++k) {
+      ring[k] = new_mask(i + ri[k], j + rj[k]) > 0;
+      if (not ring[k] and start < 0) {
+        start = k;
+      }
+    }
+
+    if (start < 0) {
+      // all neighbors are ice-filled
+      return true;
+    }
+
+    // count runs of ice-filled cells containing neighbors of (i,j); cells in a run are
+    // connected to each other
+    int runs = 0;
+    bool neighbor = false;
+    for (int n = 1; n <= 8; ++n) {
+      const int k = (start + n) % 8;
+      if (ring[k]) {
+        neighbor = neighbor or (k % 2 == 0);
+      } else {
+        runs += neighbor ? 1 : 0;
+        neighbor = false;
+      }
+    }
+
+    return runs <= 1;
+  };
+
+  // returns true if (i,j) has a grounded neighbor; a cell that became ice-free is also
+  // anchored if it has no ice-filled neighbors (a floating cell with no grounded neighbors
+  // may be a new iceberg)
+  auto anchored = [&](int i, int j) {
+    bool icy_neighbors = false;
+    for (int n = 0; n < 4; ++n) {
+      const int M = new_mask(i + di[n], j + dj[n]);
+      if (M == mask_grounded_ice) {
+        return true;
+      }
+      icy_neighbors = icy_neighbors or M > 0;
+    }
+    return new_mask(i, j) == 0 and not icy_neighbors;
+  };
+
+  int unsafe = 0;
+  for (Points p(*m_grid); p; p.next()) {
+    const int
+      i     = p.i(),
+      j     = p.j(),
+      M     = new_mask(i, j),
+      M_old = old_mask(i, j);
+
+    if (M == M_old or (M == mask_grounded_ice and M_old > 0)) {
+      // no change or floating ice became grounded
+      continue;
+    }
+
+    if (M_old < 0) {
+      // the first call
+      unsafe = 1;
+    } else if (M_old == 0) {
+      // new ice
+      bool attached = M == mask_grounded_ice;
+      for (int n = 0; n < 4; ++n) {
+        attached = attached or (old_mask(i + di[n], j + dj[n]) > 0 and
+                                new_mask(i + di[n], j + dj[n]) > 0);
+      }
+      unsafe = not attached;
+    } else {
+      // removed ice or grounded ice became floating
+      unsafe = ((M == 0 and not simple(i, j)) or
+                (M_old == mask_grounded_ice and not anchored(i, j)));
+    }
+
+    if (unsafe) {
+      break;
+    }
+  }
+
+  return GlobalSum(m_grid->com, unsafe) > 0;
+}
+
+//! Union-find: find the root of `k`, using path halving.
+static int find_root(std::vector<int> &parent, int k) {
+  while (parent[k] != k) {
+    parent[k] = parent[parent[k]];
+    k = parent[k];
+  }
+  return k;
+}
+
+//! Union-find: merge sets containing `a` and `b`. The smallest index becomes the root.
+static void join(std::vector<int> &parent, int a, int b) {
+  a = find_root(parent, a);
+  b = find_root(parent, b);
+
+  if (a < b) {
+    parent[b] = a;
+  } else if (b < a) {
+    parent[a] = b;
+  }
+}
+
+//! Gather `input` from all ranks, concatenating in the rank order.
+static std::vector<int> all_gather(MPI_Comm com, const std::vector<int> &input) {
+  int size = 0;
+  MPI_Comm_size(com, &size);
+
+  int n = input.size();
+  std::vector<int> counts(size), displacements(size);
+
+  int err = MPI_Allgather(&n, 1, MPI_INT, counts.data(), 1, MPI_INT, com);
+  PISM_C_CHK(err, 0, "MPI_Allgather");
+
+  int total = 0;
+  for (int r = 0; r < size; ++r) {
+    displacements[r] = total;
+    total += counts[r];
+  }
+
+  std::vector<int> result(total);
+
+  err = MPI_Allgatherv(const_cast<int*>(input.data()), n, MPI_INT,
+                       result.data(), counts.data(), displacements.data(), MPI_INT,
+                       com);
+  PISM_C_CHK(err, 0, "MPI_Allgatherv");
+
+  return result;
+}
+
+/*!
+ * Identify icebergs, i.e. connected components of ice-filled cells that do not contain a
+ * grounded cell.
+ *
+ * On input, m_iceberg_mask contains `mask_grounded_ice`, `mask_floating_ice` or zero
+ * (ice-free). On output it is 1 at iceberg cells and 0 elsewhere.
+ *
+ * Cells are connected to their four neighbors; the domain is *not* periodic.
+ *
+ * Each rank labels components in its subdomain using union-find. The global label of a
+ * component is the global index of its root cell. Then all ranks exchange pairs of labels
+ * of components adjacent across subdomain boundaries (and labels of such components
+ * containing grounded cells) and merge them using union-find again. The amount of data
+ * exchanged is proportional to the total length of subdomain boundaries.
+ */
+void IcebergRemover::find_icebergs() {
+  const int
+    xs = m_grid->xs(),
+    xm = m_grid->xm(),
+    ys = m_grid->ys(),
+    ym = m_grid->ym(),
+    Mx = m_grid->Mx(),
+    My = m_grid->My();
+
+  // local union-find structure; -1 marks ice-free cells
+  std::vector<int> parent(xm * ym, -1);
+  // "grounded" flags of local components, indexed by roots
+  std::vector<char> grounded(xm * ym, 0);
+
+  IceModelVec::AccessList list{&m_iceberg_mask, &m_labels};
+
+  // label components in this subdomain
+  for (Points p(*m_grid); p; p.next()) {
+    const int
+      i = p.i(),
+      j = p.j(),
+      k = (j - ys) * xm + (i - xs);
+
+    if (m_iceberg_mask(i, j) < 0.5) {
+      continue;
+    }
+
+    parent[k] = k;
+
+    if (i > xs and m_iceberg_mask(i - 1, j) > 0.5) {
+      join(parent, k, k - 1);
+    }
+
+    if (j > ys and m_iceberg_mask(i, j - 1) > 0.5) {
+      join(parent, k, k - xm);
+    }
+  }
+
+  for (Points p(*m_grid); p; p.next()) {
+    const int
+      i = p.i(),
+      j = p.j(),
+      k = (j - ys) * xm + (i - xs);
+
+    if (parent[k] < 0) {
+      m_labels(i, j) = -1.0;
+      continue;
+    }
+
+    const int root = find_root(parent, k);
+
+    if (m_iceberg_mask(i, j) == mask_grounded_ice) {
+      grounded[root] = 1;
+    }
+
+    const int
+      i_root = xs + root % xm,
+      j_root = ys + root / xm;
+
+    m_labels(i, j) = j_root * Mx + i_root;
+  }
+
+  // merge components across subdomain boundaries
+  if (m_grid->size() > 1) {
+    m_labels.update_ghosts();
+
+    // pairs of labels of adjacent components
+    std::vector<int> edges;
+    // labels of grounded components touching subdomain boundaries
+    std::vector<int> grounded_labels;
+
+    for (Points p(*m_grid); p; p.next()) {
+      const int
+        i = p.i(),
+        j = p.j(),
+        k = (j - ys) * xm + (i - xs);
+
+      if (parent[k] < 0) {
+        continue;
+      }
+
+      const int label = m_labels(i, j);
+
+      // neighbors to the east and north are owned by other ranks; neighbors to the west
+      // and south are handled by ranks that own them
+      bool boundary = (i == xs and i > 0) or (j == ys and j > 0);
+
+      if (i == xs + xm - 1 and i + 1 < Mx) {
+        boundary = true;
+        const int n = m_labels(i + 1, j);
+        if (n >= 0) {
+          edges.push_back(label);
+          edges.push_back(n);
+        }
+      }
+
+      if (j == ys + ym - 1 and j + 1 < My) {
+        boundary = true;
+        const int n = m_labels(i, j + 1);
+        if (n >= 0) {
+          edges.push_back(label);
+          edges.push_back(n);
+        }
+      }
+
+      if (boundary and grounded[find_root(parent, k)]) {
+        grounded_labels.push_back(label);
+      }
+    }
+
+    std::sort(grounded_labels.begin(), grounded_labels.end());
+    grounded_labels.erase(std::unique(grounded_labels.begin(), grounded_labels.end()),
+                          grounded_labels.end());
+
+    edges           = all_gather(m_grid->com, edges);
+    grounded_labels = all_gather(m_grid->com, grounded_labels);
+
+    // labels of all components adjacent to other subdomains
+    std::vector<int> labels = edges;
+    std::sort(labels.begin(), labels.end());
+    labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+    auto index = [&labels](int label) {
+      return std::lower_bound(labels.begin(), labels.end(), label) - labels.begin();
+    };
+
+    std::vector<int> merged(labels.size());
+    for (unsigned int k = 0; k < merged.size(); ++k) {
+      merged[k] = k;
+    }
+
+    for (unsigned int k = 0; k < edges.size(); k += 2) {
+      join(merged, index(edges[k]), index(edges[k + 1]));
+    }
+
+    std::vector<char> merged_grounded(labels.size(), 0);
+    for (auto label : grounded_labels) {
+      const int k = index(label);
+      if (k < (int)labels.size() and labels[k] == label) {
+        merged_grounded[find_root(merged, k)] = 1;
+      }
+    }
+
+    // propagate "grounded" flags to local components
+    for (Points p(*m_grid); p; p.next()) {
+      const int
+        i = p.i(),
+        j = p.j(),
+        k = (j - ys) * xm + (i - xs);
+
+      if (parent[k] != k) {
+        // ice-free or not a root
+        continue;
+      }
+
+      const int
+        label = m_labels(i, j),
+        n     = index(label);
+
+      if (n < (int)labels.size() and labels[n] == label and
+          merged_grounded[find_root(merged, n)]) {
+        grounded[k] = 1;
+      }
+    }
+  }
+
+  // mark icebergs
+  for (Points p(*m_grid); p; p.next()) {
+    const int
+      i = p.i(),
+      j = p.j(),
+      k = (j - ys) * xm + (i - xs);
+
+    if (parent[k] >= 0 and not grounded[find_root(parent, k)]) {
+      m_iceberg_mask(i, j) = 1.0;
+    } else {
+      m_iceberg_mask(i, j) = 0.0;
+    }
+  }
 }
 
 } // end of namespace calving
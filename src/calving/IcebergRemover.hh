@@ -43,8 +43,13 @@ namespace calving {
  * They are observed to cause unrealistically large velocities that
  * may affect ice velocities elsewhere.
  *
- * This class uses a serial connected component labeling algorithm to
- * remove "icebergs".
+ * This class uses a parallel connected component labeling algorithm
+ * to remove "icebergs": each rank labels components in its subdomain
+ * using union-find, then labels of components touching subdomain
+ * boundaries are merged across ranks.
+ *
+ * Labeling is skipped if changes in the mask since the last call
+ * could not create icebergs (see may_create_icebergs()).
  */
 class IcebergRemover : public Component
 {
@@ -55,8 +60,15 @@ public:
   virtual void init();
   void update(IceModelVec2CellType &pism_mask, IceModelVec2S &ice_thickness);
 protected:
+  void find_icebergs();
+  bool may_create_icebergs();
+
+  //! grounded/floating ice classification on input, iceberg mask on output
   IceModelVec2S m_iceberg_mask;
-  petsc::Vec::Ptr m_mask_p0;
+  //! global component labels (with ghosts)
+  IceModelVec2S m_labels;
+  //! classification of cells after the last call
+  IceModelVec2S m_last_mask;
 };
 
 } // end of namespace calving
@@ -85,8 +85,8 @@ void vonMisesCalving::compute_calving_rate(const IceModelVec2CellType &mask,
 
   const double ssa_n = flow_law->exponent();
 
-  for (Points pt(*m_grid); pt; pt.next()) {
-    const int i = pt.i(), j = pt.j();
+  for (auto pt : m_front.points()) {
+    const int i = pt.i, j = pt.j;
 
     // Find partially filled or empty grid boxes on the icefree ocean, which
     // have floating ice neighbors after the mass continuity step
@@ -24,6 +24,7 @@
 #include "pism/util/error_handling.hh"
 #include "pism/util/iceModelVec2T.hh"
 #include "pism/util/io/PIO.hh"
+#include "pism/util/io/ForcingFile.hh"
 #include "pism/util/pism_options.hh"
 #include "pism/util/pism_utilities.hh"
 #include "pism/util/Component.hh"
@@ -99,7 +100,10 @@ protected:
   {
     unsigned int buffer_size = (unsigned int) Model::m_config->get_double("climate_forcing.buffer_size");
 
-    PIO nc(Model::m_grid->com, "netcdf3", m_filename, PISM_READONLY);
+    // Keep the file open: all fields read from it share it (see IceModelVec2T::init()).
+    m_file = ForcingFile::open(Model::m_grid, m_filename);
+
+    const PIO &nc = m_file->file();
 
     for (auto f : m_fields) {
       unsigned int n_records = 0;
@@ -133,8 +137,6 @@ protected:
       f.second->set_n_evaluations_per_year((unsigned int)Model::m_config->get_double("climate_forcing.evaluations_per_year"));
 
     }
-
-    nc.close();
   }
 
   virtual void update_internal(double my_t, double my_dt)
@@ -161,6 +163,7 @@ protected:
 protected:
   std::map<std::string, IceModelVec2T*> m_fields;
   std::string m_filename, m_option_prefix;
+  ForcingFile::Ptr m_file;
 
   unsigned int m_bc_period;       // in (integer) years
   double m_bc_reference_time;  // in seconds
@@ -110,6 +110,19 @@ void BedDef::update(const IceModelVec2S &ice_thickness, double t, double dt) {
   this->update_with_thickness_impl(ice_thickness, t, dt);
 }
 
+//! Finish an update that is still in progress (if any).
+/*!
+ * Models that update the bed asynchronously may return from update() before the bed
+ * elevation is updated. This method has to be called before the model state is saved.
+ */
+void BedDef::finish_pending_update() {
+  this->finish_pending_update_impl();
+}
+
+void BedDef::finish_pending_update_impl() {
+  // empty
+}
+
 //! Initialize from the context (input file and the "variables" database).
 void BedDef::init_impl(const InputOptions &opts) {
   m_t_beddef_last = m_grid->ctx()->time()->start();
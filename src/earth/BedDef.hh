@@ -46,7 +46,11 @@ public:
   const IceModelVec2S& bed_elevation() const;
   const IceModelVec2S& uplift() const;
 
+  void finish_pending_update();
+
 protected:
+  virtual void finish_pending_update_impl();
+
   virtual void define_model_state_impl(const PIO &output) const;
   virtual void write_model_state_impl(const PIO &output) const;
 
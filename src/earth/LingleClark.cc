@@ -37,16 +37,12 @@ namespace bed {
 LingleClark::LingleClark(IceGrid::ConstPtr g)
   : BedDef(g) {
 
-  // A work vector. This storage is used to put thickness change on rank 0 and to get the plate
-  // displacement change back.
   m_bed_displacement.create(m_grid, "bed_displacement", WITHOUT_GHOSTS);
   m_bed_displacement.set_attrs("internal",
                                "total (viscous and elastic) displacement "
                                "in the Lingle-Clark bed deformation model",
                                "meters", "");
 
-  m_work0 = m_bed_displacement.allocate_proc0_copy();
-
   m_relief.create(m_grid, "bed_relief", WITHOUT_GHOSTS);
   m_relief.set_attrs("internal",
                      "bed relief relative to the modeled bed displacement",
@@ -55,6 +51,7 @@ LingleClark::LingleClark(IceGrid::ConstPtr g)
   bool use_elastic_model = m_config->get_boolean("bed_deformation.lc.elastic_model");
 
   m_bdLC = NULL;
+  m_dt_beddef_pending = 0.0;
 
   const int
     Mx = m_grid->Mx(),
@@ -85,20 +82,7 @@ LingleClark::LingleClark(IceGrid::ConstPtr g)
   // do not point to auxiliary coordinates "lon" and "lat".
   m_viscous_bed_displacement.metadata().set_string("coordinates", "");
 
-  m_viscous_bed_displacement0 = m_viscous_bed_displacement.allocate_proc0_copy();
-
-  ParallelSection rank0(m_grid->com);
-  try {
-    if (m_grid->rank() == 0) {
-      m_bdLC = new BedDeformLC(*m_config, use_elastic_model,
-                               Mx, My,
-                               m_grid->dx(), m_grid->dy(),
-                               Nx, Ny);
-    }
-  } catch (...) {
-    rank0.failed();
-  }
-  rank0.check();
+  m_bdLC = new BedDeformLC(*m_config, use_elastic_model, *m_grid, *m_extended_grid);
 }
 
 LingleClark::~LingleClark() {
@@ -124,35 +108,11 @@ void LingleClark::bootstrap_impl(const IceModelVec2S &bed,
 
   m_topg_last.copy_from(bed);
 
-  petsc::Vec::Ptr thickness0 = ice_thickness.allocate_proc0_copy();
-
   // initialize the plate displacement
-  {
-    bed_uplift.put_on_proc0(*m_work0);
-    ice_thickness.put_on_proc0(*thickness0);
-
-    ParallelSection rank0(m_grid->com);
-    try {
-      if (m_grid->rank() == 0) {
-        PetscErrorCode ierr = 0;
-
-        m_bdLC->bootstrap(*thickness0, *m_work0);
-
-        ierr = VecCopy(m_bdLC->total_displacement(), *m_work0);
-        PISM_CHK(ierr, "VecCopy");
-
-        ierr = VecCopy(m_bdLC->viscous_displacement(), *m_viscous_bed_displacement0);
-        PISM_CHK(ierr, "VecCopy");
-      }
-    } catch (...) {
-      rank0.failed();
-    }
-    rank0.check();
-  }
+  m_bdLC->bootstrap(ice_thickness, bed_uplift);
 
-  m_viscous_bed_displacement.get_from_proc0(*m_viscous_bed_displacement0);
-
-  m_bed_displacement.get_from_proc0(*m_work0);
+  m_bdLC->get_total_displacement(m_bed_displacement);
+  m_bdLC->get_viscous_displacement(m_viscous_bed_displacement);
 
   // compute bed relief
   m_topg.add(-1.0, m_bed_displacement, m_relief);
@@ -190,29 +150,10 @@ void LingleClark::init_impl(const InputOptions &opts) {
   regrid("Lingle-Clark bed deformation model",
          m_viscous_bed_displacement, REGRID_WITHOUT_REGRID_VARS);
 
-  // Now that m_viscous_bed_displacement is finally initialized, put it on rank 0 and initialize
-  // m_bdLC itself.
-  {
-    ice_thickness->put_on_proc0(*m_work0);
-    m_viscous_bed_displacement.put_on_proc0(*m_viscous_bed_displacement0);
-
-    ParallelSection rank0(m_grid->com);
-    try {
-      if (m_grid->rank() == 0) {  // only processor zero does the step
-        PetscErrorCode ierr = 0;
-
-        m_bdLC->init(*m_work0, *m_viscous_bed_displacement0);
-
-        ierr = VecCopy(m_bdLC->total_displacement(), *m_work0);
-        PISM_CHK(ierr, "VecCopy");
-      }
-    } catch (...) {
-      rank0.failed();
-    }
-    rank0.check();
-  }
+  // Now that m_viscous_bed_displacement is finally initialized, initialize m_bdLC itself.
+  m_bdLC->init(*ice_thickness, m_viscous_bed_displacement);
 
-  m_bed_displacement.get_from_proc0(*m_work0);
+  m_bdLC->get_total_displacement(m_bed_displacement);
 
   // compute bed relief
   m_topg.add(-1.0, m_bed_displacement, m_relief);
@@ -257,29 +198,41 @@ void LingleClark::update_with_thickness_impl(const IceModelVec2S &ice_thickness,
 
   m_t_beddef_last = t_final;
 
-  ice_thickness.put_on_proc0(*m_work0);
-
-  ParallelSection rank0(m_grid->com);
-  try {
-    if (m_grid->rank() == 0) {  // only processor zero does the step
-      PetscErrorCode ierr = 0;
+  // In the asynchronous mode the bed elevation lags by one update: here we finish the
+  // update started during the previous call and start a new one.
+  if (m_bdLC->step_in_progress()) {
+    finish_update();
+  }
 
-      m_bdLC->step(dt_beddef, *m_work0);
+  m_bdLC->step_begin(dt_beddef, ice_thickness);
+  m_dt_beddef_pending = dt_beddef;
 
-      ierr = VecCopy(m_bdLC->total_displacement(), *m_work0);
-      PISM_CHK(ierr, "VecCopy");
+  // Finish the update right away if it is not asynchronous or if this is the last one (so
+  // that the model state saved at the end of a run is complete).
+  if (not m_bdLC->asynchronous() or t_final >= m_grid->ctx()->time()->end()) {
+    finish_update();
+  }
+}
 
-      ierr = VecCopy(m_bdLC->viscous_displacement(), *m_viscous_bed_displacement0);
-      PISM_CHK(ierr, "VecCopy");
-    }
-  } catch (...) {
-    rank0.failed();
+/*!
+ * Finish the asynchronous update started during the last update_with_thickness_impl() call,
+ * if any.
+ */
+void LingleClark::finish_pending_update_impl() {
+  if (m_bdLC->step_in_progress()) {
+    finish_update();
   }
-  rank0.check();
+}
 
-  m_viscous_bed_displacement.get_from_proc0(*m_viscous_bed_displacement0);
+/*!
+ * Finish the update started by BedDeformLC::step_begin() and update bed elevation, uplift
+ * and topg_last.
+ */
+void LingleClark::finish_update() {
+  m_bdLC->step_end();
 
-  m_bed_displacement.get_from_proc0(*m_work0);
+  m_bdLC->get_total_displacement(m_bed_displacement);
+  m_bdLC->get_viscous_displacement(m_viscous_bed_displacement);
 
   // Update bed elevation using bed displacement and relief.
   {
@@ -289,7 +242,7 @@ void LingleClark::update_with_thickness_impl(const IceModelVec2S &ice_thickness,
   }
 
   //! Finally, we need to update bed uplift and topg_last.
-  compute_uplift(dt_beddef);
+  compute_uplift(m_dt_beddef_pending);
   m_topg_last.copy_from(m_topg);
 }
 
@@ -46,18 +46,20 @@ protected:
                       const IceModelVec2S &ice_thickness);
   void update_with_thickness_impl(const IceModelVec2S &ice_thickness,
                                   double my_t, double my_dt);
+  void finish_pending_update_impl();
+
+  void finish_update();
 
   //! Total (viscous and elastic) bed displacement.
   IceModelVec2S m_bed_displacement;
 
-  //! Storage on rank zero. Used to pass the load to the serial deformation model and get
-  //! bed displacement back.
-  petsc::Vec::Ptr m_work0;
-
   //! Bed relief relative to the bed displacement.
   IceModelVec2S m_relief;
 
-  //! Serial viscoelastic bed deformation model.
+  //! length of the bed deformation step started but not finished yet (asynchronous mode)
+  double m_dt_beddef_pending;
+
+  //! Viscoelastic bed deformation model (distributed).
   BedDeformLC *m_bdLC;
 
   //! extended grid for the viscous plate displacement
@@ -65,8 +67,6 @@ protected:
 
   //! Viscous displacement on the extended grid (part of the model state).
   IceModelVec2S m_viscous_bed_displacement;
-  //! rank 0 storage using the extended grid
-  petsc::Vec::Ptr m_viscous_bed_displacement0;
 };
 
 } // end of namespace bed
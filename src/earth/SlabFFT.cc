@@ -0,0 +1,256 @@
+/* Copyright (C) 2018 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <algorithm>
+
+#include "SlabFFT.hh"
+#include "pism/util/error_handling.hh"
+
+namespace pism {
+namespace bed {
+
+//! Split `N` items among `size` ranks as evenly as possible.
+static void split(int N, int size, std::vector<int> &start, std::vector<int> &count) {
+  start.resize(size);
+  count.resize(size);
+
+  int offset = 0;
+  for (int r = 0; r < size; ++r) {
+    count[r] = N / size + (r < N % size ? 1 : 0);
+    start[r] = offset;
+    offset += count[r];
+  }
+}
+
+//! Create a plan for `howmany` contiguous 1D transforms of length `n` in place.
+static fftw_plan plan_1d(int n, int howmany, fftw_complex *data, int sign) {
+  if (howmany == 0) {
+    return NULL;
+  }
+
+  return fftw_plan_many_dft(1, &n, howmany,
+                            data, NULL, 1, n,
+                            data, NULL, 1, n,
+                            sign, FFTW_ESTIMATE);
+}
+
+static void execute(fftw_plan plan) {
+  if (plan != NULL) {
+    fftw_execute(plan);
+  }
+}
+
+static void destroy(fftw_plan plan) {
+  if (plan != NULL) {
+    fftw_destroy_plan(plan);
+  }
+}
+
+SlabFFT::SlabFFT(MPI_Comm com, int Nx, int Ny)
+  : m_com(com), m_Nx(Nx), m_Ny(Ny) {
+
+  int size = 1;
+  MPI_Comm_size(m_com, &size);
+  MPI_Comm_rank(m_com, &m_rank);
+
+  split(m_Nx, size, m_x_start, m_x_count);
+  split(m_Ny, size, m_y_start, m_y_count);
+
+  const int
+    N_space    = std::max(xm() * m_Ny, 1),
+    N_spectrum = std::max(ym() * m_Nx, 1),
+    N_buffer   = std::max(N_space, N_spectrum);
+
+  // Note: FFTW calls abort() if an allocation fails, so we don't check results here.
+  m_space    = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * N_space);
+  m_spectrum = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * N_spectrum);
+  m_send     = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * N_buffer);
+  m_receive  = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * N_buffer);
+
+  std::fill(m_space[0], m_space[0] + 2 * N_space, 0.0);
+  std::fill(m_spectrum[0], m_spectrum[0] + 2 * N_spectrum, 0.0);
+
+  m_forward_j = plan_1d(m_Ny, xm(), m_space, FFTW_FORWARD);
+  m_inverse_j = plan_1d(m_Ny, xm(), m_space, FFTW_BACKWARD);
+  m_forward_i = plan_1d(m_Nx, ym(), m_spectrum, FFTW_FORWARD);
+  m_inverse_i = plan_1d(m_Nx, ym(), m_spectrum, FFTW_BACKWARD);
+}
+
+SlabFFT::~SlabFFT() {
+  destroy(m_forward_j);
+  destroy(m_inverse_j);
+  destroy(m_forward_i);
+  destroy(m_inverse_i);
+
+  fftw_free(m_space);
+  fftw_free(m_spectrum);
+  fftw_free(m_send);
+  fftw_free(m_receive);
+}
+
+int SlabFFT::xs() const {
+  return m_x_start[m_rank];
+}
+
+int SlabFFT::xm() const {
+  return m_x_count[m_rank];
+}
+
+int SlabFFT::ys() const {
+  return m_y_start[m_rank];
+}
+
+int SlabFFT::ym() const {
+  return m_y_count[m_rank];
+}
+
+fftw_complex* SlabFFT::space() const {
+  return m_space;
+}
+
+fftw_complex* SlabFFT::spectrum() const {
+  return m_spectrum;
+}
+
+//! Compute the forward transform of space(), storing it in spectrum(). Overwrites space().
+void SlabFFT::forward() {
+  execute(m_forward_j);
+  transpose_forward();
+  execute(m_forward_i);
+}
+
+//! Compute the inverse transform of spectrum(), storing it in space(). Overwrites spectrum().
+void SlabFFT::inverse() {
+  execute(m_inverse_i);
+  transpose_inverse();
+  execute(m_inverse_j);
+}
+
+//! Exchange `count[r]` complex numbers starting at `offset[r]` with each rank `r`.
+static void all_to_all(MPI_Comm com,
+                       fftw_complex *send,
+                       const std::vector<int> &send_count,
+                       const std::vector<int> &send_offset,
+                       fftw_complex *receive,
+                       const std::vector<int> &receive_count,
+                       const std::vector<int> &receive_offset) {
+  // complex numbers are sent as pairs of doubles
+  const int size = send_count.size();
+  std::vector<int> sc(size), so(size), rc(size), ro(size);
+  for (int r = 0; r < size; ++r) {
+    sc[r] = 2 * send_count[r];
+    so[r] = 2 * send_offset[r];
+    rc[r] = 2 * receive_count[r];
+    ro[r] = 2 * receive_offset[r];
+  }
+
+  int err = MPI_Alltoallv(send[0], sc.data(), so.data(), MPI_DOUBLE,
+                          receive[0], rc.data(), ro.data(), MPI_DOUBLE,
+                          com);
+  PISM_C_CHK(err, 0, "MPI_Alltoallv");
+}
+
+//! Move data from the row-distributed space() to the column-distributed spectrum().
+void SlabFFT::transpose_forward() {
+  const int size = m_x_count.size();
+  const int xm = this->xm(), ym = this->ym();
+
+  std::vector<int> send_count(size), send_offset(size), receive_count(size), receive_offset(size);
+
+  // pack: the block sent to rank r contains columns owned by r, stored as [j][i]
+  for (int r = 0; r < size; ++r) {
+    send_count[r]  = xm * m_y_count[r];
+    send_offset[r] = xm * m_y_start[r];
+
+    for (int jj = 0; jj < m_y_count[r]; ++jj) {
+      const int j = m_y_start[r] + jj;
+      for (int ii = 0; ii < xm; ++ii) {
+        fftw_complex &d = m_send[send_offset[r] + jj * xm + ii];
+        const fftw_complex &s = m_space[ii * m_Ny + j];
+        d[0] = s[0];
+        d[1] = s[1];
+      }
+    }
+
+    receive_count[r]  = m_x_count[r] * ym;
+    receive_offset[r] = m_x_start[r] * ym;
+  }
+
+  all_to_all(m_com,
+             m_send, send_count, send_offset,
+             m_receive, receive_count, receive_offset);
+
+  // unpack
+  for (int r = 0; r < size; ++r) {
+    for (int jj = 0; jj < ym; ++jj) {
+      for (int ii = 0; ii < m_x_count[r]; ++ii) {
+        fftw_complex &d = m_spectrum[jj * m_Nx + m_x_start[r] + ii];
+        const fftw_complex &s = m_receive[receive_offset[r] + jj * m_x_count[r] + ii];
+        d[0] = s[0];
+        d[1] = s[1];
+      }
+    }
+  }
+}
+
+//! Move data from the column-distributed spectrum() to the row-distributed space().
+void SlabFFT::transpose_inverse() {
+  const int size = m_x_count.size();
+  const int xm = this->xm(), ym = this->ym();
+
+  std::vector<int> send_count(size), send_offset(size), receive_count(size), receive_offset(size);
+
+  // pack: the block sent to rank r contains rows owned by r, stored as [i][j]
+  for (int r = 0; r < size; ++r) {
+    send_count[r]  = ym * m_x_count[r];
+    send_offset[r] = ym * m_x_start[r];
+
+    for (int ii = 0; ii < m_x_count[r]; ++ii) {
+      const int i = m_x_start[r] + ii;
+      for (int jj = 0; jj < ym; ++jj) {
+        fftw_complex &d = m_send[send_offset[r] + ii * ym + jj];
+        const fftw_complex &s = m_spectrum[jj * m_Nx + i];
+        d[0] = s[0];
+        d[1] = s[1];
+      }
+    }
+
+    receive_count[r]  = xm * m_y_count[r];
+    receive_offset[r] = xm * m_y_start[r];
+  }
+
+  all_to_all(m_com,
+             m_send, send_count, send_offset,
+             m_receive, receive_count, receive_offset);
+
+  // unpack
+  for (int r = 0; r < size; ++r) {
+    for (int ii = 0; ii < xm; ++ii) {
+      for (int jj = 0; jj < m_y_count[r]; ++jj) {
+        fftw_complex &d = m_space[ii * m_Ny + m_y_start[r] + jj];
+        const fftw_complex &s = m_receive[receive_offset[r] + ii * m_y_count[r] + jj];
+        d[0] = s[0];
+        d[1] = s[1];
+      }
+    }
+  }
+}
+
+} // end of namespace bed
+} // end of namespace pism
@@ -0,0 +1,88 @@
+/* Copyright (C) 2018 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _SLABFFT_H_
+#define _SLABFFT_H_
+
+#include <vector>
+
+#include <mpi.h>
+#include <fftw3.h>
+
+namespace pism {
+namespace bed {
+
+//! Distributed 2D complex FFT using the slab decomposition.
+/*!
+ * The Nx by Ny array (index `i` in `[0, Nx)` varies slowest) is split into slabs of
+ * rows: each rank owns rows `[xs(), xs() + xm())` in physical space. The array in physical
+ * space is stored as
+ *
+ *     space()[(i - xs()) * Ny + j]
+ *
+ * A transform is computed using serial FFTW transforms along `j`, a global transpose
+ * (`MPI_Alltoallv`) and transforms along `i`. The result is distributed by columns: each
+ * rank owns columns `[ys(), ys() + ym())` of the spectrum, stored as
+ *
+ *     spectrum()[(j - ys()) * Nx + i]
+ *
+ * Inverse transforms are not normalized (same as in FFTW).
+ */
+class SlabFFT {
+public:
+  SlabFFT(MPI_Comm com, int Nx, int Ny);
+  ~SlabFFT();
+
+  int xs() const;
+  int xm() const;
+  int ys() const;
+  int ym() const;
+
+  fftw_complex* space() const;
+  fftw_complex* spectrum() const;
+
+  void forward();
+  void inverse();
+private:
+  void transpose_forward();
+  void transpose_inverse();
+
+  MPI_Comm m_com;
+  int m_Nx, m_Ny;
+  int m_rank;
+
+  //! ownership ranges of all ranks in physical space (rows)
+  std::vector<int> m_x_start, m_x_count;
+  //! ownership ranges of all ranks in Fourier space (columns)
+  std::vector<int> m_y_start, m_y_count;
+
+  fftw_complex *m_space;
+  fftw_complex *m_spectrum;
+  fftw_complex *m_send;
+  fftw_complex *m_receive;
+
+  //! transforms along `j` (in physical space) and along `i` (in Fourier space); NULL if a
+  //! rank does not own any rows (columns)
+  fftw_plan m_forward_j, m_inverse_j, m_forward_i, m_inverse_i;
+};
+
+} // end of namespace bed
+} // end of namespace pism
+
+#endif /* _SLABFFT_H_ */
@@ -17,6 +17,10 @@
 // Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <cmath>                // sqrt
+#include <cstdio>               // snprintf, rename
+#include <unistd.h>             // getpid
+#include <algorithm>            // std::max, std::min
+#include <map>
 #include <fftw3.h>
 #include <gsl/gsl_math.h>       // M_PI
 
@@ -28,77 +32,51 @@
 #include "pism/util/ConfigInterface.hh"
 #include "pism/util/error_handling.hh"
 #include "pism/util/petscwrappers/Vec.hh"
+#include "pism/util/petscwrappers/IS.hh"
+#include "pism/util/IceGrid.hh"
+#include "pism/util/iceModelVec.hh"
+#include "pism/util/pism_utilities.hh"
+#include "pism/util/io/PIO.hh"
+#include "pism/util/io/io_helpers.hh"
 
 namespace pism {
 namespace bed {
 
-template <class T>
-class VecAccessor2D {
-public:
-  VecAccessor2D(T* a, int Mx, int My, int i_offset, int j_offset)
-    : m_Mx(Mx), m_My(My), m_i_offset(i_offset), m_j_offset(j_offset), m_array(a) {}
-
-  VecAccessor2D(T* a, int Mx, int My)
-    : m_Mx(Mx), m_My(My), m_i_offset(0), m_j_offset(0), m_array(a) {}
-
-  inline T& operator()(int i, int j) {
-    return m_array[(m_j_offset + j) + m_My * (m_i_offset + i)];
-  }
-
-private:
-  int m_Mx, m_My, m_i_offset, m_j_offset;
-  T* m_array;
-};
-
-//! \brief Fill `input` with zeros.
-static void clear_fftw_input(fftw_complex *input, int Nx, int Ny) {
-  VecAccessor2D<fftw_complex> fftw_in(input, Nx, Ny);
-  for (int i = 0; i < Nx; ++i) {
-    for (int j = 0; j < Ny; ++j) {
-      fftw_in(i, j)[0] = 0;
-      fftw_in(i, j)[1] = 0;
-    }
-  }
-}
-
-//! @brief Copy `source` to `destination`.
-static void copy_fftw_output(fftw_complex *source, fftw_complex *destination,
-                             int Nx, int Ny) {
-  VecAccessor2D<fftw_complex> S(source, Nx, Ny), D(destination, Nx, Ny);
-  for (int i = 0; i < Nx; ++i) {
-    for (int j = 0; j < Ny; ++j) {
-      D(i, j)[0] = S(i, j)[0];
-      D(i, j)[1] = S(i, j)[1];
-    }
-  }
+static MPI_Comm duplicate(MPI_Comm com) {
+  MPI_Comm result = MPI_COMM_NULL;
+  int err = MPI_Comm_dup(com, &result);
+  PISM_C_CHK(err, 0, "MPI_Comm_dup");
+  return result;
 }
 
 /*!
  * @param[in] config configuration database
  * @param[in] include_elastic include elastic deformation component
- * @param[in] Mx grid size in the X direction
- * @param[in] My grid size in the Y direction
- * @param[in] dx grid spacing in the X direction
- * @param[in] dy grid spacing in the Y direction
- * @param[in] Nx extended grid size in the X direction
- * @param[in] Ny extended grid size in the Y direction
+ * @param[in] grid PISM's grid
+ * @param[in] extended_grid extended grid used by the spectral method
  */
 BedDeformLC::BedDeformLC(const Config &config,
                          bool include_elastic,
-                         int Mx, int My,
-                         double dx, double dy,
-                         int Nx, int Ny) {
+                         const IceGrid &grid,
+                         const IceGrid &extended_grid)
+  : m_com(grid.com),
+    m_fft_com(duplicate(grid.com)),
+    m_fft(m_fft_com, extended_grid.Mx(), extended_grid.My()),
+    m_step_in_progress(false),
+    m_H_array(nullptr),
+    m_Uv_array(nullptr),
+    m_Ue_array(nullptr) {
 
   // set parameters
   m_include_elastic = include_elastic;
 
   // grid parameters
-  m_Mx = Mx;
-  m_My = My;
-  m_dx = dx;
-  m_dy = dy;
-  m_Nx = Nx;
-  m_Ny = Ny;
+  m_Mx = grid.Mx();
+  m_My = grid.My();
+  m_dx = grid.dx();
+  m_dy = grid.dy();
+  m_Nx = extended_grid.Mx();
+  m_Ny = extended_grid.My();
 
   m_load_density   = config.get_double("constants.ice.density");
   m_mantle_density = config.get_double("bed_deformation.mantle_density");
@@ -110,89 +88,187 @@ BedDeformLC::BedDeformLC(const Config &config,
   // derive more parameters
   m_Lx        = 0.5 * (m_Nx - 1.0) * m_dx;
   m_Ly        = 0.5 * (m_Ny - 1.0) * m_dy;
-  m_Nxge      = m_Nx + 1;
-  m_Nyge      = m_Ny + 1;
-  m_i0_offset = (Nx - Mx) / 2;
-  m_j0_offset = (Ny - My) / 2;
-
-  // memory allocation
-  PetscErrorCode ierr = 0;
+  m_i0_offset = (m_Nx - m_Mx) / 2;
+  m_j0_offset = (m_Ny - m_My) / 2;
+
+  // The spectral method computes a circular convolution on the extended grid. It matches
+  // the linear convolution on the physical grid if the extended grid is at least (2*Mx - 1)
+  // by (2*My - 1), i.e. if grid_size_factor >= 2.
+  m_elastic_fft = (config.get_boolean("bed_deformation.lc.elastic_model_fft") and
+                   m_Nx >= 2 * m_Mx - 1 and
+                   m_Ny >= 2 * m_My - 1);
+
+  // The load response matrix depends on the grid size and spacing only, so we can save it
+  // and re-use it in later runs.
+  m_output_format = config.get_string("output.format");
+  if (m_include_elastic and config.get_boolean("bed_deformation.lc.elastic_model_cache")) {
+    std::string directory = config.get_string("bed_deformation.lc.elastic_model_cache_directory");
+    if (directory.empty()) {
+      // use the directory containing the output file
+      std::string output = config.get_string("output.file_name");
+      size_t k = output.find_last_of('/');
+      directory = k == std::string::npos ? "." : output.substr(0, k);
+    }
 
-  // total displacement
-  ierr = VecCreateSeq(PETSC_COMM_SELF, m_Mx * m_My, m_U.rawptr());;
-  PISM_CHK(ierr, "VecCreateSeq");
+    char filename[TEMPORARY_STRING_LENGTH];
+    snprintf(filename, sizeof(filename), "lc_load_response_%dx%d_%.10gx%.10g.nc",
+             m_Mx, m_My, m_dx, m_dy);
 
-  // elastic displacement
-  ierr = VecCreateSeq(PETSC_COMM_SELF, m_Mx * m_My, m_Ue.rawptr());;
-  PISM_CHK(ierr, "VecCreateSeq");
+    m_cache_file = directory + "/" + filename;
+  }
 
-  // viscous displacement
-  ierr = VecCreateSeq(PETSC_COMM_SELF, m_Nx * m_Ny, m_Uv.rawptr());
-  PISM_CHK(ierr, "VecCreateSeq");
+  // The spectral part of a step can run on a helper thread, overlapping with the rest of
+  // the time step. This thread uses MPI (m_fft_com), so MPI has to support
+  // MPI_THREAD_MULTIPLE.
+  m_asynchronous = config.get_boolean("bed_deformation.lc.asynchronous");
+  if (m_asynchronous) {
+    int provided = MPI_THREAD_SINGLE;
+    int err = MPI_Query_thread(&provided);
+    PISM_C_CHK(err, 0, "MPI_Query_thread");
+
+    if (provided < MPI_THREAD_MULTIPLE) {
+      PetscErrorCode ierr = PetscPrintf(m_com,
+                                        "PISM WARNING: MPI does not support MPI_THREAD_MULTIPLE or it was not requested.\n"
+                                        "              Bed deformation updates will not be asynchronous.\n"
+                                        "              (PISM requests MPI_THREAD_MULTIPLE only if -bed_def_lc_asynchronous\n"
+                                        "              is given on the command line.)\n");
+      PISM_CHK(ierr, "PetscPrintf");
+      m_asynchronous = false;
+    }
+  }
 
-  // elastic load response matrix
-  ierr = VecCreateSeq(PETSC_COMM_SELF, m_Nxge * m_Nyge, m_load_response_matrix.rawptr());
-  PISM_CHK(ierr, "VecCreateSeq");
+  // memory allocation
+  {
+    PetscErrorCode ierr = 0;
 
-  // setup fftw stuff: FFTW builds "plans" based on observed performance
-  m_fftw_input  = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * m_Nx * m_Ny);
-  m_fftw_output = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * m_Nx * m_Ny);
-  m_loadhat     = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * m_Nx * m_Ny);
+    // all these use the extended grid distributed as rows of SlabFFT
+    std::vector<petsc::Vec*> vecs = {&m_H, &m_work, &m_Uv, &m_Ue, &m_U};
+    if (m_include_elastic) {
+      vecs.push_back(&m_load_response_matrix);
+    }
 
-  // fill m_fftw_input with zeros
-  {
-    VecAccessor2D<fftw_complex> tmp(m_fftw_input, m_Nx, m_Ny);
-    for (int j = 0; j < m_Ny; j++) {
-      for (int i = 0; i < m_Nx; i++) {
-        tmp(i, j)[0] = 0.0;
-        tmp(i, j)[1] = 0.0;
-      }
+    for (auto v : vecs) {
+      ierr = VecCreateMPI(m_com, m_fft.xm() * m_Ny, PETSC_DETERMINE, v->rawptr());
+      PISM_CHK(ierr, "VecCreateMPI");
     }
+
+    ierr = VecSet(m_Ue, 0.0); PISM_CHK(ierr, "VecSet");
   }
 
-  m_dft_forward = fftw_plan_dft_2d(m_Nx, m_Ny, m_fftw_input, m_fftw_output,
-                                   FFTW_FORWARD, FFTW_ESTIMATE);
-  m_dft_inverse = fftw_plan_dft_2d(m_Nx, m_Ny, m_fftw_input, m_fftw_output,
-                                   FFTW_BACKWARD, FFTW_ESTIMATE);
+  m_loadhat.resize(2 * m_fft.ym() * m_Nx);
 
-  // Note: FFTW is weird. If a malloc() call fails it will just call
-  // abort() on you without giving you a chance to recover or tell the
-  // user what happened. This is why we don't check return values of
-  // fftw_malloc() and fftw_plan_dft_2d() calls here...
-  //
-  // (Constantine Khroulev, February 1, 2015)
+  create_scatter(grid, m_i0_offset, m_j0_offset, m_scatter);
+  create_scatter(extended_grid, 0, 0, m_extended_scatter);
 
   precompute_coefficients();
 }
 
 BedDeformLC::~BedDeformLC() {
-  fftw_destroy_plan(m_dft_forward);
-  fftw_destroy_plan(m_dft_inverse);
-  fftw_free(m_fftw_input);
-  fftw_free(m_fftw_output);
-  fftw_free(m_loadhat);
+  try {
+    step_end();
+  } catch (...) {
+    // there is nothing we can do here
+  }
+
+  MPI_Comm_free(&m_fft_com);
+}
+
+/*!
+ * Create the scatter from a field on `grid` to a Vec on the extended grid distributed as
+ * SlabFFT rows. The corner of `grid` corresponds to `(i0, j0)` on the extended grid.
+ */
+void BedDeformLC::create_scatter(const IceGrid &grid, int i0, int j0,
+                                 petsc::VecScatter &result) {
+  PetscErrorCode ierr = 0;
+
+  const int
+    Mx = grid.Mx(),
+    My = grid.My(),
+    xs = m_fft.xs(),
+    xm = m_fft.xm();
+
+  std::vector<PetscInt> from, to;
+  for (int i = std::max(xs, i0); i < std::min(xs + xm, i0 + Mx); ++i) {
+    for (int j = j0; j < j0 + My; ++j) {
+      // the natural ordering of a PISM field
+      from.push_back((j - j0) * Mx + (i - i0));
+      to.push_back(i * m_Ny + j);
+    }
+  }
+
+  petsc::DM::Ptr dm = grid.get_dm(1, 0);
+
+  AO ao;
+  ierr = DMDAGetAO(*dm, &ao);
+  PISM_CHK(ierr, "DMDAGetAO");
+
+  ierr = AOApplicationToPetsc(ao, from.size(), from.data());
+  PISM_CHK(ierr, "AOApplicationToPetsc");
+
+  petsc::IS is_from, is_to;
+  ierr = ISCreateGeneral(m_com, from.size(), from.data(), PETSC_COPY_VALUES, is_from.rawptr());
+  PISM_CHK(ierr, "ISCreateGeneral");
+
+  ierr = ISCreateGeneral(m_com, to.size(), to.data(), PETSC_COPY_VALUES, is_to.rawptr());
+  PISM_CHK(ierr, "ISCreateGeneral");
+
+  petsc::TemporaryGlobalVec field(dm);
+
+  ierr = VecScatterCreate(field, is_from, m_H, is_to, result.rawptr());
+  PISM_CHK(ierr, "VecScatterCreate");
+}
+
+//! Scatter `input` to the slab-distributed Vec `output`, filling the rest with zeros.
+void BedDeformLC::to_slab(const IceModelVec2S &input, ::VecScatter scatter, Vec output) {
+  PetscErrorCode ierr = 0;
+
+  petsc::DM::Ptr dm = input.get_grid()->get_dm(1, 0);
+  petsc::TemporaryGlobalVec tmp(dm);
+  input.copy_to_vec(dm, tmp);
+
+  ierr = VecSet(output, 0.0); PISM_CHK(ierr, "VecSet");
+
+  ierr = VecScatterBegin(scatter, tmp, output, INSERT_VALUES, SCATTER_FORWARD);
+  PISM_CHK(ierr, "VecScatterBegin");
+
+  ierr = VecScatterEnd(scatter, tmp, output, INSERT_VALUES, SCATTER_FORWARD);
+  PISM_CHK(ierr, "VecScatterEnd");
+}
+
+//! Get the part of the slab-distributed Vec `input` corresponding to `output`.
+void BedDeformLC::from_slab(Vec input, ::VecScatter scatter, IceModelVec2S &output) {
+  PetscErrorCode ierr = 0;
+
+  petsc::DM::Ptr dm = output.get_grid()->get_dm(1, 0);
+  petsc::TemporaryGlobalVec tmp(dm);
+
+  ierr = VecScatterBegin(scatter, input, tmp, INSERT_VALUES, SCATTER_REVERSE);
+  PISM_CHK(ierr, "VecScatterBegin");
+
+  ierr = VecScatterEnd(scatter, input, tmp, INSERT_VALUES, SCATTER_REVERSE);
+  PISM_CHK(ierr, "VecScatterEnd");
+
+  output.copy_from_vec(tmp);
 }
 
 /*!
- * Return total displacement.
+ * Get total displacement on the PISM grid.
  */
-Vec BedDeformLC::total_displacement() const {
-  return m_U;
+void BedDeformLC::get_total_displacement(IceModelVec2S &result) {
+  from_slab(m_U, m_scatter, result);
 }
 
 /*!
- * Return viscous plate displacement.
+ * Get viscous plate displacement on the extended grid.
  */
-Vec BedDeformLC::viscous_displacement() const {
-  return m_Uv;
+void BedDeformLC::get_viscous_displacement(IceModelVec2S &result) {
+  from_slab(m_Uv, m_extended_scatter, result);
 }
 
 /**
  * Pre-compute coefficients used by the model.
  */
 void BedDeformLC::precompute_coefficients() {
-  PetscErrorCode ierr = 0;
-
   m_cx.resize(m_Nx);
   m_cy.resize(m_Ny);
 
@@ -214,27 +290,225 @@ void BedDeformLC::precompute_coefficients() {
     m_cy[j] = (M_PI / m_Ly) * (m_Ny - j);
   }
 
-  // compare geforconv.m
   if (m_include_elastic) {
-    ierr = PetscPrintf(PETSC_COMM_SELF,
-                       "     computing spherical elastic load response matrix ...");
-    PISM_CHK(ierr, "PetscPrintf");
+    if (m_cache_file.empty() or not read_load_response_matrix(m_cache_file)) {
+      compute_load_response_matrix();
+
+      if (not m_cache_file.empty()) {
+        write_load_response_matrix(m_cache_file);
+      }
+    }
+
+    if (m_elastic_fft) {
+      precompute_load_response_hat();
+    } else {
+      prepare_direct_method();
+    }
+  }
+}
+
+/*!
+ * Compute the load response matrix (compare geforconv.m).
+ *
+ * Only entries with 1 <= i < Mx and 1 <= j < My are used by the convolution (see
+ * compute_elastic_response()). Each rank computes entries in its rows.
+ */
+void BedDeformLC::compute_load_response_matrix() {
+  PetscErrorCode ierr = 0;
+
+  ierr = PetscPrintf(m_com,
+                     "     computing spherical elastic load response matrix ...");
+  PISM_CHK(ierr, "PetscPrintf");
+
+  ierr = VecSet(m_load_response_matrix, 0.0); PISM_CHK(ierr, "VecSet");
+
+  {
+    petsc::VecArray G(m_load_response_matrix);
+    double *g = G.get();
+
+    const int xs = m_fft.xs(), xm = m_fft.xm();
 
-    petsc::VecArray2D II(m_load_response_matrix, m_Nxge, m_Nyge);
     ge_params ge_data;
     ge_data.dx = m_dx;
     ge_data.dy = m_dy;
-    for (int j = 0; j < m_Nyge; j++) {
-      for (int i = 0; i < m_Nxge; i++) {
+
+    for (int i = std::max(xs, 1); i < std::min(xs + xm, m_Mx); ++i) {
+      for (int j = 1; j < m_My; ++j) {
         ge_data.p = i;
         ge_data.q = j;
-        II(i, j) = dblquad_cubature(ge_integrand, -m_dx/2, m_dx/2, -m_dy/2, m_dy/2,
-                                    1.0e-8, &ge_data);
+        g[(i - xs) * m_Ny + j] = dblquad_cubature(ge_integrand, -m_dx/2, m_dx/2, -m_dy/2, m_dy/2,
+                                                  1.0e-8, &ge_data);
+      }
+    }
+  }
+
+  ierr = PetscPrintf(m_com, " done\n");
+  PISM_CHK(ierr, "PetscPrintf");
+}
+
+//! Name of the load response matrix in the cache file.
+static const char *load_response_name = "load_response_matrix";
+
+/*!
+ * Read the load response matrix from a cache file.
+ *
+ * The matrix depends on the grid size and spacing only, so these are saved as attributes
+ * and checked here.
+ *
+ * Returns false if the file does not exist or was created using different parameters.
+ */
+bool BedDeformLC::read_load_response_matrix(const std::string &filename) {
+  PetscErrorCode ierr = 0;
+
+  if (not file_exists(m_com, filename)) {
+    return false;
+  }
+
+  PIO file(m_com, "guess_mode", filename, PISM_READONLY);
+
+  if (not file.inq_var(load_response_name)) {
+    return false;
+  }
+
+  std::map<std::string, double> parameters = {{"Mx", m_Mx}, {"My", m_My},
+                                               {"dx", m_dx}, {"dy", m_dy}};
+  for (auto p : parameters) {
+    std::vector<double> value = file.get_att_double(load_response_name, p.first);
+    if (value.size() != 1 or value[0] != p.second) {
+      return false;
+    }
+  }
+
+  ierr = PetscPrintf(m_com,
+                     "     reading spherical elastic load response matrix from '%s'...\n",
+                     filename.c_str());
+  PISM_CHK(ierr, "PetscPrintf");
+
+  const unsigned int
+    i_start = std::min(m_fft.xs(), m_Mx),
+    i_end   = std::min(m_fft.xs() + m_fft.xm(), m_Mx),
+    N       = i_end - i_start;
+
+  std::vector<double> buffer(N * m_My);
+  file.get_vara_double(load_response_name, {i_start, 0}, {N, (unsigned int)m_My},
+                       buffer.data());
+
+  ierr = VecSet(m_load_response_matrix, 0.0); PISM_CHK(ierr, "VecSet");
+
+  petsc::VecArray G(m_load_response_matrix);
+  double *g = G.get();
+  for (unsigned int k = 0; k < N; ++k) {
+    for (int j = 0; j < m_My; ++j) {
+      g[(i_start + k - m_fft.xs()) * m_Ny + j] = buffer[k * m_My + j];
+    }
+  }
+
+  return true;
+}
+
+/*!
+ * Save the load response matrix to a cache file so that later runs using the same grid can
+ * skip computing it.
+ *
+ * Writes to a temporary file first and renames it, so that other runs reading the cache
+ * at the same time never see an incomplete file.
+ */
+void BedDeformLC::write_load_response_matrix(const std::string &filename) {
+  PetscErrorCode ierr = 0;
+
+  ierr = PetscPrintf(m_com,
+                     "     saving spherical elastic load response matrix to '%s'...\n",
+                     filename.c_str());
+  PISM_CHK(ierr, "PetscPrintf");
+
+  // use the process ID of rank 0 to get a temporary file name that is unique even if
+  // several runs write the same cache file
+  int pid = getpid();
+  MPI_Bcast(&pid, 1, MPI_INT, 0, m_com);
+
+  char tmp_filename[TEMPORARY_STRING_LENGTH];
+  snprintf(tmp_filename, sizeof(tmp_filename), "%s.tmp%d", filename.c_str(), pid);
+
+  {
+    PIO file(m_com, m_output_format, tmp_filename, PISM_READWRITE_CLOBBER);
+
+    file.def_dim("p", m_Mx);
+    file.def_dim("q", m_My);
+    file.def_var(load_response_name, PISM_DOUBLE, {"p", "q"});
+    file.put_att_text(load_response_name, "long_name",
+                      "spherical elastic load response matrix (Lingle-Clark bed deformation model)");
+    file.put_att_double(load_response_name, "Mx", PISM_DOUBLE, m_Mx);
+    file.put_att_double(load_response_name, "My", PISM_DOUBLE, m_My);
+    file.put_att_double(load_response_name, "dx", PISM_DOUBLE, m_dx);
+    file.put_att_double(load_response_name, "dy", PISM_DOUBLE, m_dy);
+
+    const unsigned int
+      i_start = std::min(m_fft.xs(), m_Mx),
+      i_end   = std::min(m_fft.xs() + m_fft.xm(), m_Mx),
+      N       = i_end - i_start;
+
+    std::vector<double> buffer(N * m_My);
+    {
+      petsc::VecArray G(m_load_response_matrix);
+      const double *g = G.get();
+      for (unsigned int k = 0; k < N; ++k) {
+        for (int j = 0; j < m_My; ++j) {
+          buffer[k * m_My + j] = g[(i_start + k - m_fft.xs()) * m_Ny + j];
+        }
       }
     }
 
-    ierr = PetscPrintf(PETSC_COMM_SELF, " done\n");
-    PISM_CHK(ierr, "PetscPrintf");
+    file.put_vara_double(load_response_name, {i_start, 0}, {N, (unsigned int)m_My},
+                         buffer.data());
+
+    file.close();
+  }
+
+  int rank = 0;
+  MPI_Comm_rank(m_com, &rank);
+
+  int stat = 0;
+  if (rank == 0) {
+    stat = rename(tmp_filename, filename.c_str());
+  }
+  MPI_Bcast(&stat, 1, MPI_INT, 0, m_com);
+
+  if (stat != 0) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION, "can't move '%s' to '%s'",
+                                  tmp_filename, filename.c_str());
+  }
+}
+
+/*!
+ * Compute the Fourier transform of the load response matrix.
+ *
+ * The load response matrix @f$ G(p, q) @f$ is stored in the corner of the extended grid
+ * and is zero outside of @f$ 1 \le p < M_x @f$, @f$ 1 \le q < M_y @f$.
+ */
+void BedDeformLC::precompute_load_response_hat() {
+  {
+    petsc::VecArray G(m_load_response_matrix);
+    set_fftw_input(G.get(), 1.0);
+  }
+  m_fft.forward();
+
+  const int N = m_fft.ym() * m_Nx;
+  m_load_response_hat.resize(2 * N);
+
+  fftw_complex *G_hat = m_fft.spectrum();
+  for (int k = 0; k < N; ++k) {
+    m_load_response_hat[2 * k + 0] = G_hat[k][0];
+    m_load_response_hat[2 * k + 1] = G_hat[k][1];
+  }
+}
+
+//! Copy the spectrum computed by `fft` to `result` (interleaved real and imaginary parts).
+static void save_spectrum(const SlabFFT &fft, int Nx, std::vector<double> &result) {
+  const int N = fft.ym() * Nx;
+  fftw_complex *spectrum = fft.spectrum();
+  for (int k = 0; k < N; ++k) {
+    result[2 * k + 0] = spectrum[k][0];
+    result[2 * k + 1] = spectrum[k][1];
   }
 }
 
@@ -251,49 +525,51 @@ void BedDeformLC::precompute_coefficients() {
  * Here `ice_thickness` is used to compute the load @f$ \sigma_{zz} @f$ and `bed_uplift` is
  * @f$ \diff{u}{t} @f$ itself.
  *
+ * All arguments use the extended grid.
  */
 void BedDeformLC::uplift_problem(Vec load_thickness, Vec bed_uplift,
                                  Vec output) {
 
+  petsc::VecArray H(load_thickness), uplift(bed_uplift), U(output);
+
   // Compute fft2(-load_density * g * load_thickness)
   {
-    clear_fftw_input(m_fftw_input, m_Nx, m_Ny);
-    set_fftw_input(load_thickness, - m_load_density * m_standard_gravity, m_Mx, m_My, m_i0_offset, m_j0_offset);
-    fftw_execute(m_dft_forward);
+    set_fftw_input(H.get(), - m_load_density * m_standard_gravity);
+    m_fft.forward();
     // Save fft2(-load_density * g * load_thickness) in loadhat.
-    copy_fftw_output(m_fftw_output, m_loadhat, m_Nx, m_Ny);
+    save_spectrum(m_fft, m_Nx, m_loadhat);
   }
 
   // fft2(uplift)
   {
-    clear_fftw_input(m_fftw_input, m_Nx, m_Ny);
-    set_fftw_input(bed_uplift, 1.0, m_Mx, m_My, m_i0_offset, m_j0_offset);
-    fftw_execute(m_dft_forward);
+    set_fftw_input(uplift.get(), 1.0);
+    m_fft.forward();
   }
 
   {
-    VecAccessor2D<fftw_complex>
-      u0_hat(m_fftw_input, m_Nx, m_Ny),
-      load_hat(m_loadhat, m_Nx, m_Ny),
-      uplift_hat(m_fftw_output, m_Nx, m_Ny);
+    fftw_complex *uplift_hat = m_fft.spectrum();
+    const double *load_hat = m_loadhat.data();
 
-    for (int i = 0; i < m_Nx; i++) {
-      for (int j = 0; j < m_Ny; j++) {
+    for (int jj = 0; jj < m_fft.ym(); jj++) {
+      const int j = m_fft.ys() + jj;
+      for (int i = 0; i < m_Nx; i++) {
+        const int k = jj * m_Nx + i;
         const double
           C = m_cx[i]*m_cx[i] + m_cy[j]*m_cy[j],
           A = - 2.0 * m_eta * sqrt(C),
           B = m_mantle_density * m_standard_gravity + m_D * C * C;
 
-        u0_hat(i, j)[0] = (load_hat(i, j)[0] + A * uplift_hat(i, j)[0]) / B;
-        u0_hat(i, j)[1] = (load_hat(i, j)[1] + A * uplift_hat(i, j)[1]) / B;
+        // u0_hat
+        uplift_hat[k][0] = (load_hat[2 * k + 0] + A * uplift_hat[k][0]) / B;
+        uplift_hat[k][1] = (load_hat[2 * k + 1] + A * uplift_hat[k][1]) / B;
       }
     }
   }
 
-  fftw_execute(m_dft_inverse);
-  get_fftw_output(output, 1.0 / (m_Nx * m_Ny), m_Nx, m_Ny, 0, 0);
+  m_fft.inverse();
+  get_fftw_output(U.get(), 1.0 / (m_Nx * m_Ny));
 
-  tweak(load_thickness, output, m_Nx, m_Ny, 0.0);
+  tweak(H.get(), U.get(), 0.0);
 }
 
 /*! Initialize using provided load thickness and the bed uplift rate.
@@ -315,13 +591,16 @@ void BedDeformLC::uplift_problem(Vec load_thickness, Vec bed_uplift,
  *
  * Sets m_Uv, m_Ue, m_U.
  */
-void BedDeformLC::bootstrap(Vec thickness, Vec uplift) {
+void BedDeformLC::bootstrap(const IceModelVec2S &thickness, const IceModelVec2S &uplift) {
+
+  to_slab(thickness, m_scatter, m_H);
+  to_slab(uplift, m_scatter, m_work);
 
   // compute viscous displacement
-  uplift_problem(thickness, uplift, m_Uv);
+  uplift_problem(m_H, m_work, m_Uv);
 
   if (m_include_elastic) {
-    compute_elastic_response(thickness, m_Ue);
+    compute_elastic_response(m_H, m_Ue);
   } else {
     PetscErrorCode ierr = VecSet(m_Ue, 0.0); PISM_CHK(ierr, "VecSet");
   }
@@ -332,19 +611,21 @@ void BedDeformLC::bootstrap(Vec thickness, Vec uplift) {
 /*!
  * Initialize using provided plate displacement.
  *
- * @param[in] V initial viscous plate displacement on the extended grid
+ * @param[in] thickness load thickness on the PISM grid
+ * @param[in] viscous_displacement initial viscous plate displacement on the extended grid
  *
  * Sets m_Uv, m_Ue, m_U.
  */
-void BedDeformLC::init(Vec thickness, Vec viscous_displacement) {
-  PetscErrorCode ierr = 0;
+void BedDeformLC::init(const IceModelVec2S &thickness,
+                       const IceModelVec2S &viscous_displacement) {
 
-  ierr = VecCopy(viscous_displacement, m_Uv);  PISM_CHK(ierr, "VecCopy");
+  to_slab(viscous_displacement, m_extended_scatter, m_Uv);
 
   if (m_include_elastic) {
-    compute_elastic_response(thickness, m_Ue);
+    to_slab(thickness, m_scatter, m_H);
+    compute_elastic_response(m_H, m_Ue);
   } else {
-    ierr = VecSet(m_Ue, 0.0); PISM_CHK(ierr, "VecSet");
+    PetscErrorCode ierr = VecSet(m_Ue, 0.0); PISM_CHK(ierr, "VecSet");
   }
 
   update_displacement(m_Uv, m_Ue, m_U);
@@ -354,82 +635,323 @@ void BedDeformLC::init(Vec thickness, Vec viscous_displacement) {
  * Perform a time step.
  *
  * @param[in] dt_seconds time step length
- * @param[in] H load thickness on the physical (Mx*My) grid
+ * @param[in] thickness load thickness on the PISM grid
  */
-void BedDeformLC::step(double dt_seconds, Vec H) {
-  // solves:
-  //     (2 eta |grad| U^{n+1}) + (dt/2) * (rho_r g U^{n+1} + D grad^4 U^{n+1})
-  //   = (2 eta |grad| U^n) - (dt/2) * (rho_r g U^n + D grad^4 U^n) - dt * rho g H_start
-  // where U=plate displacement; see equation (7) in
-  // Bueler, Lingle, Brown (2007) "Fast computation of a viscoelastic
-  // deformable Earth model for ice sheet simulations", Ann. Glaciol. 46, 97--105
-
-  // Compute fft2(-load_density * g * dt * H)
-  {
-    clear_fftw_input(m_fftw_input, m_Nx, m_Ny);
-    set_fftw_input(H,
-                   - m_load_density * m_standard_gravity * dt_seconds,
-                   m_Mx, m_My, m_i0_offset, m_j0_offset);
-    fftw_execute(m_dft_forward);
+void BedDeformLC::step(double dt_seconds, const IceModelVec2S &thickness) {
+  step_begin(dt_seconds, thickness);
+  step_end();
+}
 
-    // Save fft2(-load_density * g * H * dt) in loadhat.
-    copy_fftw_output(m_fftw_output, m_loadhat, m_Nx, m_Ny);
+/*!
+ * Start a time step.
+ *
+ * In the asynchronous mode the spectral part of the step runs on a helper thread and this
+ * method returns right away. Call step_end() to finish the step.
+ *
+ * @param[in] dt_seconds time step length
+ * @param[in] thickness load thickness on the PISM grid
+ */
+void BedDeformLC::step_begin(double dt_seconds, const IceModelVec2S &thickness) {
+  PetscErrorCode ierr = 0;
+
+  if (m_step_in_progress) {
+    throw RuntimeError(PISM_ERROR_LOCATION,
+                       "cannot start a bed deformation step: the previous one is not finished");
   }
 
-  // Compute fft2(u).
-  // no need to clear fftw_input: all values are overwritten
-  {
-    set_fftw_input(m_Uv, 1.0, m_Nx, m_Ny, 0, 0);
-    fftw_execute(m_dft_forward);
+  to_slab(thickness, m_scatter, m_H);
+
+  // The helper thread must not call PETSc, so we give it pointers to local parts of Vecs it
+  // needs. They are restored in step_end().
+  ierr = VecGetArray(m_H, &m_H_array); PISM_CHK(ierr, "VecGetArray");
+  ierr = VecGetArray(m_Uv, &m_Uv_array); PISM_CHK(ierr, "VecGetArray");
+  ierr = VecGetArray(m_Ue, &m_Ue_array); PISM_CHK(ierr, "VecGetArray");
+
+  m_step_in_progress = true;
+  m_step_error       = nullptr;
+
+  if (m_asynchronous) {
+    m_thread = std::thread(&BedDeformLC::spectral_step, this, dt_seconds);
+  } else {
+    spectral_step(dt_seconds);
   }
+}
 
-  // frhs = right.*fft2(uun) + fft2(dt*sszz);
-  // uun1 = real(ifft2(frhs./left));
-  {
-    VecAccessor2D<fftw_complex> input(m_fftw_input, m_Nx, m_Ny),
-      u_hat(m_fftw_output, m_Nx, m_Ny), load_hat(m_loadhat, m_Nx, m_Ny);
-    for (int i = 0; i < m_Nx; i++) {
-      for (int j = 0; j < m_Ny; j++) {
-        const double
-          C     = m_cx[i]*m_cx[i] + m_cy[j]*m_cy[j],
-          part1 = 2.0 * m_eta * sqrt(C),
-          part2 = (dt_seconds / 2.0) * (m_mantle_density * m_standard_gravity + m_D * C * C),
-          A = part1 - part2,
-          B = part1 + part2;
-
-        input(i, j)[0] = (load_hat(i, j)[0] + A * u_hat(i, j)[0]) / B;
-        input(i, j)[1] = (load_hat(i, j)[1] + A * u_hat(i, j)[1]) / B;
-      }
-    }
+/*!
+ * Finish a time step started by step_begin().
+ *
+ * Waits for the helper thread (in the asynchronous mode) and updates the total
+ * displacement.
+ */
+void BedDeformLC::step_end() {
+  PetscErrorCode ierr = 0;
+
+  if (not m_step_in_progress) {
+    return;
   }
 
-  fftw_execute(m_dft_inverse);
-  get_fftw_output(m_Uv, 1.0 / (m_Nx * m_Ny), m_Nx, m_Ny, 0, 0);
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
 
-  // Now tweak. (See the "correction" in section 5 of BuelerLingleBrown.)
-  //
-  // Here 1e16 approximates t = \infty.
-  tweak(H, m_Uv, m_Nx, m_Ny, 1e16);
+  m_step_in_progress = false;
 
-  // now compute elastic response if desired
-  if (m_include_elastic) {
-    compute_elastic_response(H, m_Ue);
+  ierr = VecRestoreArray(m_H, &m_H_array); PISM_CHK(ierr, "VecRestoreArray");
+  ierr = VecRestoreArray(m_Uv, &m_Uv_array); PISM_CHK(ierr, "VecRestoreArray");
+  ierr = VecRestoreArray(m_Ue, &m_Ue_array); PISM_CHK(ierr, "VecRestoreArray");
+
+  if (m_step_error) {
+    std::rethrow_exception(m_step_error);
+  }
+
+  // The direct method of computing the elastic response needs PETSc, so it is not
+  // performed by spectral_step().
+  if (m_include_elastic and not m_elastic_fft) {
+    compute_elastic_response(m_H, m_Ue);
   }
 
   update_displacement(m_Uv, m_Ue, m_U);
 }
 
+//! True if a step was started by step_begin() but is not finished yet.
+bool BedDeformLC::step_in_progress() const {
+  return m_step_in_progress;
+}
+
+//! True if the spectral part of a step runs on a helper thread.
+bool BedDeformLC::asynchronous() const {
+  return m_asynchronous;
+}
+
+/*!
+ * The part of a time step that does not use PETSc: update the viscous displacement and
+ * compute the elastic response using FFT (if enabled).
+ *
+ * Uses m_H_array, m_Uv_array, m_Ue_array set by step_begin(). All communication uses
+ * m_fft_com, so this can run on a helper thread.
+ *
+ * Errors are saved in m_step_error and re-thrown by step_end().
+ */
+void BedDeformLC::spectral_step(double dt_seconds) {
+  try {
+    // solves:
+    //     (2 eta |grad| U^{n+1}) + (dt/2) * (rho_r g U^{n+1} + D grad^4 U^{n+1})
+    //   = (2 eta |grad| U^n) - (dt/2) * (rho_r g U^n + D grad^4 U^n) - dt * rho g H_start
+    // where U=plate displacement; see equation (7) in
+    // Bueler, Lingle, Brown (2007) "Fast computation of a viscoelastic
+    // deformable Earth model for ice sheet simulations", Ann. Glaciol. 46, 97--105
+
+    // Compute fft2(-load_density * g * dt * H)
+    {
+      set_fftw_input(m_H_array, - m_load_density * m_standard_gravity * dt_seconds);
+      m_fft.forward();
+
+      // Save fft2(-load_density * g * H * dt) in loadhat.
+      save_spectrum(m_fft, m_Nx, m_loadhat);
+    }
+
+    // Compute fft2(u).
+    {
+      set_fftw_input(m_Uv_array, 1.0);
+      m_fft.forward();
+    }
+
+    // frhs = right.*fft2(uun) + fft2(dt*sszz);
+    // uun1 = real(ifft2(frhs./left));
+    {
+      fftw_complex *u_hat = m_fft.spectrum();
+      const double *load_hat = m_loadhat.data();
+
+      for (int jj = 0; jj < m_fft.ym(); jj++) {
+        const int j = m_fft.ys() + jj;
+        for (int i = 0; i < m_Nx; i++) {
+          const int k = jj * m_Nx + i;
+          const double
+            C     = m_cx[i]*m_cx[i] + m_cy[j]*m_cy[j],
+            part1 = 2.0 * m_eta * sqrt(C),
+            part2 = (dt_seconds / 2.0) * (m_mantle_density * m_standard_gravity + m_D * C * C),
+            A = part1 - part2,
+            B = part1 + part2;
+
+          u_hat[k][0] = (load_hat[2 * k + 0] + A * u_hat[k][0]) / B;
+          u_hat[k][1] = (load_hat[2 * k + 1] + A * u_hat[k][1]) / B;
+        }
+      }
+    }
+
+    m_fft.inverse();
+    get_fftw_output(m_Uv_array, 1.0 / (m_Nx * m_Ny));
+
+    // Now tweak. (See the "correction" in section 5 of BuelerLingleBrown.)
+    //
+    // Here 1e16 approximates t = \infty.
+    tweak(m_H_array, m_Uv_array, 1e16);
+
+    // now compute elastic response if desired
+    if (m_include_elastic and m_elastic_fft) {
+      elastic_response_fft(m_H_array, m_Ue_array);
+    }
+  } catch (...) {
+    m_step_error = std::current_exception();
+  }
+}
+
 /*!
  * Compute elastic response to the load H
  *
- * @param[in] H load thickness (ice equivalent meters)
- * @param[out] dE elastic plate displacement
+ * We compute
+ *
+ * @f$ U_e(i, j) = \sum_{p = 1}^{i} \sum_{q = 1}^{j} H(i - p, j - q) G(p, q), @f$
+ *
+ * where indexes are relative to the corner of the PISM grid (this matches conv2_same()).
+ *
+ * The FFT method computes the circular convolution of H (placed at the corner of the PISM
+ * grid in the extended grid) with G (placed at the corner of the extended grid). Zero
+ * padding prevents wrap-around if the extended grid is big enough.
+ *
+ * @param[in] H load thickness (ice equivalent meters) on the extended grid
+ * @param[out] dE elastic plate displacement on the extended grid (valid on the PISM grid only)
  */
 void BedDeformLC::compute_elastic_response(Vec H, Vec dE) {
+  PetscErrorCode ierr = 0;
 
-  conv2_same(H, m_Mx, m_My, m_load_response_matrix, m_Nxge, m_Nyge, dE);
+  if (m_elastic_fft) {
+    petsc::VecArray H_array(H), E_array(dE);
+    elastic_response_fft(H_array.get(), E_array.get());
+  } else {
+    ierr = VecScatterBegin(m_H_direct_scatter, H, m_H_direct, INSERT_VALUES, SCATTER_FORWARD);
+    PISM_CHK(ierr, "VecScatterBegin");
+
+    ierr = VecScatterEnd(m_H_direct_scatter, H, m_H_direct, INSERT_VALUES, SCATTER_FORWARD);
+    PISM_CHK(ierr, "VecScatterEnd");
+
+    petsc::VecArray H_array(m_H_direct), E_array(dE);
+    const double
+      *h = H_array.get(),
+      *g = m_G_direct.data();
+    double *e = E_array.get();
+
+    const int
+      xs = m_fft.xs(),
+      xm = m_fft.xm(),
+      i0 = m_i0_offset,
+      j0 = m_j0_offset;
+
+    // h and g use indexes relative to the corner of the PISM grid
+    for (int i = std::max(xs, i0); i < std::min(xs + xm, i0 + m_Mx); ++i) {
+      for (int j = j0; j < j0 + m_My; ++j) {
+        double sum = 0.0;
+        for (int p = 1; p <= i - i0; ++p) {
+          for (int q = 1; q <= j - j0; ++q) {
+            sum += h[(i - i0 - p) * m_My + (j - j0 - q)] * g[p * m_My + q];
+          }
+        }
+        e[(i - xs) * m_Ny + j] = m_load_density * sum;
+      }
+    }
+  }
+}
+
+/*!
+ * Prepare the direct method of computing the elastic response.
+ *
+ * The convolution in compute_elastic_response() uses values of the load in rows `i0` to
+ * `i_end - 2` and values of the load response matrix in rows `0` to `i_end - i0 - 1`,
+ * where `i_end` is the end of the local part of the PISM grid (rows are slabs owned by a
+ * rank). This method creates the scatter used to get the load in these rows (it is re-used
+ * in every call) and gathers the load response matrix, which does not change.
+ */
+void BedDeformLC::prepare_direct_method() {
+  PetscErrorCode ierr = 0;
+
+  const int
+    xs    = m_fft.xs(),
+    xm    = m_fft.xm(),
+    i0    = m_i0_offset,
+    j0    = m_j0_offset,
+    i_end = std::min(xs + xm, i0 + m_Mx),
+    N     = std::max(i_end - i0, 0);
+
+  // rows of the load: i0 to i0 + N - 2 (N - 1 rows), rows of G: 0 to N - 1 (N rows)
+  std::vector<PetscInt> H_indices, G_indices;
+  for (int r = 0; r < N; ++r) {
+    for (int q = 0; q < m_My; ++q) {
+      if (r < N - 1) {
+        H_indices.push_back((i0 + r) * m_Ny + (j0 + q));
+      }
+      G_indices.push_back(r * m_Ny + q);
+    }
+  }
+
+  // the load
+  {
+    petsc::IS is;
+    ierr = ISCreateGeneral(PETSC_COMM_SELF, H_indices.size(), H_indices.data(),
+                           PETSC_COPY_VALUES, is.rawptr());
+    PISM_CHK(ierr, "ISCreateGeneral");
+
+    ierr = VecCreateSeq(PETSC_COMM_SELF, H_indices.size(), m_H_direct.rawptr());
+    PISM_CHK(ierr, "VecCreateSeq");
+
+    ierr = VecScatterCreate(m_H, is, m_H_direct, NULL, m_H_direct_scatter.rawptr());
+    PISM_CHK(ierr, "VecScatterCreate");
+  }
 
-  PetscErrorCode ierr = VecScale(m_Ue, m_load_density); PISM_CHK(ierr, "VecScale");
+  // the load response matrix
+  {
+    petsc::IS is;
+    ierr = ISCreateGeneral(PETSC_COMM_SELF, G_indices.size(), G_indices.data(),
+                           PETSC_COPY_VALUES, is.rawptr());
+    PISM_CHK(ierr, "ISCreateGeneral");
+
+    petsc::Vec G;
+    ierr = VecCreateSeq(PETSC_COMM_SELF, G_indices.size(), G.rawptr());
+    PISM_CHK(ierr, "VecCreateSeq");
+
+    petsc::VecScatter scatter;
+    ierr = VecScatterCreate(m_load_response_matrix, is, G, NULL, scatter.rawptr());
+    PISM_CHK(ierr, "VecScatterCreate");
+
+    ierr = VecScatterBegin(scatter, m_load_response_matrix, G, INSERT_VALUES, SCATTER_FORWARD);
+    PISM_CHK(ierr, "VecScatterBegin");
+
+    ierr = VecScatterEnd(scatter, m_load_response_matrix, G, INSERT_VALUES, SCATTER_FORWARD);
+    PISM_CHK(ierr, "VecScatterEnd");
+
+    petsc::VecArray G_array(G);
+    m_G_direct.assign(G_array.get(), G_array.get() + G_indices.size());
+  }
+}
+
+/*!
+ * Compute the elastic response using FFT. See compute_elastic_response().
+ *
+ * @param[in] H load thickness (local part of the slab-distributed array)
+ * @param[out] dE elastic plate displacement (local part of the slab-distributed array)
+ */
+void BedDeformLC::elastic_response_fft(const double *H, double *dE) {
+  set_fftw_input(H, 1.0);
+  m_fft.forward();
+
+  {
+    fftw_complex *H_hat = m_fft.spectrum();
+    const double *G_hat = m_load_response_hat.data();
+
+    const int N = m_fft.ym() * m_Nx;
+    for (int k = 0; k < N; ++k) {
+      const double
+        a = H_hat[k][0],
+        b = H_hat[k][1],
+        c = G_hat[2 * k + 0],
+        d = G_hat[2 * k + 1];
+
+      H_hat[k][0] = a * c - b * d;
+      H_hat[k][1] = a * d + b * c;
+    }
+  }
+
+  m_fft.inverse();
+  get_fftw_output(dE, m_load_density / (m_Nx * m_Ny));
 }
 
 /*! Compute total displacement by combining viscous and elastic contributions.
@@ -438,20 +960,10 @@ void BedDeformLC::compute_elastic_response(Vec H, Vec dE) {
  * @param[in] dE elastic displacement
  * @param[out] dU total displacement
  */
-void BedDeformLC::update_displacement(Vec Uv, Vec Ue, Vec U) {
-  // PISM grid
-  petsc::VecArray2D
-    u(U, m_Mx, m_My),
-    u_elastic(Ue, m_Mx, m_My);
-  // extended grid
-  petsc::VecArray2D
-    u_viscous(Uv, m_Nx, m_Ny, m_i0_offset, m_j0_offset);
-
-  for (int i = 0; i < m_Mx; i++) {
-    for (int j = 0; j < m_My; j++) {
-      u(i, j) = u_viscous(i, j) + u_elastic(i, j);
-    }
-  }
+void BedDeformLC::update_displacement(Vec V, Vec dE, Vec dU) {
+  // all three use the extended grid; only values on the PISM grid are used
+  PetscErrorCode ierr = VecWAXPY(dU, 1.0, V, dE);
+  PISM_CHK(ierr, "VecWAXPY");
 }
 
 
@@ -463,27 +975,32 @@ void BedDeformLC::update_displacement(Vec Uv, Vec Ue, Vec U) {
  *
  * @param[in] load_thickness thickness of the load (used to compute the corresponding disc volume)
  * @param[in,out] U viscous plate displacement
- * @param[in] Nx grid size
- * @param[in] Ny grid size
  * @param[in] time time, seconds (usually 0 or a large number approximating \infty)
  */
-void BedDeformLC::tweak(Vec load_thickness, Vec U, int Nx, int Ny, double time) {
-  PetscErrorCode ierr = 0;
-  petsc::VecArray2D u(U, Nx, Ny);
+void BedDeformLC::tweak(const double *load_thickness, double *U, double time) {
+  const int
+    xs = m_fft.xs(),
+    xm = m_fft.xm();
 
   // find average value along "distant" boundary of [-Lx, Lx]X[-Ly, Ly]
   // note domain is periodic, so think of cut locus of torus (!)
   // (will remove it:   uun1=uun1-(sum(uun1(1, :))+sum(uun1(:, 1)))/(2*N);)
   double average = 0.0;
-  for (int i = 0; i < Nx; i++) {
-    average += u(i, 0);
-  }
+  {
+    // u(i, 0)
+    for (int i = 0; i < xm; i++) {
+      average += U[i * m_Ny + 0];
+    }
 
-  for (int j = 0; j < Ny; j++) {
-    average += u(0, j);
+    // u(0, j)
+    if (xs == 0 and xm > 0) {
+      for (int j = 0; j < m_Ny; j++) {
+        average += U[j];
+      }
+    }
   }
 
-  average /= (double) (Nx + Ny);
+  average = GlobalSum(m_fft_com, average) / (double) (m_Nx + m_Ny);
 
   double shift = 0.0;
 
@@ -495,7 +1012,10 @@ void BedDeformLC::tweak(Vec load_thickness, Vec U, int Nx, int Ny, double time)
     const double R         = L_average * (2.0 / 3.0);
 
     double H_sum = 0.0;
-    ierr = VecSum(load_thickness, &H_sum); PISM_CHK(ierr, "VecSum");
+    for (int k = 0; k < xm * m_Ny; ++k) {
+      H_sum += load_thickness[k];
+    }
+    H_sum = GlobalSum(m_fft_com, H_sum);
 
     // compute disc thickness by dividing its volume by the area
     const double H = (H_sum * m_dx * m_dy) / (M_PI * R * R);
@@ -510,32 +1030,30 @@ void BedDeformLC::tweak(Vec load_thickness, Vec U, int Nx, int Ny, double time)
                      m_eta);             // mantle viscosity
   }
 
-  ierr = VecShift(U, shift - average); PISM_CHK(ierr, "VecShift");
+  for (int k = 0; k < xm * m_Ny; ++k) {
+    U[k] += shift - average;
+  }
 }
 
-//! \brief Set the real part of fftw_input to vec_input.
+//! \brief Set the real part of fftw_input to input.
 /*!
  * Sets the imaginary part to zero.
  */
-void BedDeformLC::set_fftw_input(Vec vec_input, double normalization, int Mx, int My, int i0, int j0) {
-  petsc::VecArray2D in(vec_input, Mx, My);
-  VecAccessor2D<fftw_complex> input(m_fftw_input, m_Nx, m_Ny, i0, j0);
-  for (int j = 0; j < My; ++j) {
-    for (int i = 0; i < Mx; ++i) {
-      input(i, j)[0] = in(i, j) * normalization;
-      input(i, j)[1] = 0.0;
-    }
+void BedDeformLC::set_fftw_input(const double *input, double normalization) {
+  fftw_complex *space = m_fft.space();
+  const int N = m_fft.xm() * m_Ny;
+  for (int k = 0; k < N; ++k) {
+    space[k][0] = input[k] * normalization;
+    space[k][1] = 0.0;
   }
 }
 
 //! \brief Get the real part of fftw_output and put it in output.
-void BedDeformLC::get_fftw_output(Vec output, double normalization, int Mx, int My, int i0, int j0) {
-  petsc::VecArray2D out(output, Mx, My);
-  VecAccessor2D<fftw_complex> fftw_out(m_fftw_output, m_Nx, m_Ny, i0, j0);
-  for (int j = 0; j < My; ++j) {
-    for (int i = 0; i < Mx; ++i) {
-      out(i, j) = fftw_out(i, j)[0] * normalization;
-    }
+void BedDeformLC::get_fftw_output(double *output, double normalization) {
+  const fftw_complex *space = m_fft.space();
+  const int N = m_fft.xm() * m_Ny;
+  for (int k = 0; k < N; ++k) {
+    output[k] = space[k][0] * normalization;
   }
 }
 
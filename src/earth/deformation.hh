@@ -19,17 +19,22 @@
 #ifndef __deformation_hh
 #define __deformation_hh
 
+#include <string>
 #include <vector>
+#include <thread>
+#include <exception>
 
-#include <petscvec.h>
 #include <fftw3.h>
-#include <vector>
 
 #include "pism/util/petscwrappers/Vec.hh"
+#include "pism/util/petscwrappers/VecScatter.hh"
+#include "SlabFFT.hh"
 
 namespace pism {
 
 class Config;
+class IceGrid;
+class IceModelVec2S;
 
 namespace bed {
 
@@ -45,9 +50,10 @@ namespace bed {
   lithosphere) and a spherical elastic model are computed.  They are superposed
   because the underlying earth model is linear.
 
-  The class assumes that the supplied Petsc Vecs are *sequential*.  It is expected to be
-  run only on processor zero (or possibly by each processor once each processor
-  owns the entire 2D gridded ice thicknesses and bed elevations.)
+  Computations use the extended grid distributed among all ranks of the grid's
+  communicator using the slab decomposition (see SlabFFT). Inputs and outputs are
+  IceModelVec2S on the PISM grid and the extended grid; they are moved to and from the
+  slab decomposition using VecScatters, so no rank has to store a whole field.
 
   This model always assumes that we start with no load. Note that this does not mean that we
   starting state is the equilibrium: the viscous plate may be "pre-bent" by using a provided
@@ -57,30 +63,58 @@ class BedDeformLC {
 public:
   BedDeformLC(const Config &config,
               bool include_elastic,
-              int Mx, int My,
-              double dx, double dy,
-              int Nx, int Ny);
+              const IceGrid &grid,
+              const IceGrid &extended_grid);
   ~BedDeformLC();
 
-  void init(Vec thickness, Vec viscous_displacement);
+  void init(const IceModelVec2S &thickness, const IceModelVec2S &viscous_displacement);
+
+  void bootstrap(const IceModelVec2S &thickness, const IceModelVec2S &uplift);
 
-  void bootstrap(Vec thickness, Vec uplift);
+  void step(double dt_seconds, const IceModelVec2S &thickness);
 
-  void step(double dt_seconds, Vec H);
+  void step_begin(double dt_seconds, const IceModelVec2S &thickness);
+  void step_end();
+  bool step_in_progress() const;
+  bool asynchronous() const;
 
-  Vec total_displacement() const;
+  void get_total_displacement(IceModelVec2S &result);
 
-  Vec viscous_displacement() const;
+  void get_viscous_displacement(IceModelVec2S &result);
 private:
   void compute_elastic_response(Vec H, Vec dE);
+  void prepare_direct_method();
+  void elastic_response_fft(const double *H, double *dE);
+
+  void spectral_step(double dt_seconds);
 
   void uplift_problem(Vec ice_thickness, Vec bed_uplift, Vec output);
 
   void precompute_coefficients();
+  void precompute_load_response_hat();
+
+  void compute_load_response_matrix();
+  bool read_load_response_matrix(const std::string &filename);
+  void write_load_response_matrix(const std::string &filename);
 
   void update_displacement(Vec V, Vec dE, Vec dU);
 
+  void create_scatter(const IceGrid &grid, int i0, int j0, petsc::VecScatter &result);
+  void to_slab(const IceModelVec2S &input, ::VecScatter scatter, Vec output);
+  void from_slab(Vec input, ::VecScatter scatter, IceModelVec2S &output);
+
+  MPI_Comm m_com;
+  //! communicator used by m_fft (a duplicate of m_com, so that the helper thread does not
+  //! interfere with the rest of PISM)
+  MPI_Comm m_fft_com;
+
   bool m_include_elastic;
+  //! true if the elastic response is computed using FFT
+  bool m_elastic_fft;
+  //! name of the file used to cache the load response matrix (empty if disabled)
+  std::string m_cache_file;
+  //! file format used to save the cache file
+  std::string m_output_format;
   // grid size
   int m_Mx;
   int m_My;
@@ -103,10 +137,6 @@ private:
   int m_Nx;
   int m_Ny;
 
-  // size of the extended grid with boundary points
-  int m_Nxge;
-  int m_Nyge;
-
   // indices into extended grid for the corner of the physical grid
   int m_i0_offset;
   int m_j0_offset;
@@ -118,10 +148,25 @@ private:
   // Coefficients of derivatives in Fourier space
   std::vector<double> m_cx, m_cy;
 
+  //! distributed FFT on the extended grid
+  SlabFFT m_fft;
+
+  // All the Vecs below use the extended grid and are distributed as SlabFFT rows.
+
+  //! scatter from the PISM grid to the extended grid (with zero padding)
+  petsc::VecScatter m_scatter;
+  //! scatter from the extended grid (distributed as PISM fields) to slabs
+  petsc::VecScatter m_extended_scatter;
+
+  // load thickness
+  petsc::Vec m_H;
+  // work space (bed uplift)
+  petsc::Vec m_work;
+
   // viscous displacement on the extended grid
   petsc::Vec m_Uv;
 
-  // load response matrix (elastic); sequential and fat *with* boundary
+  // load response matrix (elastic), stored in the corner of the extended grid
   petsc::Vec m_load_response_matrix;
   // elastic plate displacement
   petsc::Vec m_Ue;
@@ -129,17 +174,39 @@ private:
   // total (viscous and elastic) plate displacement
   petsc::Vec m_U;
 
-  fftw_complex *m_fftw_input;
-  fftw_complex *m_fftw_output;
-  fftw_complex *m_loadhat;
-
-  fftw_plan m_dft_forward;
-  fftw_plan m_dft_inverse;
-
-  void tweak(Vec load_thickness, Vec U, int Nx, int Ny, double time);
-
-  void set_fftw_input(Vec input, double normalization, int M, int N, int i0, int j0);
-  void get_fftw_output(Vec output, double normalization, int M, int N, int i0, int j0);
+  //! Fourier transform of the load (distributed as SlabFFT columns)
+  std::vector<double> m_loadhat;
+  //! Fourier transform of the load response matrix (used if m_elastic_fft is set)
+  std::vector<double> m_load_response_hat;
+
+  // The direct method of computing the elastic response (used if m_elastic_fft is not
+  // set) needs the load and the load response matrix in rows below the local part of the
+  // PISM grid only; these are stored as dense arrays with m_My columns.
+
+  //! scatter from the load on the extended grid to m_H_direct
+  petsc::VecScatter m_H_direct_scatter;
+  //! part of the load used by the direct method (sequential)
+  petsc::Vec m_H_direct;
+  //! part of the load response matrix used by the direct method
+  std::vector<double> m_G_direct;
+
+  //! true if the spectral part of a step runs on a helper thread
+  bool m_asynchronous;
+  //! true between step_begin() and step_end()
+  bool m_step_in_progress;
+  //! helper thread running spectral_step()
+  std::thread m_thread;
+  //! error thrown by spectral_step(), re-thrown in step_end()
+  std::exception_ptr m_step_error;
+  // local parts of m_H, m_Uv, m_Ue used by spectral_step()
+  double *m_H_array;
+  double *m_Uv_array;
+  double *m_Ue_array;
+
+  void tweak(const double *load_thickness, double *U, double time);
+
+  void set_fftw_input(const double *input, double normalization);
+  void get_fftw_output(double *output, double normalization);
 };
 
 } // end of namespace bed
@@ -19,6 +19,7 @@
 
 #include "EnthalpyModel.hh"
 #include "pism/util/MaxTimestep.hh"
+#include "pism/age/AgeModel.hh"
 
 namespace pism {
 namespace energy {
@@ -49,9 +50,11 @@ void DummyEnergyModel::bootstrap_impl(const PIO &input_file,
 }
 
 void DummyEnergyModel::update_impl(double t, double dt, const Inputs &inputs) {
-  (void) t;
-  (void) dt;
-  (void) inputs;
+  if (inputs.age_model != NULL) {
+    // this model does not support updating age in the same column sweep
+    inputs.age_model->update(t, dt, AgeModelInputs(inputs.ice_thickness,
+                                                   inputs.u3, inputs.v3, inputs.w3));
+  }
 }
 
 MaxTimestep DummyEnergyModel::max_timestep_impl(double t) const {
@@ -56,6 +56,8 @@ Inputs::Inputs() {
   w3                       = NULL;
 
   no_model_mask = NULL;
+
+  age_model = NULL;
 }
 
 void Inputs::check() const {
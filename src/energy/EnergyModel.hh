@@ -31,6 +31,7 @@ class StressBalance;
 }
 
 class IceModelVec2CellType;
+class AgeModel;
 
 namespace energy {
 
@@ -55,6 +56,10 @@ public:
 
   // inputs used by regional models
   const IceModelVec2Int *no_model_mask;
+
+  // optional: if set, the age model is updated in the same column sweep (see
+  // age.fused_sweep)
+  AgeModel *age_model;
 };
 
 class EnergyModelStats {
@@ -26,6 +26,7 @@
 #include "pism/util/io/PIO.hh"
 #include "utilities.hh"
 #include "pism/util/pism_utilities.hh"
+#include "pism/age/AgeModel.hh"
 
 namespace pism {
 namespace energy {
@@ -102,6 +103,9 @@ No communication of ghosts is done for any of these fields.
 
 We use an instance of enthSystemCtx.
 
+If `inputs.age_model` is set, the age of the ice is updated in the same sweep over columns,
+re-using velocity components interpolated onto the fine vertical grid by enthSystemCtx.
+
 Regarding drainage, see [\ref AschwandenBuelerKhroulevBlatter] and references therein.
  */
 
@@ -151,15 +155,44 @@ void EnthalpyModel::update_impl(double t, double dt, const Inputs &inputs) {
 
   unsigned int liquifiedCount = 0;
 
+  AgeModel *age = inputs.age_model;
+  // cancels the age sweep if anything below fails
+  AgeColumnSweepGuard age_sweep_guard(age);
+  if (age != NULL) {
+    age->begin_column_sweep(dt, AgeModelInputs(&ice_thickness, &u3, &v3, &w3));
+  }
+
+  m_columns.update(ice_thickness, dz);
+
+  // deal completely with columns with no ice; enthalpy and basal_melt_rate need setting
+  for (const auto &c : m_columns.ice_free()) {
+    const int i = c.i, j = c.j;
+
+    // enthalpy at the top of the ice (here ks == 0, so the depth is H)
+    const double Enth_ks = EC->enthalpy_permissive(ice_surface_temp(i, j),
+                                                   surface_liquid_fraction(i, j),
+                                                   EC->pressure(ice_thickness(i, j)));
+
+    m_work.set_column(i, j, Enth_ks);
+    // The floating basal melt rate will be set later; cover this
+    // case and set to zero for now. Also, there is no basal melt
+    // rate on ice free land and ice free ocean
+    m_basal_melt_rate(i, j) = 0.0;
+  }
+
   ParallelSection loop(m_grid->com);
   try {
-    for (Points pt(*m_grid); pt; pt.next()) {
-      const int i = pt.i(), j = pt.j();
+    for (const auto &c : m_columns.icy()) {
+      const int i = c.i, j = c.j;
 
       const double H = ice_thickness(i, j);
 
       system.init(i, j, H);
 
+      if (age != NULL) {
+        age->update_column(i, j, H, &system);
+      }
+
       // enthalpy and pressures at top of ice
       const double
         depth_ks = H - system.ks() * dz,
@@ -168,18 +201,6 @@ void EnthalpyModel::update_impl(double t, double dt, const Inputs &inputs) {
       const double Enth_ks = EC->enthalpy_permissive(ice_surface_temp(i, j),
                                                      surface_liquid_fraction(i, j), p_ks);
 
-      const bool ice_free_column = (system.ks() == 0);
-
-      // deal completely with columns with no ice; enthalpy and basal_melt_rate need setting
-      if (ice_free_column) {
-        m_work.set_column(i, j, Enth_ks);
-        // The floating basal melt rate will be set later; cover this
-        // case and set to zero for now. Also, there is no basal melt
-        // rate on ice free land and ice free ocean
-        m_basal_melt_rate(i, j) = 0.0;
-        continue;
-      } // end of if (ice_free_column)
-
       if (system.lambda() < 1.0) {
         m_stats.reduced_accuracy_counter += 1; // count columns with lambda < 1
       }
@@ -373,6 +394,10 @@ void EnthalpyModel::update_impl(double t, double dt, const Inputs &inputs) {
   }
   loop.check();
 
+  if (age != NULL) {
+    age->end_column_sweep();
+  }
+
   // FIXME: use cell areas
   m_stats.liquified_ice_volume = ((double) liquifiedCount) * dz * m_grid->dx() * m_grid->dy();
 }
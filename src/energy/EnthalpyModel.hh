@@ -21,6 +21,7 @@
 #define ENTHALPYMODEL_H
 
 #include "EnergyModel.hh"
+#include "pism/util/ColumnSystem.hh"
 
 namespace pism {
 namespace energy {
@@ -50,6 +51,9 @@ protected:
 
   virtual void define_model_state_impl(const PIO &output) const;
   virtual void write_model_state_impl(const PIO &output) const;
+
+  //! lists of icy and ice-free columns
+  ColumnIndex m_columns;
 };
 
 /*! @brief The "dummy" energy balance model. Reads in enthalpy from a file, but does not update it. */
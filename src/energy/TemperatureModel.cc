@@ -24,6 +24,7 @@
 #include "pism/util/IceModelVec2CellType.hh"
 #include "pism/util/Vars.hh"
 #include "pism/util/io/PIO.hh"
+#include "pism/age/AgeModel.hh"
 
 namespace pism {
 namespace energy {
@@ -184,6 +185,13 @@ void TemperatureModel::update_impl(double t, double dt, const Inputs &inputs) {
   const double bulge_max  = m_config->get_double("energy.enthalpy_cold_bulge_max") / ice_c;
 
   inputs.check();
+
+  if (inputs.age_model != NULL) {
+    // this model does not support updating age in the same column sweep
+    inputs.age_model->update(t, dt, AgeModelInputs(inputs.ice_thickness,
+                                                   inputs.u3, inputs.v3, inputs.w3));
+  }
+
   const IceModelVec3
     &strain_heating3 = *inputs.strain_heating3,
     &u3              = *inputs.u3,
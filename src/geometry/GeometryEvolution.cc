@@ -19,6 +19,9 @@
 
 #include "GeometryEvolution.hh"
 
+#include <cmath>                // fabs
+#include <algorithm>            // std::max, std::min
+
 #include "pism/util/iceModelVec.hh"
 #include "pism/util/IceGrid.hh"
 #include "pism/util/Mask.hh"
@@ -27,6 +30,9 @@
 #include "pism/util/pism_utilities.hh"
 #include "pism/util/Logger.hh"
 #include "pism/util/Profiling.hh"
+#include "pism/util/error_handling.hh"
+#include "pism/util/petscwrappers/KSP.hh"
+#include "pism/util/petscwrappers/Mat.hh"
 
 namespace pism {
 
@@ -37,9 +43,45 @@ using mask::ice_free_land;
 using mask::ice_free_ocean;
 using mask::icy;
 
+//! Provides a ghosted version of a read-only input field, copying it only if necessary.
+class GhostedInput {
+public:
+  GhostedInput()
+    : m_source(NULL), m_state(-1) {
+    // empty
+  }
+
+  /*!
+   * Returns `input` if it has ghosts (its ghosts have to be up to date). Otherwise copies it
+   * to `storage`, unless `storage` already contains the current state of `input` (see
+   * IceModelVec::get_state_counter()), and returns `storage`.
+   */
+  template<class T>
+  const T& get(const T &input, T &storage) {
+    if (input.get_stencil_width() > 0) {
+      return input;
+    }
+
+    if (m_source != &input or m_state != input.get_state_counter()) {
+      storage.copy_from(input);
+      m_source = &input;
+      m_state  = input.get_state_counter();
+    }
+
+    return storage;
+  }
+private:
+  const IceModelVec *m_source;
+  int m_state;
+};
+
 struct GeometryEvolution::Impl {
   Impl(IceGrid::ConstPtr g);
 
+  void update_cell_type(const IceModelVec2S &sea_level,
+                        const IceModelVec2S &bed_elevation,
+                        const IceModelVec2S &ice_thickness);
+
   const Profiling &profile;
 
   GeometryCalculator gc;
@@ -52,6 +94,15 @@ struct GeometryEvolution::Impl {
   //! True if the part-grid scheme is enabled.
   bool use_part_grid;
 
+  //! True if the SIA (diffusive) part of the flux is computed using a semi-implicit scheme.
+  bool implicit_sia;
+
+  //! True if mass transport uses local (multi-rate) time stepping.
+  bool local_time_stepping;
+
+  //! Maximum time step level used by local time stepping.
+  int max_level;
+
   //! Flux divergence (used to track thickness changes due to flow).
   IceModelVec2S flux_divergence;
 
@@ -74,22 +125,49 @@ struct GeometryEvolution::Impl {
   IceModelVec2Stag flux_staggered;
 
   // Work space
-  IceModelVec2V        input_velocity;       // ghosted copy; not modified
-  IceModelVec2S        bed_elevation;        // ghosted copy; not modified
-  IceModelVec2S        sea_level;            // ghosted copy; not modified
+  IceModelVec2V        input_velocity;       // ghosted copy (if needed); not modified
+  IceModelVec2S        bed_elevation;        // ghosted copy (if needed); not modified
+  IceModelVec2S        sea_level;            // ghosted copy (if needed); not modified
   IceModelVec2S        ice_thickness;        // ghosted; updated in place
   IceModelVec2S        area_specific_volume; // ghosted; updated in place
   IceModelVec2S        surface_elevation;    // ghosted; updated to maintain consistency
   IceModelVec2CellType cell_type;            // ghosted; updated to maintain consistency
   IceModelVec2S        residual;             // ghosted; temporary storage
   IceModelVec2S        thickness;            // ghosted; temporary storage
-  IceModelVec2Int      velocity_bc_mask;
+  IceModelVec2Int      velocity_bc_mask;     // ghosted copy (if needed); not modified
+
+  // Read-only inputs: used directly if ghosted, copied to the fields above otherwise
+  GhostedInput         input_velocity_input;
+  GhostedInput         bed_elevation_input;
+  GhostedInput         sea_level_input;
+  GhostedInput         velocity_bc_mask_input;
+
+  //! Inputs used to compute `cell_type` and `surface_elevation` and their states
+  const IceModelVec *cell_type_inputs[3];
+  int cell_type_input_states[3];
+
+  // Storage used by the semi-implicit SIA and local time stepping schemes
+  IceModelVec2Stag     diffusivity;          // ghosted; SIA diffusivity limited using cell_type
+  IceModelVec2Stag     interface_velocity;   // limited advective velocity at cell interfaces
+  IceModelVec2Stag     transport;            // ghosted; flux integrated over the time step
+  IceModelVec2Int      level;                // ghosted; time step level of each cell
+  IceModelVec2Stag     diffusive_flux;       // SIA flux computed by the semi-implicit scheme
+  IceModelVec2S        implicit_rhs;         // right hand side of the linear system
+  IceModelVec2S        implicit_thickness;   // solution of the linear system
+  petsc::DM::Ptr       da;                   // DM used to assemble the system matrix
+  petsc::Mat           A;                    // system matrix
+  petsc::KSP           ksp;                  // linear solver
 };
 
 GeometryEvolution::Impl::Impl(IceGrid::ConstPtr grid)
   : profile(grid->ctx()->profiling()),
     gc(*grid->ctx()->config()) {
 
+  for (int k = 0; k < 3; ++k) {
+    cell_type_inputs[k]       = NULL;
+    cell_type_input_states[k] = -1;
+  }
+
   Config::ConstPtr config = grid->ctx()->config();
 
   gc.set_icefree_thickness(config->get_double("geometry.ice_free_thickness_standard"));
@@ -99,6 +177,22 @@ GeometryEvolution::Impl::Impl(IceGrid::ConstPtr grid)
     ice_density   = config->get_double("constants.ice.density");
     use_bmr       = config->get_boolean("geometry.update.use_basal_melt_rate");
     use_part_grid = config->get_boolean("geometry.part_grid.enabled");
+    implicit_sia  = config->get_boolean("geometry.update.implicit_sia");
+
+    local_time_stepping = config->get_boolean("geometry.update.local_time_stepping");
+    max_level           = config->get_double("geometry.update.local_time_stepping_max_level");
+  }
+
+  if (implicit_sia and local_time_stepping) {
+    throw RuntimeError(PISM_ERROR_LOCATION,
+                       "geometry.update.implicit_sia and geometry.update.local_time_stepping"
+                       " cannot be used together");
+  }
+
+  if (max_level < 0) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "geometry.update.local_time_stepping_max_level = %d is invalid",
+                                  max_level);
   }
 
   // reported quantities
@@ -179,6 +273,96 @@ GeometryEvolution::Impl::Impl(IceGrid::ConstPtr grid)
                                " (1 at velocity B.C. location, 0 elsewhere)",
                                "", "");
   }
+
+  if (implicit_sia or local_time_stepping) {
+    diffusivity.create(grid, "limited_diffusivity", WITH_GHOSTS);
+    diffusivity.set_attrs("internal", "SIA diffusivity at cell interfaces",
+                          "m2 s-1", "");
+  }
+
+  if (local_time_stepping) {
+    interface_velocity.create(grid, "interface_velocity", WITHOUT_GHOSTS);
+    interface_velocity.set_attrs("internal", "advective velocity at cell interfaces",
+                                 "m s-1", "");
+
+    transport.create(grid, "transport", WITH_GHOSTS);
+    transport.set_attrs("internal", "ice flux through cell interfaces"
+                        " integrated over the time step", "m2", "");
+
+    level.create(grid, "time_step_level", WITH_GHOSTS);
+    level.set_attrs("internal", "mass transport time step level"
+                    " (the cell is updated using steps of length dt / 2^level)", "", "");
+  }
+
+  if (implicit_sia) {
+    diffusive_flux.create(grid, "implicit_diffusive_flux", WITHOUT_GHOSTS);
+    diffusive_flux.set_attrs("internal", "diffusive (SIA) flux computed semi-implicitly",
+                             "m2 s-1", "");
+
+    implicit_rhs.create(grid, "implicit_rhs", WITHOUT_GHOSTS);
+    implicit_rhs.set_attrs("internal", "right hand side of the semi-implicit SIA system",
+                           "meters", "");
+
+    implicit_thickness.create(grid, "implicit_thickness", WITHOUT_GHOSTS);
+    implicit_thickness.set_attrs("internal", "solution of the semi-implicit SIA system",
+                                 "meters", "");
+
+    PetscErrorCode ierr;
+
+    // one degree of freedom and a 5-point stencil
+    da = grid->get_dm(1, 1);
+
+    ierr = DMSetMatType(*da, MATAIJ);
+    PISM_CHK(ierr, "DMSetMatType");
+
+    ierr = DMCreateMatrix(*da, A.rawptr());
+    PISM_CHK(ierr, "DMCreateMatrix");
+
+    ierr = KSPCreate(grid->com, ksp.rawptr());
+    PISM_CHK(ierr, "KSPCreate");
+
+    ierr = KSPSetOptionsPrefix(ksp, "sia_implicit_");
+    PISM_CHK(ierr, "KSPSetOptionsPrefix");
+
+    // Use the old ice thickness as the initial guess.
+    ierr = KSPSetInitialGuessNonzero(ksp, PETSC_TRUE);
+    PISM_CHK(ierr, "KSPSetInitialGuessNonzero");
+
+    ierr = KSPSetFromOptions(ksp);
+    PISM_CHK(ierr, "KSPSetFromOptions");
+  }
+}
+
+/*!
+ * Compute `cell_type` and `surface_elevation` (updating ghosts) unless they were computed
+ * using the current states of the same inputs.
+ *
+ * Code modifying `cell_type` or `surface_elevation` directly has to reset
+ * `cell_type_inputs`.
+ */
+void GeometryEvolution::Impl::update_cell_type(const IceModelVec2S &sea_level,
+                                               const IceModelVec2S &bed_elevation,
+                                               const IceModelVec2S &ice_thickness) {
+  const IceModelVec *inputs[3] = {&sea_level, &bed_elevation, &ice_thickness};
+
+  bool up_to_date = true;
+  for (int k = 0; k < 3; ++k) {
+    if (cell_type_inputs[k] != inputs[k] or
+        cell_type_input_states[k] != inputs[k]->get_state_counter()) {
+      up_to_date = false;
+    }
+  }
+
+  if (up_to_date) {
+    return;
+  }
+
+  gc.compute(sea_level, bed_elevation, ice_thickness, cell_type, surface_elevation);
+
+  for (int k = 0; k < 3; ++k) {
+    cell_type_inputs[k]       = inputs[k];
+    cell_type_input_states[k] = inputs[k]->get_state_counter();
+  }
 }
 
 GeometryEvolution::GeometryEvolution(IceGrid::ConstPtr grid)
@@ -237,6 +421,14 @@ const IceModelVec2S& GeometryEvolution::conservation_error() const {
  * @param[in] thickness_bc_mask ice thickness Dirichlet B.C. mask
  * @param[in] surface_mass_balance_rate top surface mass balance rate (m / second)
  * @param[in] basal_melt_rate basal (bottom surface) melt rate (m / second)
+ * @param[in] sia_diffusivity SIA diffusivity on the staggered grid (optional)
+ *
+ * If `geometry.update.implicit_sia` is set and `sia_diffusivity` is provided, `diffusive_flux` is
+ * ignored: the diffusive flux is re-computed using a semi-implicit scheme (see
+ * compute_implicit_diffusive_flux()).
+ *
+ * If `geometry.update.local_time_stepping` is set, `diffusive_flux` is ignored and fluxes are
+ * computed using `sia_diffusivity` and local time steps (see compute_multirate_fluxes()).
  *
  * Results are stored in internal fields accessible using getters.
  */
@@ -246,36 +438,75 @@ void GeometryEvolution::step(const Geometry &geometry, double dt,
                              const IceModelVec2Int  &velocity_bc_mask,
                              const IceModelVec2Int  &thickness_bc_mask,
                              const IceModelVec2S    &surface_mass_balance_rate,
-                             const IceModelVec2S    &basal_melt_rate) {
+                             const IceModelVec2S    &basal_melt_rate,
+                             const IceModelVec2Stag *sia_diffusivity) {
 
   m_impl->profile.begin("ge.update_ghosted_copies");
-  {
-    // make ghosted copies of input fields
-    m_impl->ice_thickness.copy_from(geometry.ice_thickness);
-    m_impl->area_specific_volume.copy_from(geometry.ice_area_specific_volume);
-    m_impl->sea_level.copy_from(geometry.sea_level_elevation);
-    m_impl->bed_elevation.copy_from(geometry.bed_elevation);
-    m_impl->input_velocity.copy_from(advective_velocity);
-    m_impl->velocity_bc_mask.copy_from(velocity_bc_mask);
-
-    // Compute cell_type and surface_elevation. Ghosts of results are updated.
-    m_impl->gc.compute(m_impl->sea_level,          // in (uses ghosts)
-                       m_impl->bed_elevation,      // in (uses ghosts)
-                       m_impl->ice_thickness,      // in (uses ghosts)
-                       m_impl->cell_type,          // out (ghosts are updated)
-                       m_impl->surface_elevation); // out (ghosts are updated)
-  }
+
+  // Ice thickness and area specific volume are updated in place, so we need copies.
+  m_impl->ice_thickness.copy_from(geometry.ice_thickness);
+  m_impl->area_specific_volume.copy_from(geometry.ice_area_specific_volume);
+
+  // Ghosted versions of read-only inputs. Inputs that have ghosts are used directly;
+  // others are copied only if they changed since the last step.
+  const IceModelVec2S &sea_level =
+    m_impl->sea_level_input.get(geometry.sea_level_elevation, m_impl->sea_level);
+  const IceModelVec2S &bed_elevation =
+    m_impl->bed_elevation_input.get(geometry.bed_elevation, m_impl->bed_elevation);
+  const IceModelVec2V &input_velocity =
+    m_impl->input_velocity_input.get(advective_velocity, m_impl->input_velocity);
+  const IceModelVec2Int &bc_mask =
+    m_impl->velocity_bc_mask_input.get(velocity_bc_mask, m_impl->velocity_bc_mask);
+
+  // Compute cell_type and surface_elevation. Ghosts of results are updated.
+  m_impl->update_cell_type(sea_level,              // in (uses ghosts)
+                           bed_elevation,          // in (uses ghosts)
+                           m_impl->ice_thickness); // in (uses ghosts)
+
   m_impl->profile.end("ge.update_ghosted_copies");
 
-  // Derived classes can include modifications for regional runs.
-  m_impl->profile.begin("ge.interface_fluxes");
-  compute_interface_fluxes(m_impl->cell_type,          // in (uses ghosts)
-                           m_impl->ice_thickness,      // in (uses ghosts)
-                           m_impl->input_velocity,     // in (uses ghosts)
-                           m_impl->velocity_bc_mask,   // in (uses ghosts)
-                           diffusive_flux,             // in
-                           m_impl->flux_staggered);    // out
-  m_impl->profile.end("ge.interface_fluxes");
+  const IceModelVec2Stag *Q_diffusive = &diffusive_flux;
+  if (m_impl->implicit_sia and sia_diffusivity != NULL) {
+    m_impl->profile.begin("ge.implicit_sia");
+    compute_implicit_diffusive_flux(dt,
+                                    m_impl->cell_type,          // in (uses ghosts)
+                                    m_impl->ice_thickness,      // in (uses ghosts)
+                                    bed_elevation,              // in (uses ghosts)
+                                    sea_level,                  // in (uses ghosts)
+                                    input_velocity,             // in (uses ghosts)
+                                    bc_mask,                    // in (uses ghosts)
+                                    thickness_bc_mask,          // in
+                                    *sia_diffusivity,           // in
+                                    m_impl->diffusive_flux);    // out
+    m_impl->profile.end("ge.implicit_sia");
+
+    Q_diffusive = &m_impl->diffusive_flux;
+  }
+
+  if (m_impl->local_time_stepping) {
+    m_impl->profile.begin("ge.multirate_fluxes");
+    compute_multirate_fluxes(dt,
+                             m_impl->cell_type,          // in (uses ghosts)
+                             m_impl->ice_thickness,      // in (uses ghosts)
+                             bed_elevation,              // in (uses ghosts)
+                             sea_level,                  // in (uses ghosts)
+                             input_velocity,             // in (uses ghosts)
+                             bc_mask,                    // in (uses ghosts)
+                             thickness_bc_mask,          // in
+                             sia_diffusivity,            // in (may be NULL)
+                             m_impl->flux_staggered);    // out
+    m_impl->profile.end("ge.multirate_fluxes");
+  } else {
+    // Derived classes can include modifications for regional runs.
+    m_impl->profile.begin("ge.interface_fluxes");
+    compute_interface_fluxes(m_impl->cell_type,          // in (uses ghosts)
+                             m_impl->ice_thickness,      // in (uses ghosts)
+                             input_velocity,             // in (uses ghosts)
+                             bc_mask,                    // in (uses ghosts)
+                             *Q_diffusive,               // in
+                             m_impl->flux_staggered);    // out
+    m_impl->profile.end("ge.interface_fluxes");
+  }
 
   m_impl->flux_staggered.update_ghosts();
 
@@ -288,8 +519,8 @@ void GeometryEvolution::step(const Geometry &geometry, double dt,
   // This is where part_grid is implemented.
   m_impl->profile.begin("ge.update_in_place");
   update_in_place(dt,                            // in
-                  m_impl->bed_elevation,         // in
-                  m_impl->sea_level,             // in
+                  bed_elevation,                 // in
+                  sea_level,                     // in
                   m_impl->flux_divergence,       // in
                   m_impl->ice_thickness,         // in/out
                   m_impl->area_specific_volume); // in/out
@@ -665,6 +896,462 @@ void GeometryEvolution::compute_flux_divergence(const IceModelVec2Stag &flux,
   loop.check();
 }
 
+//! Ice surface elevation as a linear function of ice thickness: `h = a * H + c`.
+/*!
+ * Uses the cell type to decide if the ice is grounded (`a = 1`, `c = b`) or floating (`a = 1 -
+ * rho_i / rho_w`, `c = z_sl`).
+ */
+class SurfaceElevation {
+public:
+  SurfaceElevation(const IceModelVec2CellType &cell_type,
+                   const IceModelVec2S &bed_elevation,
+                   const IceModelVec2S &sea_level,
+                   double alpha)
+    : m_cell_type(cell_type), m_bed_elevation(bed_elevation), m_sea_level(sea_level),
+      m_alpha(alpha) {
+    // empty
+  }
+
+  double a(int i, int j) const {
+    return m_cell_type.ocean(i, j) ? m_alpha : 1.0;
+  }
+
+  double c(int i, int j) const {
+    return m_cell_type.ocean(i, j) ? m_sea_level(i, j) : m_bed_elevation(i, j);
+  }
+
+  double operator()(const IceModelVec2S &H, int i, int j) const {
+    return a(i, j) * H(i, j) + c(i, j);
+  }
+private:
+  const IceModelVec2CellType &m_cell_type;
+  const IceModelVec2S &m_bed_elevation, &m_sea_level;
+  double m_alpha;
+};
+
+/*!
+ * Compute the diffusive (SIA) flux using a semi-implicit scheme.
+ *
+ * Given the SIA diffusivity @f$ D @f$ computed using the old geometry, solve the linear
+ * problem
+ *
+ * @f[ H^{*} - \Delta t\, \nabla \cdot \left( D \nabla h(H^{*}) \right) = H - \Delta t\, \nabla \cdot \mathbf{Q}_{\text{advective}} @f]
+ *
+ * for @f$ H^{*} @f$. Here @f$ h(H) = a H + c @f$ is the ice surface elevation: @f$ a = 1 @f$,
+ * @f$ c = b @f$ (bed elevation) on land and @f$ a = 1 - \rho_i / \rho_w @f$, @f$ c = z_{sl} @f$
+ * (sea level) in the ocean, using the old cell type. The advective flux is treated explicitly.
+ *
+ * The result is the flux @f$ \mathbf{Q} = -D \nabla h(H^{*}) @f$ through cell interfaces. The
+ * rest of the step uses it instead of the explicit diffusive flux, so the scheme remains
+ * conservative and the part-grid and non-negativity code applies as usual. (Without these the
+ * new thickness would be equal to @f$ H^{*} @f$.)
+ *
+ * The diffusivity is lagged, so this scheme is stable for time steps exceeding the
+ * explicit limit (see IceModel::max_timestep_diffusivity()).
+ *
+ * This method uses compute_interface_fluxes() to limit the diffusivity and to compute the
+ * advective flux, so modifications of the flux in derived classes apply here as well.
+ *
+ * @param[in] dt time step, seconds
+ * @param[in] cell_type cell type mask (uses ghosts)
+ * @param[in] ice_thickness ice thickness (uses ghosts)
+ * @param[in] bed_elevation bed elevation (uses ghosts)
+ * @param[in] sea_level sea level elevation (uses ghosts)
+ * @param[in] velocity advective velocity (uses ghosts)
+ * @param[in] velocity_bc_mask advective velocity Dirichlet B.C. mask (uses ghosts)
+ * @param[in] thickness_bc_mask ice thickness Dirichlet B.C. mask
+ * @param[in] diffusivity SIA diffusivity on the staggered grid
+ * @param[out] output diffusive flux on the staggered grid
+ */
+void GeometryEvolution::compute_implicit_diffusive_flux(double dt,
+                                                        const IceModelVec2CellType &cell_type,
+                                                        const IceModelVec2S        &ice_thickness,
+                                                        const IceModelVec2S        &bed_elevation,
+                                                        const IceModelVec2S        &sea_level,
+                                                        const IceModelVec2V        &velocity,
+                                                        const IceModelVec2Int      &velocity_bc_mask,
+                                                        const IceModelVec2Int      &thickness_bc_mask,
+                                                        const IceModelVec2Stag     &diffusivity,
+                                                        IceModelVec2Stag           &output) {
+  PetscErrorCode ierr;
+
+  const double
+    dx    = m_grid->dx(),
+    dy    = m_grid->dy(),
+    alpha = 1.0 - m_impl->ice_density / m_config->get_double("constants.sea_water.density");
+
+  IceModelVec2Stag &D = m_impl->diffusivity;
+
+  limit_diffusivity(cell_type, velocity, velocity_bc_mask, diffusivity, D);
+
+  // Compute the divergence of the advective flux.
+  {
+    output.set(0.0);
+
+    compute_interface_fluxes(cell_type, ice_thickness, velocity, velocity_bc_mask,
+                             output, m_impl->flux_staggered);
+    m_impl->flux_staggered.update_ghosts();
+
+    compute_flux_divergence(m_impl->flux_staggered, thickness_bc_mask,
+                            m_impl->flux_divergence);
+  }
+
+  const IceModelVec2S &divQ_advective = m_impl->flux_divergence;
+
+  IceModelVec2S
+    &rhs = m_impl->implicit_rhs,
+    &x   = m_impl->implicit_thickness;
+
+  SurfaceElevation h(cell_type, bed_elevation, sea_level, alpha);
+
+  // Assemble the system.
+  {
+    ierr = MatZeroEntries(m_impl->A);
+    PISM_CHK(ierr, "MatZeroEntries");
+
+    IceModelVec::AccessList list{&cell_type, &ice_thickness, &bed_elevation, &sea_level,
+        &thickness_bc_mask, &D, &divQ_advective, &rhs, &x};
+
+    ParallelSection loop(m_grid->com);
+    try {
+      for (Points p(*m_grid); p; p.next()) {
+        const int i = p.i(), j = p.j();
+
+        // old thickness is the initial guess
+        x(i, j) = ice_thickness(i, j);
+
+        MatStencil row, col[5];
+        double values[5] = {1.0, 0.0, 0.0, 0.0, 0.0};
+        row.i = i;
+        row.j = j;
+        row.c = 0;
+        for (int n = 0; n < 5; ++n) {
+          col[n] = row;
+        }
+
+        if (thickness_bc_mask.as_int(i, j) == 1) {
+          // Dirichlet B.C.: ice thickness does not change
+          rhs(i, j) = ice_thickness(i, j);
+
+          ierr = MatSetValuesStencil(m_impl->A, 1, &row, 1, col, values, INSERT_VALUES);
+          PISM_CHK(ierr, "MatSetValuesStencil");
+          continue;
+        }
+
+        // coefficients of the discrete diffusion operator at cell interfaces
+        const double
+          C_e = dt * D(i,     j,     0) / (dx * dx),
+          C_w = dt * D(i - 1, j,     0) / (dx * dx),
+          C_n = dt * D(i,     j,     1) / (dy * dy),
+          C_s = dt * D(i,     j - 1, 1) / (dy * dy);
+
+        const double
+          a_ij = h.a(i, j),
+          c_ij = h.c(i, j);
+
+        col[1].i = i + 1;
+        col[2].i = i - 1;
+        col[3].j = j + 1;
+        col[4].j = j - 1;
+
+        values[0] = 1.0 + (C_e + C_w + C_n + C_s) * a_ij;
+        values[1] = - C_e * h.a(i + 1, j);
+        values[2] = - C_w * h.a(i - 1, j);
+        values[3] = - C_n * h.a(i, j + 1);
+        values[4] = - C_s * h.a(i, j - 1);
+
+        rhs(i, j) = (ice_thickness(i, j) - dt * divQ_advective(i, j) +
+                     C_e * (h.c(i + 1, j) - c_ij) - C_w * (c_ij - h.c(i - 1, j)) +
+                     C_n * (h.c(i, j + 1) - c_ij) - C_s * (c_ij - h.c(i, j - 1)));
+
+        ierr = MatSetValuesStencil(m_impl->A, 1, &row, 5, col, values, INSERT_VALUES);
+        PISM_CHK(ierr, "MatSetValuesStencil");
+      }
+    } catch (...) {
+      loop.failed();
+    }
+    loop.check();
+
+    ierr = MatAssemblyBegin(m_impl->A, MAT_FINAL_ASSEMBLY);
+    PISM_CHK(ierr, "MatAssemblyBegin");
+
+    ierr = MatAssemblyEnd(m_impl->A, MAT_FINAL_ASSEMBLY);
+    PISM_CHK(ierr, "MatAssemblyEnd");
+  }
+
+  // Solve it.
+  {
+    ierr = KSPSetOperators(m_impl->ksp, m_impl->A, m_impl->A);
+    PISM_CHK(ierr, "KSPSetOperators");
+
+    ierr = KSPSolve(m_impl->ksp, rhs.get_vec(), x.get_vec());
+    PISM_CHK(ierr, "KSPSolve");
+
+    KSPConvergedReason reason;
+    ierr = KSPGetConvergedReason(m_impl->ksp, &reason);
+    PISM_CHK(ierr, "KSPGetConvergedReason");
+
+    if (reason < 0) {
+      throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                    "semi-implicit SIA solver (KSP) failed: %s",
+                                    KSPConvergedReasons[reason]);
+    }
+
+    PetscInt iterations = 0;
+    ierr = KSPGetIterationNumber(m_impl->ksp, &iterations);
+    PISM_CHK(ierr, "KSPGetIterationNumber");
+
+    m_log->message(4, "semi-implicit SIA: %d KSP iterations\n", (int)iterations);
+  }
+
+  // Compute the diffusive flux using the solution.
+  {
+    // ghosted copy of the solution
+    IceModelVec2S &H = m_impl->thickness;
+    H.copy_from_vec(x.get_vec());
+
+    IceModelVec::AccessList list{&cell_type, &H, &bed_elevation, &sea_level, &D, &output};
+
+    ParallelSection loop(m_grid->com);
+    try {
+      for (Points p(*m_grid); p; p.next()) {
+        const int i = p.i(), j = p.j();
+
+        const double h_ij = h(H, i, j);
+
+        for (int n = 0; n < 2; ++n) {
+          const int
+            i_n = i + 1 - n,    // i index of a neighbor
+            j_n = j + n;        // j index of a neighbor
+
+          output(i, j, n) = - D(i, j, n) * (h(H, i_n, j_n) - h_ij) / (n == 0 ? dx : dy);
+        }
+      }
+    } catch (...) {
+      loop.failed();
+    }
+    loop.check();
+  }
+}
+
+/*!
+ * Limit the SIA diffusivity at cell interfaces using the same rules as the diffusive flux.
+ *
+ * The advective flux is zero if the ice thickness is zero, so compute_interface_fluxes()
+ * returns the limited diffusivity. This way modifications in derived classes apply as well.
+ *
+ * Ghosts of the `output` are updated.
+ */
+void GeometryEvolution::limit_diffusivity(const IceModelVec2CellType &cell_type,
+                                          const IceModelVec2V        &velocity,
+                                          const IceModelVec2Int      &velocity_bc_mask,
+                                          const IceModelVec2Stag     &diffusivity,
+                                          IceModelVec2Stag           &output) {
+  IceModelVec2S &zero_thickness = m_impl->thickness;
+  zero_thickness.set(0.0);
+
+  compute_interface_fluxes(cell_type, zero_thickness, velocity, velocity_bc_mask,
+                           diffusivity, output);
+  output.update_ghosts();
+}
+
+/*!
+ * Compute fluxes through cell interfaces using local (multi-rate) time stepping.
+ *
+ * Each cell gets a time step level @f$ l @f$: the smallest non-negative integer such that
+ * @f$ \Delta t / 2^{l} @f$ satisfies the local diffusivity and CFL stability criteria (the
+ * same criteria IceModel uses to choose the global time step). The level of a cell
+ * interface is the finer (larger) of the levels of the two cells it separates.
+ *
+ * The step is split into @f$ 2^{L} @f$ sub-steps, where @f$ L @f$ is the maximum level. A
+ * flux through an interface of level @f$ l @f$ is re-computed every @f$ 2^{L - l} @f$ sub-steps
+ * using the current ice thickness, the advective velocity and the (lagged) SIA diffusivity,
+ * and accumulated in the `transport` field. A cell of level @f$ l @f$ is updated at the end of
+ * each of its steps using the accumulated transport through its four interfaces. Each
+ * interface contributes the same amount to both of its neighbors, so this is conservative.
+ *
+ * The output is the transport divided by @f$ \Delta t @f$, i.e. the time-averaged flux. The
+ * rest of the mass continuity step uses it, so the part-grid and non-negativity code
+ * applies as usual.
+ *
+ * The stress balance (and so the velocity and the diffusivity) is computed only once per
+ * step. Cells far from steep margins and fast flow use one step of length @f$ \Delta t @f$.
+ *
+ * Note that this relaxes the global CFL and diffusivity time step restrictions: when local
+ * time stepping is on, IceModel allows @f$ \Delta t @f$ up to @f$ 2^{L} @f$ times longer than
+ * these limits, so a sub-step of the finest level satisfies the local limit of every cell.
+ * Levels are capped at @f$ L @f$ (`geometry.update.local_time_stepping_max_level`).
+ *
+ * @param[in] dt time step, seconds
+ * @param[in] cell_type cell type mask (uses ghosts)
+ * @param[in] ice_thickness ice thickness (uses ghosts)
+ * @param[in] bed_elevation bed elevation (uses ghosts)
+ * @param[in] sea_level sea level elevation (uses ghosts)
+ * @param[in] velocity advective velocity (uses ghosts)
+ * @param[in] velocity_bc_mask advective velocity Dirichlet B.C. mask (uses ghosts)
+ * @param[in] thickness_bc_mask ice thickness Dirichlet B.C. mask
+ * @param[in] diffusivity SIA diffusivity on the staggered grid (NULL if there is no diffusive flux)
+ * @param[out] output time-averaged flux through cell interfaces
+ */
+void GeometryEvolution::compute_multirate_fluxes(double dt,
+                                                 const IceModelVec2CellType &cell_type,
+                                                 const IceModelVec2S        &ice_thickness,
+                                                 const IceModelVec2S        &bed_elevation,
+                                                 const IceModelVec2S        &sea_level,
+                                                 const IceModelVec2V        &velocity,
+                                                 const IceModelVec2Int      &velocity_bc_mask,
+                                                 const IceModelVec2Int      &thickness_bc_mask,
+                                                 const IceModelVec2Stag     *diffusivity,
+                                                 IceModelVec2Stag           &output) {
+  const double
+    dx          = m_grid->dx(),
+    dy          = m_grid->dy(),
+    alpha       = 1.0 - m_impl->ice_density / m_config->get_double("constants.sea_water.density"),
+    ratio       = m_config->get_double("time_stepping.adaptive_ratio"),
+    grid_factor = 1.0 / (dx * dx) + 1.0 / (dy * dy);
+
+  IceModelVec2Stag
+    &D         = m_impl->diffusivity,
+    &V         = m_impl->interface_velocity,
+    &transport = m_impl->transport;
+  IceModelVec2Int &level = m_impl->level;
+
+  // Limited diffusivity.
+  if (diffusivity != NULL) {
+    limit_diffusivity(cell_type, velocity, velocity_bc_mask, *diffusivity, D);
+  } else {
+    D.set(0.0);
+  }
+
+  // Limited advective velocity at interfaces. The diffusive flux is zero and the
+  // thickness is one, so compute_interface_fluxes() returns the velocity.
+  {
+    IceModelVec2S &one = m_impl->thickness;
+    one.set(1.0);
+
+    transport.set(0.0);
+    compute_interface_fluxes(cell_type, one, velocity, velocity_bc_mask, transport, V);
+  }
+
+  // Time step levels.
+  int L = 0;
+  {
+    IceModelVec::AccessList list{&cell_type, &velocity, &level};
+    if (diffusivity != NULL) {
+      list.add(*diffusivity);
+    }
+
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      double dt_local = dt;
+
+      // diffusivity criterion (see IceModel::max_timestep_diffusivity())
+      if (diffusivity != NULL) {
+        const IceModelVec2Stag &d = *diffusivity;
+        const double D_max = std::max(std::max(d(i, j, 0), d(i - 1, j, 0)),
+                                      std::max(d(i, j, 1), d(i, j - 1, 1)));
+        if (D_max > 0.0) {
+          dt_local = std::min(dt_local, ratio * 2.0 / (D_max * grid_factor));
+        }
+      }
+
+      // CFL criterion (see max_timestep_cfl_2d())
+      if (cell_type.icy(i, j)) {
+        const double denom = fabs(velocity(i, j).u) / dx + fabs(velocity(i, j).v) / dy;
+        if (denom > 0.0) {
+          dt_local = std::min(dt_local, 1.0 / denom);
+        }
+      }
+
+      int l = 0;
+      while (l < m_impl->max_level and dt / (1 << l) > dt_local) {
+        ++l;
+      }
+
+      level(i, j) = l;
+      L = std::max(L, l);
+    }
+
+    L = static_cast<int>(GlobalMax(m_grid->com, L));
+  }
+  level.update_ghosts();
+
+  m_log->message(4, "local time stepping: %d sub-steps\n", 1 << L);
+
+  // Sub-cycling.
+  IceModelVec2S &H = m_impl->thickness;
+  H.copy_from(ice_thickness);
+  transport.set(0.0);
+
+  SurfaceElevation h(cell_type, bed_elevation, sea_level, alpha);
+
+  IceModelVec::AccessList list{&cell_type, &ice_thickness, &bed_elevation, &sea_level,
+      &thickness_bc_mask, &D, &V, &transport, &level, &H};
+
+  const int N = 1 << L;
+  for (int s = 0; s < N; ++s) {
+    // Update the transport through interfaces starting a step at this sub-step.
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      for (int n = 0; n < 2; ++n) {
+        const int
+          i_n = i + 1 - n,    // i index of a neighbor
+          j_n = j + n;        // j index of a neighbor
+
+        const int l = std::max(level.as_int(i, j), level.as_int(i_n, j_n));
+
+        if (s % (1 << (L - l)) != 0) {
+          continue;
+        }
+
+        const double
+          v           = V(i, j, n),
+          Q_advective = v * std::max(v > 0.0 ? H(i, j) : H(i_n, j_n), 0.0),
+          Q_diffusive = - D(i, j, n) * (h(H, i_n, j_n) - h(H, i, j)) / (n == 0 ? dx : dy);
+
+        transport(i, j, n) += (Q_advective + Q_diffusive) * dt / (1 << l);
+      }
+    }
+    transport.update_ghosts();
+
+    // Update cells finishing a step at the end of this sub-step.
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      if ((s + 1) % (1 << (L - level.as_int(i, j))) != 0) {
+        continue;
+      }
+
+      // Thickness does not change at Dirichlet B.C. locations. Flux into partially-filled
+      // cells goes into the area-specific volume.
+      if (thickness_bc_mask.as_int(i, j) == 1 or
+          (m_impl->use_part_grid and
+           cell_type.ice_free_ocean(i, j) and cell_type.next_to_ice(i, j))) {
+        continue;
+      }
+
+      StarStencil<double> T = transport.star(i, j);
+
+      H(i, j) = ice_thickness(i, j) - ((T.e - T.w) / dx + (T.n - T.s) / dy);
+    }
+    H.update_ghosts();
+  }
+
+  // time-averaged flux
+  {
+    IceModelVec::AccessList list2{&output};
+
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      output(i, j, 0) = transport(i, j, 0) / dt;
+      output(i, j, 1) = transport(i, j, 1) / dt;
+    }
+  }
+}
+
 /*!
  * Update ice thickness and area_specific_volume *in place*.
  *
@@ -689,8 +1376,9 @@ void GeometryEvolution::update_in_place(double dt,
                                         IceModelVec2S &ice_thickness,
                                         IceModelVec2S &area_specific_volume) {
 
-  m_impl->gc.compute(sea_level, bed_topography, ice_thickness,
-                     m_impl->cell_type, m_impl->surface_elevation);
+  // Usually a no-op: cell_type and surface_elevation were computed in step() using the
+  // same inputs.
+  m_impl->update_cell_type(sea_level, bed_topography, ice_thickness);
 
   IceModelVec::AccessList list{&ice_thickness, &flux_divergence};
 
@@ -761,9 +1449,12 @@ void GeometryEvolution::update_in_place(double dt,
   loop.check();
 
   ice_thickness.update_ghosts();
+  ice_thickness.inc_state_counter();
 
-  // Compute the mask corresponding to the new thickness.
+  // Compute the mask corresponding to the new thickness. Note that surface_elevation is
+  // not updated, so the next call of update_cell_type() has to re-compute both.
   m_impl->gc.compute_mask(sea_level, bed_topography, ice_thickness, m_impl->cell_type);
+  m_impl->cell_type_inputs[2] = NULL;
 
   /*
     Redistribute residual ice mass from subgrid-scale parameterization.
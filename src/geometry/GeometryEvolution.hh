@@ -26,8 +26,11 @@
 namespace pism {
 
 /*!
- * NB! Write this in a way that does not use ghosts of input fields (copy to temp. storage and
- * communicate).
+ * NB! Ghosted read-only inputs (bed elevation, sea level, velocity, velocity BC mask) are
+ * used directly and their ghosts have to be up to date. Inputs without ghosts are copied to
+ * temporary storage, but only if they changed since the last call (see
+ * IceModelVec::get_state_counter()). Ice thickness and area specific volume are always
+ * copied.
  *
  * The promise:
  *
@@ -48,7 +51,8 @@ public:
             const IceModelVec2Int  &velocity_bc_mask,
             const IceModelVec2Int  &thickness_bc_mask,
             const IceModelVec2S    &surface_mass_balance_rate,
-            const IceModelVec2S    &basal_melt_rate);
+            const IceModelVec2S    &basal_melt_rate,
+            const IceModelVec2Stag *sia_diffusivity = NULL);
 
   void update_geometry(Geometry &ice_geometry) const;
 
@@ -94,6 +98,34 @@ protected:
                                         const IceModelVec2Stag     &diffusive_flux,
                                         IceModelVec2Stag           &output);
 
+  virtual void compute_implicit_diffusive_flux(double dt,
+                                               const IceModelVec2CellType &cell_type,
+                                               const IceModelVec2S        &ice_thickness,
+                                               const IceModelVec2S        &bed_elevation,
+                                               const IceModelVec2S        &sea_level,
+                                               const IceModelVec2V        &velocity,
+                                               const IceModelVec2Int      &velocity_bc_mask,
+                                               const IceModelVec2Int      &thickness_bc_mask,
+                                               const IceModelVec2Stag     &diffusivity,
+                                               IceModelVec2Stag           &output);
+
+  virtual void compute_multirate_fluxes(double dt,
+                                        const IceModelVec2CellType &cell_type,
+                                        const IceModelVec2S        &ice_thickness,
+                                        const IceModelVec2S        &bed_elevation,
+                                        const IceModelVec2S        &sea_level,
+                                        const IceModelVec2V        &velocity,
+                                        const IceModelVec2Int      &velocity_bc_mask,
+                                        const IceModelVec2Int      &thickness_bc_mask,
+                                        const IceModelVec2Stag     *diffusivity,
+                                        IceModelVec2Stag           &output);
+
+  void limit_diffusivity(const IceModelVec2CellType &cell_type,
+                         const IceModelVec2V        &velocity,
+                         const IceModelVec2Int      &velocity_bc_mask,
+                         const IceModelVec2Stag     &diffusivity,
+                         IceModelVec2Stag           &output);
+
   virtual void compute_flux_divergence(const IceModelVec2Stag &flux_staggered,
                                        const IceModelVec2Int &thickness_bc_mask,
                                        IceModelVec2S &flux_fivergence);
@@ -34,6 +34,7 @@ Distributed::Distributed(IceGrid::ConstPtr g, stressbalance::StressBalance *sb)
   : Routing(g) {
   m_stressbalance = sb;
   m_hold_velbase_mag = false;
+  m_implicit_pressure = false;
 
   // additional variables beyond hydrology::Routing::allocate()
   m_P.create(m_grid, "bwp", WITH_GHOSTS, 1);
@@ -279,13 +280,19 @@ void Distributed::adaptive_for_WandP_evolution(double t_current, double t_end, d
   const double phi0 = m_config->get_double("hydrology.regularizing_porosity");
   dtDIFFP = 2.0 * phi0 * dtDIFFW;
 
-  // dt = min([te-t dtmax dtCFL dtDIFFW dtDIFFP]);
-  dt_result = std::min(dt_result, dtDIFFP);
-
-  if (dtDIFFP > 0.0) {
-    PtoCFLratio = std::max(1.0, dtCFL / dtDIFFP);
-  } else {
+  if (m_theta > 0.0) {
+    // implicit time stepping: dt is limited by dtmax and t_end only (see
+    // adaptive_for_W_evolution())
     PtoCFLratio = 1.0;
+  } else {
+    // dt = min([te-t dtmax dtCFL dtDIFFW dtDIFFP]);
+    dt_result = std::min(dt_result, dtDIFFP);
+
+    if (dtDIFFP > 0.0) {
+      PtoCFLratio = std::max(1.0, dtCFL / dtDIFFP);
+    } else {
+      PtoCFLratio = 1.0;
+    }
   }
 
   using units::convert;
@@ -300,6 +307,181 @@ void Distributed::adaptive_for_WandP_evolution(double t_current, double t_end, d
 }
 
 
+//! The explicit computation of Pnew, called by update().
+/*!
+Uses W, Wtil, Wtilnew, Wstag, K, Q, and total_input; the staggered grid fields
+have to be up to date.
+ */
+void Distributed::raw_update_P(double hdt) {
+  const double
+    rg    = m_config->get_double("constants.fresh_water.density") * m_config->get_double("constants.standard_gravity"),
+    nglen = m_config->get_double("stress_balance.sia.Glen_exponent"), // choice is SIA; see #285
+    Aglen = m_config->get_double("flow_law.isothermal_Glen.ice_softness"),
+    c1    = m_config->get_double("hydrology.cavitation_opening_coefficient"),
+    c2    = m_config->get_double("hydrology.creep_closure_coefficient"),
+    Wr    = m_config->get_double("hydrology.roughness_scale"),
+    phi0  = m_config->get_double("hydrology.regularizing_porosity");
+
+  const double
+    CC  = (rg * hdt) / phi0,
+    wux = 1.0 / (m_dx * m_dx),
+    wuy = 1.0 / (m_dy * m_dy);
+  double diffW;
+  overburden_pressure(m_Pover);
+
+  const IceModelVec2CellType &mask = *m_grid->variables().get_2d_cell_type("mask");
+
+  IceModelVec::AccessList list{&m_P, &m_W, &m_Wtil, &m_Wtilnew, &m_velbase_mag, &m_Wstag,
+      &m_K, &m_Q, &m_total_input, &mask, &m_Pover, &m_Pnew};
+
+  for (Points p(*m_grid); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    if (mask.ice_free_land(i,j)) {
+      m_Pnew(i,j) = 0.0;
+    } else if (mask.ocean(i,j)) {
+      m_Pnew(i,j) = m_Pover(i,j);
+    } else if (m_W(i,j) <= 0.0) {
+      m_Pnew(i,j) = m_Pover(i,j);
+    } else {
+      // opening and closure terms in pressure equation
+      double Open = std::max(0.0,c1 * m_velbase_mag(i,j) * (Wr - m_W(i,j)));
+      double Close = c2 * Aglen * pow(m_Pover(i,j) - m_P(i,j),nglen) * m_W(i,j);
+
+      // compute the flux divergence the same way as in raw_update_W()
+      const double divadflux =
+        (m_Q(i,j,0) - m_Q(i-1,j  ,0)) / m_dx +
+        (m_Q(i,j,1) - m_Q(i,  j-1,1)) / m_dy;
+      const double
+        De = rg * m_K(i,  j,0) * m_Wstag(i,  j,0),
+        Dw = rg * m_K(i-1,j,0) * m_Wstag(i-1,j,0),
+        Dn = rg * m_K(i,j  ,1) * m_Wstag(i,j  ,1),
+        Ds = rg * m_K(i,j-1,1) * m_Wstag(i,j-1,1);
+      diffW =   wux * (De * (m_W(i+1,j) - m_W(i,j)) - Dw * (m_W(i,j) - m_W(i-1,j)))
+        + wuy * (Dn * (m_W(i,j+1) - m_W(i,j)) - Ds * (m_W(i,j) - m_W(i,j-1)));
+      double divflux = - divadflux + diffW;
+
+      // pressure update equation
+      double ZZ = Close - Open + m_total_input(i,j) - (m_Wtilnew(i,j) - m_Wtil(i,j)) / hdt;
+      m_Pnew(i,j) = m_P(i,j) + CC * (divflux + ZZ);
+      // projection to enforce  0 <= P <= P_o
+      m_Pnew(i,j) = std::min(std::max(0.0, m_Pnew(i,j)), m_Pover(i,j));
+    }
+  }
+}
+
+//! The implicit computation of Pnew, called by update().
+/*!
+Solves the pressure equation
+  \f[ P^{n+1} = P^{n} + \frac{\rho_w g \Delta t}{\phi_0} \left( \frac{W^{n+1} - W^{n}}{\Delta t}
+  + \theta C(P^{n+1}) + (1 - \theta) C(P^{n}) - O \right) \f]
+for \f$ P^{n+1} \f$, where \f$C(P)\f$ is the creep closure rate and \f$O\f$ the
+cavitation opening rate (both computed using \f$W^{n}\f$). Here the rate of change of
+\f$W\f$ replaces the sum of the flux divergence, the input, and the change in till
+water storage in the explicit update (see raw_update_P()), which makes this consistent
+with the water thickness update.
+
+Expects `m_Wold` and `m_Wnew` computed by implicit_update_W() (before boundary mass
+changes).
+ */
+void Distributed::implicit_update_P(double hdt) {
+  const double
+    rg    = m_config->get_double("constants.fresh_water.density") * m_config->get_double("constants.standard_gravity"),
+    nglen = m_config->get_double("stress_balance.sia.Glen_exponent"), // choice is SIA; see #285
+    Aglen = m_config->get_double("flow_law.isothermal_Glen.ice_softness"),
+    c1    = m_config->get_double("hydrology.cavitation_opening_coefficient"),
+    c2    = m_config->get_double("hydrology.creep_closure_coefficient"),
+    Wr    = m_config->get_double("hydrology.roughness_scale"),
+    phi0  = m_config->get_double("hydrology.regularizing_porosity");
+
+  const double CC = (rg * hdt) / phi0;
+
+  overburden_pressure(m_Pover);
+
+  const IceModelVec2CellType &mask = *m_grid->variables().get_2d_cell_type("mask");
+
+  {
+    IceModelVec::AccessList list{&m_P, &m_Wold, &m_Wnew, &m_velbase_mag, &mask, &m_Pover,
+        &m_implicit_rhs};
+
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      if (mask.ice_free_land(i,j)) {
+        m_implicit_rhs(i,j) = 0.0;
+      } else if (mask.ocean(i,j)) {
+        m_implicit_rhs(i,j) = m_Pover(i,j);
+      } else if (m_Wold(i,j) <= 0.0) {
+        m_implicit_rhs(i,j) = m_Pover(i,j);
+      } else {
+        // opening and closure terms in pressure equation
+        double Open = std::max(0.0,c1 * m_velbase_mag(i,j) * (Wr - m_Wold(i,j)));
+        double Close = c2 * Aglen * pow(m_Pover(i,j) - m_P(i,j),nglen) * m_Wold(i,j);
+
+        m_implicit_rhs(i,j) = m_P(i,j) + CC * ((m_Wnew(i,j) - m_Wold(i,j)) / hdt - Open +
+                                               (1.0 - m_theta) * Close);
+      }
+    }
+  }
+
+  m_implicit_dt = hdt;
+
+  // use P at the beginning of the step as the initial guess
+  m_Pnew.copy_from(m_P);
+
+  m_implicit_pressure = true;
+  try {
+    implicit_solve(m_Pnew, "water pressure");
+  } catch (...) {
+    m_implicit_pressure = false;
+    throw;
+  }
+  m_implicit_pressure = false;
+
+  // projection to enforce  0 <= P <= P_o
+  IceModelVec::AccessList list{&m_Pover, &m_Pnew};
+
+  for (Points p(*m_grid); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    m_Pnew(i,j) = std::min(std::max(0.0, m_Pnew(i,j)), m_Pover(i,j));
+  }
+}
+
+//! Compute the residual of the implicit update of W or P (see `m_implicit_pressure`).
+void Distributed::implicit_function(Vec x, IceModelVec2S &result) {
+  if (not m_implicit_pressure) {
+    Routing::implicit_function(x, result);
+    return;
+  }
+
+  const double
+    rg    = m_config->get_double("constants.fresh_water.density") * m_config->get_double("constants.standard_gravity"),
+    nglen = m_config->get_double("stress_balance.sia.Glen_exponent"), // choice is SIA; see #285
+    Aglen = m_config->get_double("flow_law.isothermal_Glen.ice_softness"),
+    c2    = m_config->get_double("hydrology.creep_closure_coefficient"),
+    phi0  = m_config->get_double("hydrology.regularizing_porosity"),
+    CC    = (rg * m_implicit_dt) / phi0;
+
+  // result <- P (current iterate)
+  result.copy_from_vec(x);
+
+  const IceModelVec2CellType &mask = *m_grid->variables().get_2d_cell_type("mask");
+
+  IceModelVec::AccessList list{&m_Wold, &mask, &m_Pover, &m_implicit_rhs, &result};
+
+  for (Points p(*m_grid); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    double Close = 0.0;
+    if (not (mask.ice_free_land(i,j) or mask.ocean(i,j) or m_Wold(i,j) <= 0.0)) {
+      Close = c2 * Aglen * pow(std::max(m_Pover(i,j) - result(i,j), 0.0), nglen) * m_Wold(i,j);
+    }
+
+    result(i,j) -= m_implicit_rhs(i,j) + CC * m_theta * Close;
+  }
+}
+
 //! Update the model state variables W,P by running the subglacial hydrology model.
 /*!
 Runs the hydrology model from time icet to time icet + icedt.  Here [icet,icedt]
@@ -329,15 +511,6 @@ void Distributed::update_impl(double icet, double icedt) {
     update_velbase_mag(m_velbase_mag);
   }
 
-  const double
-            rg    = m_config->get_double("constants.fresh_water.density") * m_config->get_double("constants.standard_gravity"),
-            nglen = m_config->get_double("stress_balance.sia.Glen_exponent"), // choice is SIA; see #285
-            Aglen = m_config->get_double("flow_law.isothermal_Glen.ice_softness"),
-            c1    = m_config->get_double("hydrology.cavitation_opening_coefficient"),
-            c2    = m_config->get_double("hydrology.creep_closure_coefficient"),
-            Wr    = m_config->get_double("hydrology.roughness_scale"),
-            phi0  = m_config->get_double("hydrology.regularizing_porosity");
-
   double
     ht    = m_t,
     hdt   = 0.0,                  // hydrology model time and time step
@@ -375,17 +548,7 @@ void Distributed::update_impl(double icet, double icedt) {
     //   first time through the current loop, we enforce them
     check_P_bounds((hydrocount == 1));
 
-    water_thickness_staggered(m_Wstag);
-    m_Wstag.update_ghosts();
-
-    conductivity_staggered(m_K,maxKW);
-    m_K.update_ghosts();
-
-    velocity_staggered(m_V);
-
-    // to get Qstag, W needs valid ghosts
-    advective_fluxes(m_Q);
-    m_Q.update_ghosts();
+    update_staggered_fields(maxKW);
 
     adaptive_for_WandP_evolution(ht, m_t+m_dt, maxKW, hdt, maxV, maxD, PtoCFLratio);
     cumratio += PtoCFLratio;
@@ -403,56 +566,17 @@ void Distributed::update_impl(double icet, double icedt) {
     negativegain += delta_neggain;
     nullstriplost+= delta_nullstrip;
 
-    // update Pnew from time step
-    const double
-      CC  = (rg * hdt) / phi0,
-      wux = 1.0 / (m_dx * m_dx),
-      wuy = 1.0 / (m_dy * m_dy);
-    double diffW;
-    overburden_pressure(m_Pover);
-
-    const IceModelVec2CellType &mask = *m_grid->variables().get_2d_cell_type("mask");
-
-    IceModelVec::AccessList list{&m_P, &m_W, &m_Wtil, &m_Wtilnew, &m_velbase_mag, &m_Wstag,
-        &m_K, &m_Q, &m_total_input, &mask, &m_Pover, &m_Pnew};
-
-    for (Points p(*m_grid); p; p.next()) {
-      const int i = p.i(), j = p.j();
+    if (m_theta > 0.0) {
+      // update Wnew (P is held fixed) and then Pnew (using Wnew)
+      implicit_update_W(hdt);
+      implicit_update_P(hdt);
+    } else {
+      // update Pnew from time step
+      raw_update_P(hdt);
 
-      if (mask.ice_free_land(i,j)) {
-        m_Pnew(i,j) = 0.0;
-      } else if (mask.ocean(i,j)) {
-        m_Pnew(i,j) = m_Pover(i,j);
-      } else if (m_W(i,j) <= 0.0) {
-        m_Pnew(i,j) = m_Pover(i,j);
-      } else {
-        // opening and closure terms in pressure equation
-        double Open = std::max(0.0,c1 * m_velbase_mag(i,j) * (Wr - m_W(i,j)));
-        double Close = c2 * Aglen * pow(m_Pover(i,j) - m_P(i,j),nglen) * m_W(i,j);
-
-        // compute the flux divergence the same way as in raw_update_W()
-        const double divadflux =
-          (m_Q(i,j,0) - m_Q(i-1,j  ,0)) / m_dx +
-          (m_Q(i,j,1) - m_Q(i,  j-1,1)) / m_dy;
-        const double
-          De = rg * m_K(i,  j,0) * m_Wstag(i,  j,0),
-          Dw = rg * m_K(i-1,j,0) * m_Wstag(i-1,j,0),
-          Dn = rg * m_K(i,j  ,1) * m_Wstag(i,j  ,1),
-          Ds = rg * m_K(i,j-1,1) * m_Wstag(i,j-1,1);
-        diffW =   wux * (De * (m_W(i+1,j) - m_W(i,j)) - Dw * (m_W(i,j) - m_W(i-1,j)))
-          + wuy * (Dn * (m_W(i,j+1) - m_W(i,j)) - Ds * (m_W(i,j) - m_W(i,j-1)));
-        double divflux = - divadflux + diffW;
-
-        // pressure update equation
-        double ZZ = Close - Open + m_total_input(i,j) - (m_Wtilnew(i,j) - m_Wtil(i,j)) / hdt;
-        m_Pnew(i,j) = m_P(i,j) + CC * (divflux + ZZ);
-        // projection to enforce  0 <= P <= P_o
-        m_Pnew(i,j) = std::min(std::max(0.0, m_Pnew(i,j)), m_Pover(i,j));
-      }
+      // update Wnew from W, Wtil, Wtilnew, Wstag, Qstag, total_input
+      raw_update_W(hdt);
     }
-
-    // update Wnew from W, Wtil, Wtilnew, Wstag, Qstag, total_input
-    raw_update_W(hdt);
     boundary_mass_changes(m_Wnew, delta_icefree, delta_ocean,
                           delta_neggain, delta_nullstrip);
     icefreelost  += delta_icefree;
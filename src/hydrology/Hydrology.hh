@@ -21,6 +21,8 @@
 
 #include "pism/util/iceModelVec.hh"
 #include "pism/util/Component.hh"
+#include "pism/util/petscwrappers/SNES.hh"
+#include "pism/util/petscwrappers/Mat.hh"
 
 namespace pism {
 
@@ -318,18 +320,56 @@ protected:
 
   virtual void conductivity_staggered(IceModelVec2Stag &result, double &maxKW);
   virtual void velocity_staggered(IceModelVec2Stag &result) const;
-  friend class Routing_bwatvel;  // needed because bwatvel diagnostic needs protected velocity_staggered()
+  void water_velocity(IceModelVec2Stag &result) const;
+  friend class Routing_bwatvel;  // needed because bwatvel diagnostic needs protected water_velocity()
   virtual void advective_fluxes(IceModelVec2Stag &result);
 
   virtual void adaptive_for_W_evolution(double t_current, double t_end, double maxKW,
                                         double &dt_result,
                                         double &maxV_result, double &maxD_result,
                                         double &dtCFL_result, double &dtDIFFW_result);
+  void adaptive_for_W_evolution(double t_current, double t_end, double maxKW,
+                                double max_u, double max_v,
+                                double &dt_result,
+                                double &maxV_result, double &maxD_result,
+                                double &dtCFL_result, double &dtDIFFW_result);
 
   void raw_update_W(double hdt);
   void raw_update_Wtil(double hdt);
+
+  void update_staggered_fields(double &maxKW);
+
+  // fused explicit sub-step (see update_impl())
+  void explicit_step_maximums(double &maxKW, double &max_u, double &max_v);
+  void explicit_step(double hdt,
+                     double &icefreelost, double &oceanlost,
+                     double &negativegain, double &nullstriplost);
+
+  // implicit time stepping
+  void implicit_update_W(double hdt);
+  void implicit_solve(IceModelVec2S &solution, const char *name);
+  virtual void implicit_function(Vec x, IceModelVec2S &result);
+  static PetscErrorCode implicit_function_callback(SNES snes, Vec x, Vec f, void *ctx);
 protected:
   double m_dx, m_dy;
+
+  //! Time stepping method: 0 is explicit, 1 is backward Euler, 1/2 is Crank-Nicolson.
+  double m_theta;
+  //! True if explicit sub-steps use explicit_step() instead of field-based passes.
+  bool m_fused_explicit_step;
+  //! Time step used by the implicit solver (needed in SNES callbacks).
+  double m_implicit_dt;
+  //! Water thickness at the beginning of a time step (implicit time stepping only).
+  IceModelVec2S m_Wold;
+  //! Parts of the residual that do not depend on the unknown.
+  IceModelVec2S m_implicit_rhs;
+  //! Water thickness at the current nonlinear iteration (used in SNES callbacks).
+  IceModelVec2S m_W_iterate;
+  //! Residual storage used in SNES callbacks.
+  IceModelVec2S m_implicit_residual;
+  petsc::SNES m_snes;
+  petsc::Mat m_jacobian;
+  MatFDColoring m_fd_coloring;
 };
 
 //! \brief The PISM subglacial hydrology model for a distributed linked-cavity system.
@@ -378,6 +418,10 @@ protected:
                                             double &dt_result,
                                             double &maxV_result, double &maxD_result,
                                             double &PtoCFLratio);
+
+  void raw_update_P(double hdt);
+  void implicit_update_P(double hdt);
+  virtual void implicit_function(Vec x, IceModelVec2S &result);
 protected:
   // this model's state, in addition to what is in hydrology::Routing
   IceModelVec2S m_P;      //!< water pressure
@@ -386,6 +430,8 @@ protected:
     m_velbase_mag,  //!< sliding speed of overlying ice
     m_Pnew;   //!< pressure during update
   bool m_hold_velbase_mag;
+  //! True if the SNES solver is used for the pressure equation, false for the water thickness.
+  bool m_implicit_pressure;
 
   // need to get basal sliding velocity (thus speed):
   stressbalance::StressBalance* m_stressbalance;
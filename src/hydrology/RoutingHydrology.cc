@@ -28,6 +28,9 @@
 #include "pism/util/MaxTimestep.hh"
 #include "pism/util/pism_utilities.hh"
 #include "pism/util/IceModelVec2CellType.hh"
+#include "pism/util/TerminationReason.hh"
+#include "pism/util/GlobalReduction.hh"
+#include "pism/util/ConfigInterface.hh"
 
 namespace pism {
 namespace hydrology {
@@ -104,10 +107,96 @@ Routing::Routing(IceGrid::ConstPtr g)
                     "new thickness of till (subglacial) water layer during update",
                     "m", "");
   m_Wtilnew.metadata().set_double("valid_min", 0.0);
+
+  {
+    const std::string method = m_config->get_string("hydrology.time_integration");
+    if (method == "backward_euler") {
+      m_theta = 1.0;
+    } else if (method == "crank_nicolson") {
+      m_theta = 0.5;
+    } else {
+      m_theta = 0.0;
+    }
+  }
+
+  m_implicit_dt = 0.0;
+  m_fd_coloring = NULL;
+
+  m_fused_explicit_step = (m_theta == 0.0 and
+                           m_config->get_boolean("hydrology.fused_explicit_step"));
+
+  if (m_theta > 0.0) {
+    m_Wold.create(m_grid, "Wold_internal", WITHOUT_GHOSTS);
+    m_Wold.set_attrs("internal",
+                     "thickness of transportable subglacial water layer at the beginning of a time step",
+                     "m", "");
+    m_implicit_rhs.create(m_grid, "implicit_rhs", WITHOUT_GHOSTS);
+    m_implicit_rhs.set_attrs("internal",
+                             "parts of the residual that do not depend on the unknown",
+                             "", "");
+    m_W_iterate.create(m_grid, "W_iterate_internal", WITH_GHOSTS, 1);
+    m_W_iterate.set_attrs("internal",
+                          "water layer thickness at the current nonlinear iteration",
+                          "m", "");
+    m_implicit_residual.create(m_grid, "implicit_residual", WITHOUT_GHOSTS);
+    m_implicit_residual.set_attrs("internal",
+                                  "residual of the implicit time step",
+                                  "", "");
+
+    PetscErrorCode ierr;
+
+    ierr = SNESCreate(m_grid->com, m_snes.rawptr());
+    PISM_CHK(ierr, "SNESCreate");
+
+    ierr = SNESSetOptionsPrefix(m_snes, "hydrology_");
+    PISM_CHK(ierr, "SNESSetOptionsPrefix");
+
+    ierr = SNESSetFunction(m_snes, NULL, implicit_function_callback, this);
+    PISM_CHK(ierr, "SNESSetFunction");
+
+    // The Jacobian is approximated using finite differences and a coloring of the DMDA
+    // (the residual at a grid point depends on values at neighboring points only).
+    {
+      petsc::DM::Ptr da = m_grid->get_dm(1, 1);
+
+      ierr = DMCreateMatrix(*da, m_jacobian.rawptr());
+      PISM_CHK(ierr, "DMCreateMatrix");
+
+      ISColoring coloring;
+      ierr = DMCreateColoring(*da, IS_COLORING_GLOBAL, &coloring);
+      PISM_CHK(ierr, "DMCreateColoring");
+
+      ierr = MatFDColoringCreate(m_jacobian, coloring, &m_fd_coloring);
+      PISM_CHK(ierr, "MatFDColoringCreate");
+
+      ierr = MatFDColoringSetFunction(m_fd_coloring,
+                                      (PetscErrorCode (*)(void))implicit_function_callback,
+                                      this);
+      PISM_CHK(ierr, "MatFDColoringSetFunction");
+
+      ierr = MatFDColoringSetFromOptions(m_fd_coloring);
+      PISM_CHK(ierr, "MatFDColoringSetFromOptions");
+
+      ierr = MatFDColoringSetUp(m_jacobian, coloring, m_fd_coloring);
+      PISM_CHK(ierr, "MatFDColoringSetUp");
+
+      ierr = ISColoringDestroy(&coloring);
+      PISM_CHK(ierr, "ISColoringDestroy");
+    }
+
+    ierr = SNESSetJacobian(m_snes, m_jacobian, m_jacobian,
+                           SNESComputeJacobianDefaultColor, m_fd_coloring);
+    PISM_CHK(ierr, "SNESSetJacobian");
+
+    ierr = SNESSetFromOptions(m_snes);
+    PISM_CHK(ierr, "SNESSetFromOptions");
+  }
 }
 
 Routing::~Routing() {
-  // empty
+  if (m_fd_coloring != NULL) {
+    MatFDColoringDestroy(&m_fd_coloring);
+  }
 }
 
 
@@ -604,19 +693,34 @@ void Routing::adaptive_for_W_evolution(double t_current, double t_end, double ma
                                        double &dt_result,
                                        double &maxV_result, double &maxD_result,
                                        double &dtCFL_result, double &dtDIFFW_result) {
+  std::vector<double> tmp = m_V.absmaxcomponents();
+
+  adaptive_for_W_evolution(t_current, t_end, maxKW, tmp[0], tmp[1],
+                           dt_result, maxV_result, maxD_result, dtCFL_result, dtDIFFW_result);
+}
+
+//! Compute the adaptive time step for evolution of W using maximums of |u| and |v|.
+void Routing::adaptive_for_W_evolution(double t_current, double t_end, double maxKW,
+                                       double max_u, double max_v,
+                                       double &dt_result,
+                                       double &maxV_result, double &maxD_result,
+                                       double &dtCFL_result, double &dtDIFFW_result) {
   const double
     dtmax = m_config->get_double("hydrology.maximum_time_step", "seconds"),
     rg    = m_config->get_double("constants.standard_gravity") * m_config->get_double("constants.fresh_water.density");
 
   // V could be zero if P is constant and bed is flat
-  std::vector<double> tmp = m_V.absmaxcomponents();
-  maxV_result = sqrt(tmp[0]*tmp[0] + tmp[1]*tmp[1]);
+  maxV_result = sqrt(max_u*max_u + max_v*max_v);
   maxD_result = rg * maxKW;
-  dtCFL_result = 0.5 / (tmp[0]/m_dx + tmp[1]/m_dy); // FIXME: is regularization needed?
+  dtCFL_result = 0.5 / (max_u/m_dx + max_v/m_dy); // FIXME: is regularization needed?
   dtDIFFW_result = 1.0/(m_dx*m_dx) + 1.0/(m_dy*m_dy);
   dtDIFFW_result = 0.25 / (maxD_result * dtDIFFW_result);
   // dt = min { te-t, dtmax, dtCFL, dtDIFFW }
   dt_result = std::min(t_end - t_current, dtmax);
+  if (m_theta > 0.0) {
+    // implicit time stepping is not subject to CFL and diffusion restrictions
+    return;
+  }
   dt_result = std::min(dt_result, dtCFL_result);
   dt_result = std::min(dt_result, dtDIFFW_result);
 }
@@ -653,11 +757,41 @@ void Routing::raw_update_Wtil(double hdt) {
 }
 
 
+//! Rate of change of the water thickness due to transport (advection and diffusion).
+/*!
+ * Computes \f$ - \nabla \cdot \mathbf{Q} + \nabla \cdot (D \nabla W) \f$, where
+ * \f$D = \rho_w g K W\f$, at the grid point (i, j). Requires ghosts of all inputs.
+ */
+static inline double water_transport(const IceModelVec2S &W,
+                                     const IceModelVec2Stag &Wstag,
+                                     const IceModelVec2Stag &K,
+                                     const IceModelVec2Stag &Q,
+                                     double rg, double dx, double dy,
+                                     int i, int j) {
+  const double
+    wux = 1.0 / (dx * dx),
+    wuy = 1.0 / (dy * dy);
+
+  const double divadflux =
+    (Q(i, j, 0) - Q(i - 1, j, 0)) / dx +
+    (Q(i, j, 1) - Q(i, j - 1, 1)) / dy;
+
+  const double
+    De = rg * K(i,     j,     0) * Wstag(i,     j,     0),
+    Dw = rg * K(i - 1, j,     0) * Wstag(i - 1, j,     0),
+    Dn = rg * K(i,     j,     1) * Wstag(i,     j,     1),
+    Ds = rg * K(i,     j - 1, 1) * Wstag(i,     j - 1, 1);
+
+  const double diffW =
+    wux * (De * (W(i + 1, j) - W(i, j)) - Dw * (W(i, j) - W(i - 1, j))) +
+    wuy * (Dn * (W(i, j + 1) - W(i, j)) - Ds * (W(i, j) - W(i, j - 1)));
+
+  return - divadflux + diffW;
+}
+
 //! The computation of Wnew, called by update().
 void Routing::raw_update_W(double hdt) {
   const double
-    wux = 1.0 / (m_dx * m_dx),
-    wuy = 1.0 / (m_dy * m_dy),
     rg  = m_config->get_double("constants.standard_gravity") * m_config->get_double("constants.fresh_water.density");
 
   IceModelVec::AccessList list{&m_W, &m_Wtil, &m_Wtilnew, &m_Wstag, &m_K, &m_Q,
@@ -666,21 +800,501 @@ void Routing::raw_update_W(double hdt) {
   for (Points p(*m_grid); p; p.next()) {
     const int i = p.i(), j = p.j();
 
-    const double divadflux =
-      (m_Q(i, j, 0) - m_Q(i - 1, j, 0)) / m_dx +
-      (m_Q(i, j, 1) - m_Q(i, j - 1, 1)) / m_dy;
+    const double transport = water_transport(m_W, m_Wstag, m_K, m_Q, rg, m_dx, m_dy, i, j);
+
+    m_Wnew(i, j) = m_W(i, j) - m_Wtilnew(i, j) + m_Wtil(i, j) + hdt * (transport + m_total_input(i, j));
+  }
+}
+
+//! Compute staggered grid water thickness, conductivity, velocity, and advective flux.
+/*!
+ * Uses the current value of `m_W` (ghosts have to be up to date). Updates ghosts of
+ * results.
+ */
+void Routing::update_staggered_fields(double &maxKW) {
+  water_thickness_staggered(m_Wstag);
+  m_Wstag.update_ghosts();
 
-    const double
-      De = rg * m_K(i,     j,     0) * m_Wstag(i,     j,     0),
-      Dw = rg * m_K(i - 1, j,     0) * m_Wstag(i - 1, j,     0),
-      Dn = rg * m_K(i,     j,     1) * m_Wstag(i,     j,     1),
-      Ds = rg * m_K(i,     j - 1, 1) * m_Wstag(i,     j - 1, 1);
+  conductivity_staggered(m_K, maxKW);
+  m_K.update_ghosts();
 
-    const double diffW =
-      wux * (De * (m_W(i + 1, j) - m_W(i, j)) - Dw * (m_W(i, j) - m_W(i - 1, j))) +
-      wuy * (Dn * (m_W(i, j + 1) - m_W(i, j)) - Ds * (m_W(i, j) - m_W(i, j - 1)));
+  velocity_staggered(m_V);
+
+  // to get Q, W needs valid ghosts
+  advective_fluxes(m_Q);
+  m_Q.update_ghosts();
+}
 
-    m_Wnew(i, j) = m_W(i, j) - m_Wtilnew(i, j) + m_Wtil(i, j) + hdt * ( - divadflux + diffW + m_total_input(i, j));
+//! Staggered grid quantities at one cell edge.
+struct RoutingEdge {
+  //! water thickness
+  double W;
+  //! conductivity
+  double K;
+  //! normal component of the water velocity
+  double V;
+  //! advective flux
+  double Q;
+};
+
+//! Computes staggered grid quantities at a cell edge on the fly (used by explicit sub-steps).
+/*!
+ * Combines water_thickness_staggered(), conductivity_staggered(), velocity_staggered(),
+ * and advective_fluxes() (using the same discretization) to avoid storing intermediate
+ * staggered grid fields and communicating their ghosts.
+ *
+ * Uses W, the cell type mask, the water pressure P, and the bed elevation at points of a
+ * box stencil of width 1 around the edge (all of these have to have valid ghosts).
+ *
+ * The caller is responsible for providing access to all inputs.
+ */
+class RoutingEdgeKernel {
+public:
+  RoutingEdgeKernel(const IceGrid &grid, const Config &config, double stripwidth,
+                    const IceModelVec2CellType &mask, const IceModelVec2S &W,
+                    const IceModelVec2S &P, const IceModelVec2S &bed)
+    : m_grid(grid), m_stripwidth(stripwidth),
+      m_mask(mask), m_W(W), m_P(P), m_bed(bed) {
+    m_k     = config.get_double("hydrology.hydraulic_conductivity");
+    m_alpha = config.get_double("hydrology.thickness_power_in_flux");
+    m_beta  = config.get_double("hydrology.gradient_power_in_flux");
+    m_rg    = config.get_double("constants.standard_gravity") * config.get_double("constants.fresh_water.density");
+    m_dx    = grid.dx();
+    m_dy    = grid.dy();
+
+    if (m_alpha < 1.0) {
+      throw RuntimeError::formatted(PISM_ERROR_LOCATION, "alpha = %f < 1 which is not allowed", m_alpha);
+    }
+  }
+
+  //! Compute quantities at the east (o == 0) or north (o == 1) edge of the cell (i, j).
+  inline RoutingEdge operator()(int i, int j, int o) const {
+    const int
+      i1 = o == 0 ? i + 1 : i,
+      j1 = o == 0 ? j : j + 1;
+
+    RoutingEdge result;
+
+    // water thickness (see water_thickness_staggered())
+    if (m_mask.grounded_ice(i, j)) {
+      if (m_mask.grounded_ice(i1, j1)) {
+        result.W = 0.5 * (m_W(i, j) + m_W(i1, j1));
+      } else {
+        result.W = m_W(i, j);
+      }
+    } else {
+      if (m_mask.grounded_ice(i1, j1)) {
+        result.W = m_W(i1, j1);
+      } else {
+        result.W = 0.0;
+      }
+    }
+
+    // conductivity (see conductivity_staggered())
+    const double Ktmp = m_k * pow(result.W, m_alpha - 1.0);
+    if (m_beta != 2.0) {
+      double dRdx, dRdy;
+      if (o == 0) {
+        dRdx = (R(i + 1, j) - R(i, j)) / m_dx;
+        dRdy = (R(i + 1, j + 1) + R(i, j + 1) - R(i + 1, j - 1) - R(i, j - 1)) / (4.0 * m_dy);
+      } else {
+        dRdx = (R(i + 1, j + 1) + R(i + 1, j) - R(i - 1, j + 1) - R(i - 1, j)) / (4.0 * m_dx);
+        dRdy = (R(i, j + 1) - R(i, j)) / m_dy;
+      }
+      const double
+        Pi      = dRdx * dRdx + dRdy * dRdy,
+        betapow = (m_beta - 2.0) / 2.0;
+
+      if (m_beta < 2.0) {
+        const double eps = 1.0;   // Pa m-1
+        result.K = Ktmp * pow(Pi + eps * eps, betapow);
+      } else {
+        result.K = Ktmp * pow(Pi, betapow);
+      }
+    } else {
+      result.K = Ktmp;
+    }
+
+    // velocity (see velocity_staggered())
+    if (result.W > 0.0) {
+      const double
+        h    = o == 0 ? m_dx : m_dy,
+        dPds = (m_P(i1, j1) - m_P(i, j)) / h,
+        dbds = (m_bed(i1, j1) - m_bed(i, j)) / h;
+      result.V = - result.K * (dPds + m_rg * dbds);
+    } else {
+      result.V = 0.0;
+    }
+
+    if (in_null_strip(m_grid, i, j, m_stripwidth) or
+        in_null_strip(m_grid, i1, j1, m_stripwidth)) {
+      result.V = 0.0;
+    }
+
+    // advective flux (see advective_fluxes())
+    result.Q = (result.V >= 0.0) ? result.V * m_W(i, j) : result.V * m_W(i1, j1);
+
+    return result;
+  }
+private:
+  //! R = P + rho_w g b
+  inline double R(int i, int j) const {
+    return m_P(i, j) + m_rg * m_bed(i, j);
+  }
+
+  const IceGrid &m_grid;
+  double m_stripwidth;
+  const IceModelVec2CellType &m_mask;
+  const IceModelVec2S &m_W, &m_P, &m_bed;
+  double m_k, m_alpha, m_beta, m_rg, m_dx, m_dy;
+};
+
+//! Compute the rate of change of W due to transport using staggered grid quantities computed on the fly.
+/*!
+ * Same as water_transport() above, but uses RoutingEdgeKernel instead of stored staggered
+ * grid fields. `W` has to be the field used by `edge`.
+ */
+static inline double water_transport(const RoutingEdgeKernel &edge,
+                                     const IceModelVec2S &W,
+                                     double rg, double dx, double dy,
+                                     int i, int j) {
+  const double
+    wux = 1.0 / (dx * dx),
+    wuy = 1.0 / (dy * dy);
+
+  const RoutingEdge
+    e = edge(i,     j,     0),
+    w = edge(i - 1, j,     0),
+    n = edge(i,     j,     1),
+    s = edge(i,     j - 1, 1);
+
+  const double divadflux =
+    (e.Q - w.Q) / dx +
+    (n.Q - s.Q) / dy;
+
+  const double
+    De = rg * e.K * e.W,
+    Dw = rg * w.K * w.W,
+    Dn = rg * n.K * n.W,
+    Ds = rg * s.K * s.W;
+
+  const double diffW =
+    wux * (De * (W(i + 1, j) - W(i, j)) - Dw * (W(i, j) - W(i - 1, j))) +
+    wuy * (Dn * (W(i, j + 1) - W(i, j)) - Ds * (W(i, j) - W(i, j - 1)));
+
+  return - divadflux + diffW;
+}
+
+//! The implicit (backward Euler or Crank-Nicolson) computation of Wnew, called by update().
+/*!
+Solves the nonlinear equation
+  \f[ W^{n+1} = W^{n} - (W_{til}^{n+1} - W_{til}^{n}) + \Delta t \left(\frac{m}{\rho_w} +
+  \theta T(W^{n+1}) + (1 - \theta) T(W^{n})\right) \f]
+for \f$ W^{n+1} \f$ using SNES. Here \f$T(W)\f$ is the rate of change due to transport
+(see water_transport()), recomputed from the current iterate (the conductivity and the
+velocity depend on \f$ W \f$), and \f$ \theta \f$ is 1 for backward Euler and 1/2 for
+Crank-Nicolson. The water pressure is not updated during the solve.
+
+Expects staggered grid fields computed using \f$ W^{n} \f$. Puts the result in `m_Wnew`
+and saves \f$ W^{n} \f$ in `m_Wold`; the caller is responsible for boundary mass
+changes, as in the explicit case.
+ */
+void Routing::implicit_update_W(double hdt) {
+  const double
+    rg  = m_config->get_double("constants.standard_gravity") * m_config->get_double("constants.fresh_water.density");
+
+  m_implicit_dt = hdt;
+
+  m_Wold.copy_from(m_W);
+
+  {
+    IceModelVec::AccessList list{&m_W, &m_Wtil, &m_Wtilnew, &m_Wstag, &m_K, &m_Q,
+        &m_total_input, &m_implicit_rhs};
+
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      double transport = 0.0;
+      if (m_theta < 1.0) {
+        transport = water_transport(m_W, m_Wstag, m_K, m_Q, rg, m_dx, m_dy, i, j);
+      }
+
+      m_implicit_rhs(i, j) = (m_W(i, j) - m_Wtilnew(i, j) + m_Wtil(i, j) +
+                              hdt * (m_total_input(i, j) + (1.0 - m_theta) * transport));
+    }
+  }
+
+  // the water pressure is not updated during the solve (see implicit_function())
+  subglacial_water_pressure(m_R);  // yes, it updates ghosts
+
+  // use W at the beginning of the step as the initial guess
+  m_Wnew.copy_from(m_W);
+
+  implicit_solve(m_Wnew, "water thickness");
+}
+
+//! Solve the implicit time step equation using SNES; `solution` contains the initial guess.
+void Routing::implicit_solve(IceModelVec2S &solution, const char *name) {
+  PetscErrorCode ierr;
+
+  ierr = SNESSolve(m_snes, NULL, solution.get_vec());
+  PISM_CHK(ierr, "SNESSolve");
+
+  solution.inc_state_counter();
+
+  SNESConvergedReason snes_reason;
+  ierr = SNESGetConvergedReason(m_snes, &snes_reason);
+  PISM_CHK(ierr, "SNESGetConvergedReason");
+
+  TerminationReason::Ptr reason(new SNESTerminationReason(snes_reason));
+  if (reason->failed()) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "hydrology: the implicit solver for the %s failed to converge"
+                                  " (SNES reason %s).\n"
+                                  "Try reducing hydrology.maximum_time_step.",
+                                  name, reason->description().c_str());
+  }
+
+  PetscInt iterations = 0;
+  ierr = SNESGetIterationNumber(m_snes, &iterations);
+  PISM_CHK(ierr, "SNESGetIterationNumber");
+
+  m_log->message(4, "   hydrology: %s: %d Newton iterations (%s)\n",
+                 name, (int)iterations, reason->description().c_str());
+}
+
+//! Compute the residual of the implicit water thickness update.
+/*!
+ * The iterate `x` (which may be a finite difference perturbation of the current
+ * iterate) is copied into `m_W_iterate`; `m_W` and staggered grid fields are not
+ * modified. Staggered grid quantities are computed on the fly using RoutingEdgeKernel.
+ *
+ * Negative values of `x` (possible during nonlinear iterations) are replaced with zeros
+ * when computing transport terms.
+ *
+ * Expects the water pressure in `m_R` (see implicit_update_W()).
+ */
+void Routing::implicit_function(Vec x, IceModelVec2S &result) {
+  const double
+    rg  = m_config->get_double("constants.standard_gravity") * m_config->get_double("constants.fresh_water.density");
+
+  const IceModelVec2CellType &mask     = *m_grid->variables().get_2d_cell_type("mask");
+  const IceModelVec2S        &bed      = *m_grid->variables().get_2d_scalar("bedrock_altitude");
+  const IceModelVec2S        &pressure = m_R;
+
+  result.copy_from_vec(x);
+
+  m_W_iterate.copy_from_vec(x);
+  {
+    IceModelVec::AccessList list{&m_W_iterate};
+
+    for (PointsWithGhosts p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      m_W_iterate(i, j) = std::max(m_W_iterate(i, j), 0.0);
+    }
+  }
+
+  RoutingEdgeKernel edge(*m_grid, *m_config, m_stripwidth, mask, m_W_iterate, pressure, bed);
+
+  IceModelVec::AccessList list{&mask, &m_W_iterate, &pressure, &bed, &m_implicit_rhs, &result};
+
+  for (Points p(*m_grid); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    const double transport = water_transport(edge, m_W_iterate, rg, m_dx, m_dy, i, j);
+
+    result(i, j) -= m_implicit_rhs(i, j) + m_implicit_dt * m_theta * transport;
+  }
+}
+
+PetscErrorCode Routing::implicit_function_callback(SNES snes, Vec x, Vec f, void *ctx) {
+  Routing *model = reinterpret_cast<Routing*>(ctx);
+
+  try {
+    (void) snes;
+    model->implicit_function(x, model->m_implicit_residual);
+
+    PetscErrorCode ierr = VecCopy(model->m_implicit_residual.get_vec(), f);
+    CHKERRQ(ierr);
+  } catch (...) {
+    MPI_Comm com = model->m_grid->com;
+    handle_fatal_errors(com);
+    SETERRQ(com, 1, "A PISM callback failed");
+  }
+  return 0;
+}
+
+
+//! Compute maximums of K W and of components of the water velocity needed to choose an explicit time step.
+/*!
+ * Uses the current values of `m_W` (ghosts have to be up to date). Puts the water
+ * pressure in `m_R`.
+ */
+void Routing::explicit_step_maximums(double &maxKW, double &max_u, double &max_v) {
+  const IceModelVec2CellType &mask = *m_grid->variables().get_2d_cell_type("mask");
+  const IceModelVec2S        &bed  = *m_grid->variables().get_2d_scalar("bedrock_altitude");
+
+  IceModelVec2S &pressure = m_R;
+  subglacial_water_pressure(pressure);  // yes, it updates ghosts
+
+  RoutingEdgeKernel edge(*m_grid, *m_config, m_stripwidth, mask, m_W, pressure, bed);
+
+  IceModelVec::AccessList list{&mask, &m_W, &pressure, &bed};
+
+  double my_maxKW = 0.0, my_max_u = 0.0, my_max_v = 0.0;
+
+  for (Points p(*m_grid); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    const RoutingEdge
+      e = edge(i, j, 0),
+      n = edge(i, j, 1);
+
+    my_maxKW = std::max(my_maxKW, std::max(e.K * e.W, n.K * n.W));
+    my_max_u = std::max(my_max_u, fabs(e.V));
+    my_max_v = std::max(my_max_v, fabs(n.V));
+  }
+
+  GlobalReduction reduction(m_grid->com);
+  const unsigned int
+    KW = reduction.max(my_maxKW),
+    u  = reduction.max(my_max_u),
+    v  = reduction.max(my_max_v);
+  reduction.resolve();
+
+  maxKW = reduction[KW];
+  max_u = reduction[u];
+  max_v = reduction[v];
+}
+
+//! Take one explicit time step, updating W and Wtil in one sweep.
+/*!
+ * This is equivalent to calling raw_update_Wtil(), boundary_mass_changes() for Wtilnew,
+ * raw_update_W(), and boundary_mass_changes() for Wnew, but staggered grid quantities are
+ * computed on the fly, Wtil is updated in place, and all the mass accounting is done
+ * using one global reduction.
+ *
+ * Expects the water pressure in `m_R` (see explicit_step_maximums()). Puts the new water
+ * thickness in `m_Wnew` and adds boundary mass changes to the arguments.
+ */
+void Routing::explicit_step(double hdt,
+                            double &icefreelost, double &oceanlost,
+                            double &negativegain, double &nullstriplost) {
+  const double
+    tillwat_max         = m_config->get_double("hydrology.tillwat_max"),
+    C                   = m_config->get_double("hydrology.tillwat_decay_rate"),
+    fresh_water_density = m_config->get_double("constants.fresh_water.density"),
+    rg                  = m_config->get_double("constants.standard_gravity") * fresh_water_density;
+
+  const bool null_strip = m_stripwidth > 0.0;
+
+  const IceModelVec2CellType &mask      = *m_grid->variables().get_2d_cell_type("mask");
+  const IceModelVec2S        &bed       = *m_grid->variables().get_2d_scalar("bedrock_altitude");
+  const IceModelVec2S        &cell_area = *m_grid->variables().get_2d_scalar("cell_area");
+  const IceModelVec2S        &pressure  = m_R;
+
+  RoutingEdgeKernel edge(*m_grid, *m_config, m_stripwidth, mask, m_W, pressure, bed);
+
+  // boundary mass changes: index 0 corresponds to Wtil, 1 to W
+  double
+    my_icefreelost[2]   = {0.0, 0.0},
+    my_oceanlost[2]     = {0.0, 0.0},
+    my_negativegain[2]  = {0.0, 0.0},
+    my_nullstriplost[2] = {0.0, 0.0};
+
+  IceModelVec::AccessList list{&mask, &m_W, &pressure, &bed, &cell_area,
+      &m_Wtil, &m_total_input, &m_Wnew};
+
+  for (Points p(*m_grid); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    const double dmassdz = cell_area(i, j) * fresh_water_density; // kg m-1
+    const bool
+      ice_free_land = mask.ice_free_land(i, j),
+      ocean         = mask.ocean(i, j),
+      strip         = null_strip and in_null_strip(*m_grid, i, j, m_stripwidth);
+
+    double thk[2];
+
+    // update Wtil (see raw_update_Wtil())
+    const double Wtil = m_Wtil(i, j);
+    thk[0] = Wtil + hdt * (m_total_input(i, j) - C);
+    thk[0] = std::min(std::max(0.0, thk[0]), tillwat_max);
+
+    for (int k = 0; k < 2; ++k) {
+      if (k == 1) {
+        // update W (see raw_update_W()) using Wtilnew after boundary mass changes
+        const double transport = water_transport(edge, m_W, rg, m_dx, m_dy, i, j);
+
+        thk[1] = m_W(i, j) - thk[0] + Wtil + hdt * (transport + m_total_input(i, j));
+      }
+
+      // boundary mass changes (see boundary_mass_changes())
+      if (thk[k] < 0.0) {
+        my_negativegain[k] += -thk[k] * dmassdz;
+        thk[k] = 0.0;
+      }
+      if (ice_free_land and (thk[k] > 0.0)) {
+        my_icefreelost[k] += thk[k] * dmassdz;
+        thk[k] = 0.0;
+      }
+      if (ocean and (thk[k] > 0.0)) {
+        my_oceanlost[k] += thk[k] * dmassdz;
+        thk[k] = 0.0;
+      }
+      if (strip) {
+        my_nullstriplost[k] += thk[k] * dmassdz;
+        thk[k] = 0.0;
+      }
+    }
+
+    m_Wtil(i, j) = thk[0];
+    m_Wnew(i, j) = thk[1];
+  }
+
+  GlobalReduction reduction(m_grid->com);
+  unsigned int
+    icefree_index[2], ocean_index[2], neggain_index[2], strip_index[2];
+  for (int k = 0; k < 2; ++k) {
+    icefree_index[k] = reduction.sum(my_icefreelost[k]);
+    ocean_index[k]   = reduction.sum(my_oceanlost[k]);
+    neggain_index[k] = reduction.sum(my_negativegain[k]);
+    strip_index[k]   = reduction.sum(my_nullstriplost[k]);
+  }
+  reduction.resolve();
+
+  for (int k = 0; k < 2; ++k) {
+    icefreelost   += reduction[icefree_index[k]];
+    oceanlost     += reduction[ocean_index[k]];
+    negativegain  += reduction[neggain_index[k]];
+    nullstriplost += reduction[strip_index[k]];
+  }
+}
+
+
+//! Compute the water velocity on the staggered grid using the current water thickness.
+/*!
+ * Same as velocity_staggered(), but computes staggered grid quantities on the fly, so it
+ * does not use `m_Wstag` and `m_K`. (These are not updated by explicit_step() and lag
+ * one sub-step behind `m_W` in the implicit case.)
+ */
+void Routing::water_velocity(IceModelVec2Stag &result) const {
+  const IceModelVec2CellType &mask = *m_grid->variables().get_2d_cell_type("mask");
+  const IceModelVec2S        &bed  = *m_grid->variables().get_2d_scalar("bedrock_altitude");
+
+  IceModelVec2S &pressure = m_R;
+  subglacial_water_pressure(pressure);  // yes, it updates ghosts
+
+  RoutingEdgeKernel edge(*m_grid, *m_config, m_stripwidth, mask, m_W, pressure, bed);
+
+  IceModelVec::AccessList list{&mask, &m_W, &pressure, &bed, &result};
+
+  for (Points p(*m_grid); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    result(i, j, 0) = edge(i, j, 0).V;
+    result(i, j, 1) = edge(i, j, 1).V;
   }
 }
 
@@ -691,8 +1305,10 @@ Runs the hydrology model from time icet to time icet + icedt.  Here [icet, icedt
 is generally on the order of months to years.  This hydrology model will take its
 own shorter time steps, perhaps hours to weeks.
 
-To update W = `bwat` we call raw_update_W(), and to update Wtil = `tillwat` we
-call raw_update_Wtil().
+Explicit sub-steps use explicit_step_maximums() to choose the time step and
+explicit_step() to update W = `bwat` and Wtil = `tillwat` (this is equivalent to
+calling raw_update_Wtil() and raw_update_W(), followed by boundary_mass_changes()).
+The field-based passes are used instead if `hydrology.fused_explicit_step` is not set.
  */
 void Routing::update_impl(double icet, double icedt) {
 
@@ -730,46 +1346,54 @@ void Routing::update_impl(double icet, double icedt) {
     check_Wtil_bounds();
 #endif
 
-    water_thickness_staggered(m_Wstag);
-    m_Wstag.update_ghosts();
-
-    conductivity_staggered(m_K, maxKW);
-    m_K.update_ghosts();
-
-    velocity_staggered(m_V);
+    if (m_fused_explicit_step) {
+      double max_u = 0.0, max_v = 0.0;
+      explicit_step_maximums(maxKW, max_u, max_v);
 
-    // to get Q, W needs valid ghosts
-    advective_fluxes(m_Q);
-    m_Q.update_ghosts();
+      adaptive_for_W_evolution(ht, m_t+m_dt, maxKW, max_u, max_v,
+                               hdt, maxV, maxD, dtCFL, dtDIFFW);
+    } else {
+      update_staggered_fields(maxKW);
 
-    adaptive_for_W_evolution(ht, m_t+m_dt, maxKW,
-                             hdt, maxV, maxD, dtCFL, dtDIFFW);
+      adaptive_for_W_evolution(ht, m_t+m_dt, maxKW,
+                               hdt, maxV, maxD, dtCFL, dtDIFFW);
+    }
 
     if ((m_inputtobed != NULL) || (hydrocount==1)) {
       get_input_rate(ht, hdt, m_total_input);
     }
 
-    // update Wtilnew from Wtil
-    raw_update_Wtil(hdt);
-    boundary_mass_changes(m_Wtilnew, delta_icefree, delta_ocean,
-                          delta_neggain, delta_nullstrip);
-    icefreelost  += delta_icefree;
-    oceanlost    += delta_ocean;
-    negativegain += delta_neggain;
-    nullstriplost+= delta_nullstrip;
-
-    // update Wnew from W, Wtil, Wtilnew, Wstag, Q, total_input
-    raw_update_W(hdt);
-    boundary_mass_changes(m_Wnew, delta_icefree, delta_ocean,
-                          delta_neggain, delta_nullstrip);
-    icefreelost  += delta_icefree;
-    oceanlost    += delta_ocean;
-    negativegain += delta_neggain;
-    nullstriplost+= delta_nullstrip;
+    if (m_fused_explicit_step) {
+      // update Wtil (in place) and Wnew
+      explicit_step(hdt, icefreelost, oceanlost, negativegain, nullstriplost);
+    } else {
+      // update Wtilnew from Wtil
+      raw_update_Wtil(hdt);
+      boundary_mass_changes(m_Wtilnew, delta_icefree, delta_ocean,
+                            delta_neggain, delta_nullstrip);
+      icefreelost  += delta_icefree;
+      oceanlost    += delta_ocean;
+      negativegain += delta_neggain;
+      nullstriplost+= delta_nullstrip;
+
+      // update Wnew from W, Wtil, Wtilnew, Wstag, Q, total_input
+      if (m_theta > 0.0) {
+        implicit_update_W(hdt);
+      } else {
+        raw_update_W(hdt);
+      }
+      boundary_mass_changes(m_Wnew, delta_icefree, delta_ocean,
+                            delta_neggain, delta_nullstrip);
+      icefreelost  += delta_icefree;
+      oceanlost    += delta_ocean;
+      negativegain += delta_neggain;
+      nullstriplost+= delta_nullstrip;
+
+      m_Wtil.copy_from(m_Wtilnew);
+    }
 
     // transfer new into old
     m_Wnew.update_ghosts(m_W);
-    m_Wtil.copy_from(m_Wtilnew);
 
     ht += hdt;
   } // end of hydrology model time-stepping loop
@@ -810,7 +1434,7 @@ IceModelVec::Ptr Routing_bwatvel::compute_impl() const {
   result->metadata(0) = m_vars[0];
   result->metadata(1) = m_vars[1];
 
-  model->velocity_staggered(*result);
+  model->water_velocity(*result);
 
   return result;
 }
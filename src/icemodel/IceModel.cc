@@ -35,6 +35,7 @@
 #include "pism/energy/BedThermalUnit.hh"
 #include "pism/hydrology/Hydrology.hh"
 #include "pism/stressbalance/StressBalance.hh"
+#include "pism/stressbalance/sia/SIAFD.hh"
 #include "pism/util/IceGrid.hh"
 #include "pism/util/Mask.hh"
 #include "pism/util/ConfigInterface.hh"
@@ -377,6 +378,27 @@ void IceModel::enforce_consistency_of_geometry(bool remove_icebergs) {
   m_geometry.ensure_consistency(m_config->get_double("geometry.ice_free_thickness_standard"));
 }
 
+//! Finish the bed deformation update that is still in progress (if any).
+/*!
+  Bed deformation models may update the bed asynchronously (see
+  bed_deformation.lc.asynchronous). This has to be called before the model state or
+  diagnostics are saved and at the end of a run, so that saved fields are consistent.
+*/
+void IceModel::finish_bed_deformation_update() {
+  if (not m_beddef) {
+    return;
+  }
+
+  int topg_state_counter = m_beddef->bed_elevation().get_state_counter();
+
+  m_beddef->finish_pending_update();
+
+  if (m_beddef->bed_elevation().get_state_counter() != topg_state_counter) {
+    m_new_bed_elevation = true;
+    enforce_consistency_of_geometry(false); // don't remove icebergs
+  }
+}
+
 stressbalance::Inputs IceModel::stress_balance_inputs() {
   stressbalance::Inputs result;
   if (m_config->get_boolean("geometry.update.use_basal_melt_rate")) {
@@ -533,15 +555,18 @@ void IceModel::step(bool do_mass_continuity,
 
   //! \li update the age of the ice (if appropriate)
   if (m_age_model and updateAtDepth) {
-    AgeModelInputs inputs;
-    inputs.ice_thickness = &m_geometry.ice_thickness;
-    inputs.u3            = &m_stress_balance->velocity_u();
-    inputs.v3            = &m_stress_balance->velocity_v();
-    inputs.w3            = &m_stress_balance->velocity_w();
-
-    profiling.begin("age");
-    m_age_model->update(current_time, dt_TempAge, inputs);
-    profiling.end("age");
+    // if age.fused_sweep is set the age is updated in energy_step() below
+    if (not fused_age_sweep()) {
+      AgeModelInputs inputs;
+      inputs.ice_thickness = &m_geometry.ice_thickness;
+      inputs.u3            = &m_stress_balance->velocity_u();
+      inputs.v3            = &m_stress_balance->velocity_v();
+      inputs.w3            = &m_stress_balance->velocity_w();
+
+      profiling.begin("age");
+      m_age_model->update(current_time, dt_TempAge, inputs);
+      profiling.end("age");
+    }
     m_stdout_flags += "a";
   } else {
     m_stdout_flags += "$";
@@ -654,7 +679,47 @@ void IceModel::step(bool do_mass_continuity,
 }
 
 /*!
- * Perform an explicit step of the mass continuity equation and apply calving parameterizations.
+ * SIA diffusivity computed by the stress balance modifier.
+ *
+ * Returns NULL if the stress balance modifier is not SIAFD.
+ */
+const IceModelVec2Stag* IceModel::sia_diffusivity() const {
+  const stressbalance::SIAFD *sia =
+    dynamic_cast<const stressbalance::SIAFD*>(m_stress_balance->modifier());
+
+  return sia != NULL ? &sia->diffusivity() : NULL;
+}
+
+/*!
+ * SIA diffusivity used by the semi-implicit mass continuity scheme.
+ *
+ * Returns NULL if `geometry.update.implicit_sia` is not set or the stress balance
+ * modifier is not SIAFD (then the SIA flux is treated explicitly).
+ */
+const IceModelVec2Stag* IceModel::implicit_sia_diffusivity() const {
+  if (not m_config->get_boolean("geometry.update.implicit_sia")) {
+    return NULL;
+  }
+
+  return sia_diffusivity();
+}
+
+/*!
+ * SIA diffusivity used to re-compute diffusive fluxes during local time steps.
+ *
+ * Returns NULL if `geometry.update.local_time_stepping` is not set or the stress balance
+ * modifier is not SIAFD (then there is no diffusive flux).
+ */
+const IceModelVec2Stag* IceModel::local_time_stepping_diffusivity() const {
+  if (not m_config->get_boolean("geometry.update.local_time_stepping")) {
+    return NULL;
+  }
+
+  return sia_diffusivity();
+}
+
+/*!
+ * Perform a step of the mass continuity equation and apply calving parameterizations.
  */
 void IceModel::update_ice_geometry(bool skip) {
   const Profiling &profiling = m_ctx->profiling();
@@ -681,6 +746,13 @@ void IceModel::update_ice_geometry(bool skip) {
   // FIXME: thickness B.C. mask should be separate
   IceModelVec2Int &thickness_bc_mask = m_ssa_dirichlet_bc_mask;
 
+  // GeometryEvolution does not allow using semi-implicit SIA and local time stepping
+  // together, so at most one of these is not NULL
+  const IceModelVec2Stag *diffusivity = implicit_sia_diffusivity();
+  if (diffusivity == NULL) {
+    diffusivity = local_time_stepping_diffusivity();
+  }
+
   m_geometry_evolution->step(m_geometry,
                              m_dt,
                              m_stress_balance->advective_velocity(),
@@ -688,7 +760,8 @@ void IceModel::update_ice_geometry(bool skip) {
                              m_ssa_dirichlet_bc_mask,
                              thickness_bc_mask,
                              surface_mass_balance_rate,
-                             m_basal_melt_rate);
+                             m_basal_melt_rate,
+                             diffusivity);
 
   m_geometry_evolution->update_geometry(m_geometry);
 
@@ -839,6 +912,9 @@ void IceModel::run() {
     }
   } // end of the time-stepping loop
 
+  // The loop above may be stopped early (by a signal, for example).
+  finish_bed_deformation_update();
+
   profiling.stage_end("time-stepping loop");
 
   options::Integer pause_time("-pause", "Pause after the run, seconds", 0);
@@ -92,6 +92,7 @@ class IceGrid;
 class AgeModel;
 class IceModelVec2CellType;
 class Component;
+class GlobalReduction;
 
 struct FractureFields {
   FractureFields(IceGrid::ConstPtr grid);
@@ -140,11 +141,13 @@ public:
   const IceModelVec2S &discharge() const;
 
   double ice_volume(double thickness_threshold) const;
+  unsigned int ice_volume(double thickness_threshold, GlobalReduction &reduction) const;
   double ice_volume_not_displacing_seawater(double thickness_threshold) const;
   double sealevel_volume(double thickness_threshold) const;
   double ice_volume_temperate(double thickness_threshold) const;
   double ice_volume_cold(double thickness_threshold) const;
   double ice_area(double thickness_threshold) const;
+  unsigned int ice_area(double thickness_threshold, GlobalReduction &reduction) const;
   double ice_area_grounded(double thickness_threshold) const;
   double ice_area_floating(double thickness_threshold) const;
   double ice_area_temperate(double thickness_threshold) const;
@@ -317,12 +320,17 @@ protected:
 
   // see iMenergy.cc
   virtual void energy_step();
+  bool fused_age_sweep() const;
 
   virtual void combine_basal_melt_rate(IceModelVec2S &result);
 
   void enforce_consistency_of_geometry(bool remove_icebergs);
+  void finish_bed_deformation_update();
 
   virtual void update_ice_geometry(bool skip);
+  const IceModelVec2Stag* sia_diffusivity() const;
+  const IceModelVec2Stag* implicit_sia_diffusivity() const;
+  const IceModelVec2Stag* local_time_stepping_diffusivity() const;
   virtual void do_calving();
   virtual void Href_cleanup();
   virtual void compute_discharge(const IceModelVec2S &thickness,
@@ -339,6 +347,7 @@ protected:
 
   // see iMreport.cc
   virtual double compute_temperate_base_fraction(double ice_area);
+  unsigned int temperate_base_area(GlobalReduction &reduction) const;
   virtual double compute_original_ice_fraction(double ice_volume);
   virtual void print_summary(bool tempAndAge);
   virtual void print_summary_line(bool printPrototype, bool tempAndAge,
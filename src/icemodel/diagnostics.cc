@@ -33,6 +33,7 @@
 #include "pism/util/Diagnostic.hh"
 #include "pism/util/Vars.hh"
 #include "pism/util/error_handling.hh"
+#include "pism/util/GlobalReduction.hh"
 #include "pism/util/iceModelVec3Custom.hh"
 #include "pism/util/pism_utilities.hh"
 #include "pism/util/projection.hh"
@@ -2525,9 +2526,30 @@ void IceModel::list_diagnostics() const {
  */
 double IceModel::compute_temperate_base_fraction(double total_ice_area) {
 
+  GlobalReduction reduction(m_grid->com);
+  const unsigned int meltarea = temperate_base_area(reduction);
+  reduction.resolve();
+
+  double result = reduction[meltarea];
+
+  // normalize fraction correctly
+  if (total_ice_area > 0.0) {
+    result = result / total_ice_area;
+  } else {
+    result = 0.0;
+  }
+  return result;
+}
+
+//! Registers the area of the temperate base (in km^2) with `reduction`.
+/*!
+ * Returns the index of the result. See compute_temperate_base_fraction().
+ */
+unsigned int IceModel::temperate_base_area(GlobalReduction &reduction) const {
+
   EnthalpyConverter::Ptr EC = m_ctx->enthalpy_converter();
 
-  double result = 0.0, meltarea = 0.0;
+  double meltarea = 0.0;
 
   const IceModelVec3 &enthalpy = m_energy_model->enthalpy();
 
@@ -2550,20 +2572,12 @@ double IceModel::compute_temperate_base_fraction(double total_ice_area) {
   } catch (...) {
     loop.failed();
   }
-  loop.check();
+  loop.check(reduction);
 
   // convert from m2 to km2
   meltarea = units::convert(m_sys, meltarea, "m2", "km2");
-  // communication
-  result = GlobalSum(m_grid->com, meltarea);
 
-  // normalize fraction correctly
-  if (total_ice_area > 0.0) {
-    result = result / total_ice_area;
-  } else {
-    result = 0.0;
-  }
-  return result;
+  return reduction.sum(meltarea);
 }
 
 
@@ -2629,6 +2643,14 @@ double IceModel::compute_original_ice_fraction(double total_ice_volume) {
 
 //! Computes the ice volume, in m^3.
 double IceModel::ice_volume(double thickness_threshold) const {
+  GlobalReduction reduction(m_grid->com);
+  const unsigned int volume = ice_volume(thickness_threshold, reduction);
+  reduction.resolve();
+  return reduction[volume];
+}
+
+//! Registers the ice volume (in m^3) with `reduction`. Returns the index of the result.
+unsigned int IceModel::ice_volume(double thickness_threshold, GlobalReduction &reduction) const {
   IceModelVec::AccessList list{&m_geometry.cell_area, &m_geometry.ice_thickness};
 
   double volume = 0.0;
@@ -2653,7 +2675,7 @@ double IceModel::ice_volume(double thickness_threshold) const {
     }
   }
 
-  return GlobalSum(m_grid->com, volume);
+  return reduction.sum(volume);
 }
 
 double IceModel::ice_volume_not_displacing_seawater(double thickness_threshold) const {
@@ -2790,6 +2812,14 @@ double IceModel::ice_volume_cold(double thickness_threshold) const {
 
 //! Computes ice area, in m^2.
 double IceModel::ice_area(double thickness_threshold) const {
+  GlobalReduction reduction(m_grid->com);
+  const unsigned int area = ice_area(thickness_threshold, reduction);
+  reduction.resolve();
+  return reduction[area];
+}
+
+//! Registers the ice area (in m^2) with `reduction`. Returns the index of the result.
+unsigned int IceModel::ice_area(double thickness_threshold, GlobalReduction &reduction) const {
   double area = 0.0;
 
   IceModelVec::AccessList list{&m_geometry.ice_thickness, &m_geometry.cell_area};
@@ -2801,7 +2831,7 @@ double IceModel::ice_area(double thickness_threshold) const {
     }
   }
 
-  return GlobalSum(m_grid->com, area);
+  return reduction.sum(area);
 }
 
 //! Computes area of basal ice which is temperate, in m^2.
@@ -71,11 +71,24 @@ void IceModel::energy_step() {
   m_btu->update(m_bedtoptemp, t_TempAge, dt_TempAge);
   profiling.end("btu");
 
-  m_energy_model->update(t_TempAge, dt_TempAge, energy_model_inputs());
+  energy::Inputs inputs = energy_model_inputs();
+  if (fused_age_sweep()) {
+    // update age in the same sweep over columns
+    inputs.age_model = m_age_model;
+  }
+
+  m_energy_model->update(t_TempAge, dt_TempAge, inputs);
 
   m_stdout_flags = m_energy_model->stdout_flags() + m_stdout_flags;
 }
 
+//! Returns true if the age of the ice is updated during the energy step.
+bool IceModel::fused_age_sweep() const {
+  return (m_age_model != NULL and
+          m_config->get_boolean("age.fused_sweep") and
+          not m_config->get_boolean("age.semi_lagrangian"));
+}
+
 //! @brief Combine basal melt rate in grounded and floating areas.
 /**
  * Grounded basal melt rate is computed as a part of the energy
@@ -177,6 +177,11 @@ void IceModel::save_variables(const PIO &file,
                               const std::set<std::string> &variables,
                               IO_Type default_diagnostics_type) {
 
+  // Saved fields have to include the pending (asynchronous) bed deformation update. Note
+  // that the model uses the finished update right away, so with asynchronous updates the
+  // trajectory depends on output times.
+  finish_bed_deformation_update();
+
   // define the time dimension if necessary (no-op if it is already defined)
   io::define_time(file, *m_grid->ctx());
   // define the "timestamp" (wall clock time since the beginning of the run)
@@ -34,6 +34,7 @@
 #include "pism/earth/BedDef.hh"
 #include "pism/util/EnthalpyConverter.hh"
 #include "pism/util/pism_utilities.hh"
+#include "pism/util/GlobalReduction.hh"
 #include "pism/age/AgeModel.hh"
 #include "pism/energy/EnergyModel.hh"
 
@@ -44,14 +45,17 @@ namespace pism {
 /*! This applies to the horizontal part of the 3D advection problem solved by AgeModel and the
 horizontal part of the 3D convection-diffusion problems solved by EnthalpyModel and
 TemperatureModel.
+
+Registers the number of violations with `reduction` and returns the index of the result.
 */
-unsigned int count_CFL_violations(const IceModelVec3 &u3,
-                                  const IceModelVec3 &v3,
-                                  const IceModelVec2S &ice_thickness,
-                                  double dt) {
+static unsigned int count_CFL_violations(const IceModelVec3 &u3,
+                                         const IceModelVec3 &v3,
+                                         const IceModelVec2S &ice_thickness,
+                                         double dt,
+                                         GlobalReduction &reduction) {
 
   if (dt == 0.0) {
-    return 0;
+    return reduction.max(0.0);
   }
 
   IceGrid::ConstPtr grid = u3.get_grid();
@@ -87,9 +91,9 @@ unsigned int count_CFL_violations(const IceModelVec3 &u3,
   } catch (...) {
     loop.failed();
   }
-  loop.check();
+  loop.check(reduction);
 
-  return (unsigned int)GlobalMax(grid->com, CFL_violation_count);
+  return reduction.max(CFL_violation_count);
 }
 
 void IceModel::print_summary(bool tempAndAge) {
@@ -98,8 +102,20 @@ void IceModel::print_summary(bool tempAndAge) {
     &u3 = m_stress_balance->velocity_u(),
     &v3 = m_stress_balance->velocity_v();
 
-  unsigned int n_CFL_violations = count_CFL_violations(u3, v3, m_geometry.ice_thickness,
-                                                       tempAndAge ? dt_TempAge : m_dt);
+  const bool report_meltfrac = tempAndAge or m_log->get_threshold() >= 3;
+
+  // Compute all the global quantities reported below using one reduction.
+  GlobalReduction reduction(m_grid->com);
+  const unsigned int
+    n_CFL_violations_index = count_CFL_violations(u3, v3, m_geometry.ice_thickness,
+                                                  tempAndAge ? dt_TempAge : m_dt,
+                                                  reduction),
+    volume_index           = ice_volume(0.0, reduction),   // m^3
+    area_index             = ice_area(0.0, reduction),     // m^2
+    meltarea_index         = report_meltfrac ? temperate_base_area(reduction) : 0;
+  reduction.resolve();
+
+  unsigned int n_CFL_violations = static_cast<unsigned int>(reduction[n_CFL_violations_index]);
 
   // report CFL violations
   if (n_CFL_violations > 0.0) {
@@ -119,12 +135,12 @@ void IceModel::print_summary(bool tempAndAge) {
   // get maximum diffusivity
   double max_diffusivity = m_stress_balance->max_diffusivity();
   // get volumes in m^3 and areas in m^2
-  double volume = ice_volume(0.0);
-  double area = ice_area(0.0);
+  double volume = reduction[volume_index];
+  double area = reduction[area_index];
 
   double meltfrac = 0.0;
-  if (tempAndAge or m_log->get_threshold() >= 3) {
-    meltfrac = compute_temperate_base_fraction(area);
+  if (report_meltfrac and area > 0.0) {
+    meltfrac = reduction[meltarea_index] / area;
   }
 
   // main report: 'S' line
@@ -137,8 +137,23 @@ void IceModel::max_timestep(double &dt_result, unsigned int &skip_counter_result
   if (m_config->get_boolean("geometry.update.enabled")) {
     CFLData cfl = m_stress_balance->max_timestep_cfl_2d();
 
-    restrictions.push_back(MaxTimestep(cfl.dt_max.value(), "2D CFL"));
-    restrictions.push_back(max_timestep_diffusivity());
+    // With local time stepping cells limiting the time step are sub-cycled using steps
+    // down to dt / 2^max_level.
+    double factor = 1.0;
+    if (m_config->get_boolean("geometry.update.local_time_stepping")) {
+      const int max_level = m_config->get_double("geometry.update.local_time_stepping_max_level");
+      factor = 1 << max_level;
+    }
+
+    restrictions.push_back(MaxTimestep(factor * cfl.dt_max.value(), "2D CFL"));
+
+    // the semi-implicit scheme for the SIA flux is not subject to this restriction (it is
+    // used only if the stress balance modifier is SIAFD)
+    if (implicit_sia_diffusivity() == NULL) {
+      MaxTimestep dt_diffusivity = max_timestep_diffusivity();
+      restrictions.push_back(MaxTimestep(factor * dt_diffusivity.value(),
+                                         dt_diffusivity.description()));
+    }
   }
 
   // Hit multiples of X years, if requested.
@@ -279,6 +279,8 @@
 
 %include pism_BedDef.i
 
+%include calving.i
+
 %include AgeModel.i
 
 /* The regional model implements some classes derived from SSAFD and
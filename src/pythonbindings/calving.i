@@ -0,0 +1,6 @@
+%{
+#include "calving/IcebergRemover.hh"
+%}
+
+%shared_ptr(pism::calving::IcebergRemover)
+%include "calving/IcebergRemover.hh"
@@ -1,6 +1,7 @@
 %{
 /* Using directives needed to compile IceModelVec wrappers. */  
 #include "util/IceModelVec2CellType.hh"
+#include "util/iceModelVec2T.hh"
 
 using namespace pism;
 %}
@@ -12,6 +13,7 @@ using namespace pism;
 %shared_ptr(pism::IceModelVec2V)
 %shared_ptr(pism::IceModelVec2Int)
 %shared_ptr(pism::IceModelVec2CellType)
+%shared_ptr(pism::IceModelVec2T)
 %shared_ptr(pism::IceModelVec2Stag)
 %shared_ptr(pism::IceModelVec3D)
 %shared_ptr(pism::IceModelVec3)
@@ -150,4 +152,5 @@ using namespace pism;
 %ignore pism::StarStencil::operator[];
 %include "util/iceModelVec.hh"
 %include "util/IceModelVec2CellType.hh"
+%include "util/iceModelVec2T.hh"
 %include "util/Vector2.hh"
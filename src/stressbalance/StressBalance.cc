@@ -16,6 +16,9 @@
 // along with PISM; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
+#include <cmath>      // fabs
+#include <algorithm>  // std::max, std::min
+
 #include "StressBalance.hh"
 #include "ShallowStressBalance.hh"
 #include "SSB_Modifier.hh"
@@ -28,6 +31,7 @@
 #include "pism/util/Vars.hh"
 #include "pism/util/error_handling.hh"
 #include "pism/util/Profiling.hh"
+#include "pism/util/GlobalReduction.hh"
 #include "pism/util/IceModelVec2CellType.hh"
 #include "pism/geometry/Geometry.hh"
 
@@ -100,29 +104,34 @@ void StressBalance::update(const Inputs &inputs, bool full_update) {
                        inputs, full_update);
     profiling.end("stress_balance.modifier");
 
+    GlobalReduction reduction(m_grid->com);
+    DeferredCFLData cfl_3d;
+
     if (full_update) {
       const IceModelVec3 &u = m_modifier->velocity_u();
       const IceModelVec3 &v = m_modifier->velocity_v();
 
-      profiling.begin("stress_balance.strain_heat");
-      this->compute_volumetric_strain_heating(inputs);
-      profiling.end("stress_balance.strain_heat");
+      // One pass over u and v: computes the vertical velocity, the strain heating and the
+      // maximum speeds needed for the 3D CFL condition.
+      profiling.begin("stress_balance.vertical_velocity_and_strain_heat");
+      cfl_3d = this->compute_vertical_velocity_and_strain_heating(inputs, u, v,
+                                                                  m_w, m_strain_heating,
+                                                                  reduction);
+      profiling.end("stress_balance.vertical_velocity_and_strain_heat");
+    }
+
+    DeferredCFLData cfl_2d = ::pism::max_timestep_cfl_2d(inputs.geometry->ice_thickness,
+                                                         inputs.geometry->cell_type,
+                                                         m_shallow_stress_balance->velocity(),
+                                                         reduction);
 
-      profiling.begin("stress_balance.vertical_velocity");
-      this->compute_vertical_velocity(inputs.geometry->cell_type,
-                                      u, v, inputs.basal_melt_rate, m_w);
-      profiling.end("stress_balance.vertical_velocity");
+    // compute all CFL maxima using one global reduction
+    reduction.resolve();
 
-      m_cfl_3d = ::pism::max_timestep_cfl_3d(inputs.geometry->ice_thickness,
-                                             inputs.geometry->cell_type,
-                                             m_modifier->velocity_u(),
-                                             m_modifier->velocity_v(),
-                                             m_w);
+    if (full_update) {
+      m_cfl_3d = cfl_3d.get(reduction);
     }
-
-    m_cfl_2d = ::pism::max_timestep_cfl_2d(inputs.geometry->ice_thickness,
-                                           inputs.geometry->cell_type,
-                                           m_shallow_stress_balance->velocity());
+    m_cfl_2d = cfl_2d.get(reduction);
   }
   catch (RuntimeError &e) {
     e.add_context("updating the stress balance");
@@ -176,7 +185,31 @@ void StressBalance::compute_2D_stresses(const IceModelVec2V &velocity,
   m_shallow_stress_balance->compute_2D_stresses(velocity, mask, result);
 }
 
-//! Compute vertical velocity using incompressibility of the ice.
+/**
+ * This function computes \f$D^2\f$ defined by
+ *
+ * \f[ 2D^2 = D_{ij} D_{ij}\f]
+ * or
+ * \f[
+ * D^2 = \frac{1}{2}\,\left(\frac{1}{2}\,(v_{z})^2 + (v_{y} + u_{x})^2 +
+ *       (v_{y})^2 + \frac{1}{2}\,(v_{x} + u_{y})^2 + \frac{1}{2}\,(u_{z})^2 +
+ *       (u_{x})^2\right)
+ * \f]
+ *
+ * (note the use of the summation convention). Here \f$D_{ij}\f$ is the
+ * strain rate tensor. See
+ * StressBalance::compute_vertical_velocity_and_strain_heating() for details.
+ *
+ * @param u_x,u_y,u_z partial derivatives of \f$u\f$, the x-component of the ice velocity
+ * @param v_x,v_y,v_z partial derivatives of \f$v\f$, the y-component of the ice velocity
+ *
+ * @return \f$D^2\f$, where \f$D\f$ is defined above.
+ */
+static inline double D2(double u_x, double u_y, double u_z, double v_x, double v_y, double v_z) {
+  return 0.5 * (PetscSqr(u_x + v_y) + u_x*u_x + v_y*v_y + 0.5 * (PetscSqr(u_y + v_x) + u_z*u_z + v_z*v_z));
+}
+
+//! Compute vertical velocity using incompressibility of the ice and the volumetric strain heating.
 /*!
 The vertical velocity \f$w(x,y,z,t)\f$ is the velocity *relative to the
 location of the base of the ice column*.  That is, the vertical velocity
@@ -205,276 +238,143 @@ Here the value \f$w_b(x,y,t)\f$ is either zero or the negative of the basal melt
 according to the value of the flag `geometry.update.use_basal_melt_rate`.
 
 The vertical integral is computed by the trapezoid rule.
- */
-void StressBalance::compute_vertical_velocity(const IceModelVec2CellType &mask,
-                                              const IceModelVec3 &u,
-                                              const IceModelVec3 &v,
-                                              const IceModelVec2S *basal_melt_rate,
-                                              IceModelVec3 &result) {
-
-  const bool use_upstream_fd = m_config->get_string("stress_balance.vertical_velocity_approximation") == "upstream";
-
-  IceModelVec::AccessList list{&u, &v, &mask, &result};
-
-  if (basal_melt_rate) {
-    list.add(*basal_melt_rate);
-  }
-
-  const std::vector<double> &z = m_grid->z();
-  const unsigned int Mz = m_grid->Mz();
-
-  const double
-    dx = m_grid->dx(),
-    dy = m_grid->dy();
-
-  std::vector<double> u_x_plus_v_y(Mz);
-
-  for (Points p(*m_grid); p; p.next()) {
-    const int i = p.i(), j = p.j();
-
-    double *w_ij = result.get_column(i,j);
-
-    const double
-      *u_w  = u.get_column(i-1,j),
-      *u_ij = u.get_column(i,j),
-      *u_e  = u.get_column(i+1,j);
-    const double
-      *v_s  = v.get_column(i,j-1),
-      *v_ij = v.get_column(i,j),
-      *v_n  = v.get_column(i,j+1);
-
-    double
-      west  = 1.0,
-      east  = 1.0,
-      south = 1.0,
-      north = 1.0;
-    double
-      D_x = 0,                  // 1/(dx), 1/(2dx), or 0
-      D_y = 0;                  // 1/(dy), 1/(2dy), or 0
-
-    // Switch between second-order centered differences in the interior and
-    // first-order one-sided differences at ice margins.
-
-    // x-derivative
-    {
-      // use basal velocity to determine FD direction ("upwind" when it's clear, centered when it's
-      // not)
-      if (use_upstream_fd) {
-        const double
-          uw = 0.5 * (u_w[0] + u_ij[0]),
-          ue = 0.5 * (u_ij[0] + u_e[0]);
-
-        if (uw > 0.0 and ue >= 0.0) {
-          west = 1.0;
-          east = 0.0;
-        } else if (uw <= 0.0 and ue < 0.0) {
-          west = 0.0;
-          east = 1.0;
-        } else {
-          west = 1.0;
-          east = 1.0;
-        }
-      }
-
-      if ((mask.icy(i,j) and mask.ice_free(i+1,j)) or (mask.ice_free(i,j) and mask.icy(i+1,j))) {
-        east = 0;
-      }
-      if ((mask.icy(i,j) and mask.ice_free(i-1,j)) or (mask.ice_free(i,j) and mask.icy(i-1,j))) {
-        west = 0;
-      }
-
-      if (east + west > 0) {
-        D_x = 1.0 / (dx * (east + west));
-      } else {
-        D_x = 0.0;
-      }
-    }
-
-    // y-derivative
-    {
-      // use basal velocity to determine FD direction ("upwind" when it's clear, centered when it's
-      // not)
-      if (use_upstream_fd) {
-        const double
-          vs = 0.5 * (v_s[0] + v_ij[0]),
-          vn = 0.5 * (v_ij[0] + v_n[0]);
-
-        if (vs > 0.0 and vn >= 0.0) {
-          south = 1.0;
-          north = 0.0;
-        } else if (vs <= 0.0 and vn < 0.0) {
-          south = 0.0;
-          north = 1.0;
-        } else {
-          south = 1.0;
-          north = 1.0;
-        }
-      }
-
-      if ((mask.icy(i,j) and mask.ice_free(i,j+1)) or (mask.ice_free(i,j) and mask.icy(i,j+1))) {
-        north = 0;
-      }
-      if ((mask.icy(i,j) and mask.ice_free(i,j-1)) or (mask.ice_free(i,j) and mask.icy(i,j-1))) {
-        south = 0;
-      }
-
-      if (north + south > 0) {
-        D_y = 1.0 / (dy * (north + south));
-      } else {
-        D_y = 0.0;
-      }
-    }
-
-    // compute u_x + v_y using a vectorizable loop
-    for (unsigned int k = 0; k < Mz; ++k) {
-      double
-        u_x = D_x * (west  * (u_ij[k] - u_w[k]) + east  * (u_e[k] - u_ij[k])),
-        v_y = D_y * (south * (v_ij[k] - v_s[k]) + north * (v_n[k] - v_ij[k]));
-      u_x_plus_v_y[k] = u_x + v_y;
-    }
-
-    // at the base: include the basal melt rate
-    if (basal_melt_rate != NULL) {
-      w_ij[0] = - (*basal_melt_rate)(i,j);
-    } else {
-      w_ij[0] = 0.0;
-    }
-
-    // within the ice and above:
-    for (unsigned int k = 1; k < Mz; ++k) {
-      const double dz = z[k] - z[k-1];
 
-      w_ij[k] = w_ij[k - 1] - (0.5 * dz) * (u_x_plus_v_y[k] + u_x_plus_v_y[k - 1]);
-    }
-  }
-}
+**Volumetric strain heating.**
 
-/**
- * This function computes \f$D^2\f$ defined by
- *
- * \f[ 2D^2 = D_{ij} D_{ij}\f]
- * or
- * \f[
- * D^2 = \frac{1}{2}\,\left(\frac{1}{2}\,(v_{z})^2 + (v_{y} + u_{x})^2 +
- *       (v_{y})^2 + \frac{1}{2}\,(v_{x} + u_{y})^2 + \frac{1}{2}\,(u_{z})^2 +
- *       (u_{x})^2\right)
- * \f]
- *
- * (note the use of the summation convention). Here \f$D_{ij}\f$ is the
- * strain rate tensor. See
- * StressBalance::compute_volumetric_strain_heating() for details.
- *
- * @param u_x,u_y,u_z partial derivatives of \f$u\f$, the x-component of the ice velocity
- * @param v_x,v_y,v_z partial derivatives of \f$v\f$, the y-component of the ice velocity
- *
- * @return \f$D^2\f$, where \f$D\f$ is defined above.
- */
-static inline double D2(double u_x, double u_y, double u_z, double v_x, double v_y, double v_z) {
-  return 0.5 * (PetscSqr(u_x + v_y) + u_x*u_x + v_y*v_y + 0.5 * (PetscSqr(u_y + v_x) + u_z*u_z + v_z*v_z));
-}
-
-/**
-  \brief Computes the volumetric strain heating using horizontal
-  velocity.
-
-  Following the notation used in [\ref BBssasliding], let \f$u\f$ be a
-  three-dimensional *vector* velocity field. Then the strain rate
-  tensor \f$D_{ij}\f$ is defined by
+Following the notation used in [\ref BBssasliding], let \f$u\f$ be a
+three-dimensional *vector* velocity field. Then the strain rate
+tensor \f$D_{ij}\f$ is defined by
 
-  \f[ D_{ij} = \frac 12 \left(\diff{u_{i}}{x_{j}} + \diff{u_{j}}{x_{i}} \right), \f]
+\f[ D_{ij} = \frac 12 \left(\diff{u_{i}}{x_{j}} + \diff{u_{j}}{x_{i}} \right), \f]
 
-  Where \f$i\f$ and \f$j\f$ range from \f$1\f$ to \f$3\f$.
+Where \f$i\f$ and \f$j\f$ range from \f$1\f$ to \f$3\f$.
 
-  The flow law in the viscosity form states
+The flow law in the viscosity form states
 
-  \f[ \tau_{ij} = 2 \eta D_{ij}, \f]
+\f[ \tau_{ij} = 2 \eta D_{ij}, \f]
 
-  and the nonlinear ice viscosity satisfies
+and the nonlinear ice viscosity satisfies
 
-  \f[ 2 \eta = B(T) D^{(1/n) - 1}. \f]
+\f[ 2 \eta = B(T) D^{(1/n) - 1}. \f]
 
-  Here \f$D^{2}\f$ is defined by \f$2D^{2} = D_{ij}D_{ij}\f$ (using the
-  summation convention) and \f$B(T) = A(T)^{-1/n}\f$ is the ice hardness.
+Here \f$D^{2}\f$ is defined by \f$2D^{2} = D_{ij}D_{ij}\f$ (using the
+summation convention) and \f$B(T) = A(T)^{-1/n}\f$ is the ice hardness.
 
-  Now the volumetric strain heating is
+Now the volumetric strain heating is
 
-  \f[ \Sigma = \sum_{i,j=1}^{3}D_{ij}\tau_{ij} = 2 B(T) D^{(1/n) + 1}. \f]
+\f[ \Sigma = \sum_{i,j=1}^{3}D_{ij}\tau_{ij} = 2 B(T) D^{(1/n) + 1}. \f]
 
-  We use an *approximation* of \f$D_{ij}\f$ common in shallow ice models:
+We use an *approximation* of \f$D_{ij}\f$ common in shallow ice models:
 
-  - we assume that horizontal derivatives of the vertical velocity are
-    much smaller than \f$z\f$ derivatives horizontal velocity
-    components \f$u\f$ and \f$v\f$. (We drop \f$w_x\f$ and \f$w_y\f$
-    terms in \f$D_{ij}\f$.)
+- we assume that horizontal derivatives of the vertical velocity are
+  much smaller than \f$z\f$ derivatives horizontal velocity
+  components \f$u\f$ and \f$v\f$. (We drop \f$w_x\f$ and \f$w_y\f$
+  terms in \f$D_{ij}\f$.)
 
-  - we use the incompressibility of ice to approximate \f$w_z\f$:
+- we use the incompressibility of ice to approximate \f$w_z\f$:
 
-  \f[ w_z = - (u_x + v_y). \f]
+\f[ w_z = - (u_x + v_y). \f]
 
-  Requires ghosts of `u` and `v` velocity components and uses the fact
-  that `u` and `v` above the ice are filled using constant
-  extrapolation.
+Requires ghosts of `u` and `v` velocity components and uses the fact
+that `u` and `v` above the ice are filled using constant
+extrapolation.
 
-  Resulting field does not have ghosts.
+The resulting strain heating field does not have ghosts.
 
-  Below is the *Maxima* code that produces the expression evaluated by D2().
+Below is the *Maxima* code that produces the expression evaluated by D2().
 
-       derivabbrev : true;
-       U : [u, v, w]; X : [x, y, z]; depends(U, X);
-       gradef(w, x, 0); gradef(w, y, 0);
-       gradef(w, z, -(diff(u, x) + diff(v, y)));
-       d[i,j] := 1/2 * (diff(U[i], X[j]) + diff(U[j], X[i]));
-       D : genmatrix(d, 3, 3), ratsimp, factor;
-       tex('D = D);
-       tex('D^2 = 1/2 * mat_trace(D . D));
+     derivabbrev : true;
+     U : [u, v, w]; X : [x, y, z]; depends(U, X);
+     gradef(w, x, 0); gradef(w, y, 0);
+     gradef(w, z, -(diff(u, x) + diff(v, y)));
+     d[i,j] := 1/2 * (diff(U[i], X[j]) + diff(U[j], X[i]));
+     D : genmatrix(d, 3, 3), ratsimp, factor;
+     tex('D = D);
+     tex('D^2 = 1/2 * mat_trace(D . D));
 
-  @return 0 on success
+Both quantities use the same five-point neighborhoods of columns of `u` and `v`, so they
+are computed in one pass over the grid. This method also computes the maximum speeds and
+the time step restriction for the 3D CFL condition (see max_timestep_cfl_3d()), registering
+them with `reduction`.
  */
-void StressBalance::compute_volumetric_strain_heating(const Inputs &inputs) {
+DeferredCFLData StressBalance::compute_vertical_velocity_and_strain_heating(const Inputs &inputs,
+                                                                          const IceModelVec3 &u,
+                                                                          const IceModelVec3 &v,
+                                                                          IceModelVec3 &w,
+                                                                          IceModelVec3 &strain_heating,
+                                                                          GlobalReduction &reduction) {
   PetscErrorCode ierr;
 
+  const bool use_upstream_fd = m_config->get_string("stress_balance.vertical_velocity_approximation") == "upstream";
+
   const rheology::FlowLaw *flow_law = m_shallow_stress_balance->flow_law();
   EnthalpyConverter::Ptr EC = m_shallow_stress_balance->enthalpy_converter();
 
-  const IceModelVec3
-    &u = m_modifier->velocity_u(),
-    &v = m_modifier->velocity_v();
-
-  const IceModelVec2S &thickness = inputs.geometry->ice_thickness;
-  const IceModelVec3  *enthalpy  = inputs.enthalpy;
+  const IceModelVec2S        &thickness       = inputs.geometry->ice_thickness;
+  const IceModelVec2CellType &mask            = inputs.geometry->cell_type;
+  const IceModelVec3         *enthalpy        = inputs.enthalpy;
+  const IceModelVec2S        *basal_melt_rate = inputs.basal_melt_rate;
 
-  const IceModelVec2CellType &mask = inputs.geometry->cell_type;
-
-  double
+  const double
     enhancement_factor = flow_law->enhancement_factor(),
     n = flow_law->exponent(),
     exponent = 0.5 * (1.0 / n + 1.0),
     e_to_a_power = pow(enhancement_factor,-1.0/n);
 
-  IceModelVec::AccessList list{&mask, enthalpy, &m_strain_heating, &thickness, &u, &v};
+  IceModelVec::AccessList list{&mask, enthalpy, &thickness, &u, &v, &w, &strain_heating};
+
+  if (basal_melt_rate) {
+    list.add(*basal_melt_rate);
+  }
 
   const std::vector<double> &z = m_grid->z();
   const unsigned int Mz = m_grid->Mz();
-  std::vector<double> depth(Mz), pressure(Mz), hardness(Mz);
+
+  const double
+    dx = m_grid->dx(),
+    dy = m_grid->dy();
+
+  std::vector<double> u_x_plus_v_y(Mz), depth(Mz), pressure(Mz), hardness(Mz);
+
+  // maximum speeds and the time step restriction for the 3D CFL condition (see
+  // max_timestep_cfl_3d())
+  double
+    dt_max = m_config->get_double("time_stepping.maximum_time_step", "seconds"),
+    u_max  = 0.0,
+    v_max  = 0.0,
+    w_max  = 0.0;
 
   ParallelSection loop(m_grid->com);
   try {
     for (Points p(*m_grid); p; p.next()) {
       const int i = p.i(), j = p.j();
 
-      double H = thickness(i, j);
-      int ks = m_grid->kBelowHeight(H);
+      const double H = thickness(i, j);
+      const int ks = m_grid->kBelowHeight(H);
+
       const double
-        *u_ij, *u_w, *u_n, *u_e, *u_s,
-        *v_ij, *v_w, *v_n, *v_e, *v_s;
-      double *Sigma;
-      const double *E_ij;
+        *u_ij = u.get_column(i,     j),
+        *u_w  = u.get_column(i - 1, j),
+        *u_e  = u.get_column(i + 1, j),
+        *u_s  = u.get_column(i,     j - 1),
+        *u_n  = u.get_column(i,     j + 1);
+      const double
+        *v_ij = v.get_column(i,     j),
+        *v_w  = v.get_column(i - 1, j),
+        *v_e  = v.get_column(i + 1, j),
+        *v_s  = v.get_column(i,     j - 1),
+        *v_n  = v.get_column(i,     j + 1);
 
-      double west = 1, east = 1, south = 1, north = 1,
-        D_x = 0,                // 1/(dx), 1/(2dx), or 0
-        D_y = 0;                // 1/(dy), 1/(2dy), or 0
+      double *w_ij  = w.get_column(i, j);
+      double *Sigma = strain_heating.get_column(i, j);
 
-      // x-derivative
+      // Switch between second-order centered differences in the interior and
+      // first-order one-sided differences at ice margins.
+      double
+        west  = 1.0,
+        east  = 1.0,
+        south = 1.0,
+        north = 1.0;
       {
         if ((mask.icy(i,j) and mask.ice_free(i+1,j)) or (mask.ice_free(i,j) and mask.icy(i+1,j))) {
           east = 0;
@@ -482,89 +382,149 @@ void StressBalance::compute_volumetric_strain_heating(const Inputs &inputs) {
         if ((mask.icy(i,j) and mask.ice_free(i-1,j)) or (mask.ice_free(i,j) and mask.icy(i-1,j))) {
           west = 0;
         }
-
-        if (east + west > 0) {
-          D_x = 1.0 / (m_grid->dx() * (east + west));
-        } else {
-          D_x = 0.0;
-        }
-      }
-
-      // y-derivative
-      {
         if ((mask.icy(i,j) and mask.ice_free(i,j+1)) or (mask.ice_free(i,j) and mask.icy(i,j+1))) {
           north = 0;
         }
         if ((mask.icy(i,j) and mask.ice_free(i,j-1)) or (mask.ice_free(i,j) and mask.icy(i,j-1))) {
           south = 0;
         }
-
-        if (north + south > 0) {
-          D_y = 1.0 / (m_grid->dy() * (north + south));
-        } else {
-          D_y = 0.0;
-        }
       }
 
-      u_ij = u.get_column(i,     j);
-      u_w  = u.get_column(i - 1, j);
-      u_e  = u.get_column(i + 1, j);
-      u_s  = u.get_column(i,     j - 1);
-      u_n  = u.get_column(i,     j + 1);
+      // weights used to compute u_x + v_y in the vertical velocity computation
+      double
+        w_west  = west,
+        w_east  = east,
+        w_south = south,
+        w_north = north;
 
-      v_ij = v.get_column(i,     j);
-      v_w  = v.get_column(i - 1, j);
-      v_e  = v.get_column(i + 1, j);
-      v_s  = v.get_column(i,     j - 1);
-      v_n  = v.get_column(i,     j + 1);
+      // use basal velocity to determine FD direction ("upwind" when it's clear, centered when
+      // it's not)
+      if (use_upstream_fd) {
+        const double
+          uw = 0.5 * (u_w[0] + u_ij[0]),
+          ue = 0.5 * (u_ij[0] + u_e[0]),
+          vs = 0.5 * (v_s[0] + v_ij[0]),
+          vn = 0.5 * (v_ij[0] + v_n[0]);
 
-      E_ij = enthalpy->get_column(i, j);
-      Sigma = m_strain_heating.get_column(i, j);
+        if (uw > 0.0 and ue >= 0.0) {
+          w_east = 0.0;
+        } else if (uw <= 0.0 and ue < 0.0) {
+          w_west = 0.0;
+        }
 
-      for (int k = 0; k <= ks; ++k) {
-        depth[k] = H - z[k];
+        if (vs > 0.0 and vn >= 0.0) {
+          w_north = 0.0;
+        } else if (vs <= 0.0 and vn < 0.0) {
+          w_south = 0.0;
+        }
       }
 
-      // pressure added by the ice (i.e. pressure difference between the
-      // current level and the top of the column)
-      EC->pressure(depth, ks, pressure); // FIXME issue #15
+      const double
+        D_x   = east + west > 0 ? 1.0 / (dx * (east + west)) : 0.0,       // 1/(dx), 1/(2dx), or 0
+        D_y   = north + south > 0 ? 1.0 / (dy * (north + south)) : 0.0,   // 1/(dy), 1/(2dy), or 0
+        D_x_w = w_east + w_west > 0 ? 1.0 / (dx * (w_east + w_west)) : 0.0,
+        D_y_w = w_north + w_south > 0 ? 1.0 / (dy * (w_north + w_south)) : 0.0;
 
-      flow_law->hardness_n(E_ij, &pressure[0], ks + 1, &hardness[0]);
+      // Vertical velocity.
+      {
+        // compute u_x + v_y using a vectorizable loop
+        for (unsigned int k = 0; k < Mz; ++k) {
+          double
+            u_x = D_x_w * (w_west  * (u_ij[k] - u_w[k]) + w_east  * (u_e[k] - u_ij[k])),
+            v_y = D_y_w * (w_south * (v_ij[k] - v_s[k]) + w_north * (v_n[k] - v_ij[k]));
+          u_x_plus_v_y[k] = u_x + v_y;
+        }
 
-      for (int k = 0; k <= ks; ++k) {
-        double dz;
+        // at the base: include the basal melt rate
+        if (basal_melt_rate != NULL) {
+          w_ij[0] = - (*basal_melt_rate)(i,j);
+        } else {
+          w_ij[0] = 0.0;
+        }
 
-        double u_z = 0.0, v_z = 0.0,
-          u_x = D_x * (west  * (u_ij[k] - u_w[k]) + east  * (u_e[k] - u_ij[k])),
-          u_y = D_y * (south * (u_ij[k] - u_s[k]) + north * (u_n[k] - u_ij[k])),
-          v_x = D_x * (west  * (v_ij[k] - v_w[k]) + east  * (v_e[k] - v_ij[k])),
-          v_y = D_y * (south * (v_ij[k] - v_s[k]) + north * (v_n[k] - v_ij[k]));
+        // within the ice and above:
+        for (unsigned int k = 1; k < Mz; ++k) {
+          const double dz = z[k] - z[k-1];
 
-        if (k > 0) {
-          dz = z[k+1] - z[k-1];
-          u_z = (u_ij[k+1] - u_ij[k-1]) / dz;
-          v_z = (v_ij[k+1] - v_ij[k-1]) / dz;
-        } else {
-          // use one-sided differences for u_z and v_z on the bottom level
-          dz = z[1] - z[0];
-          u_z = (u_ij[1] - u_ij[0]) / dz;
-          v_z = (v_ij[1] - v_ij[0]) / dz;
+          w_ij[k] = w_ij[k - 1] - (0.5 * dz) * (u_x_plus_v_y[k] + u_x_plus_v_y[k - 1]);
         }
+      }
 
-        Sigma[k] = 2.0 * e_to_a_power * hardness[k] * pow(D2(u_x, u_y, u_z, v_x, v_y, v_z), exponent);
-      } // k-loop
+      // Strain heating. Uses the same columns of u and v (now in cache).
+      {
+        const double *E_ij = enthalpy->get_column(i, j);
+
+        for (int k = 0; k <= ks; ++k) {
+          depth[k] = H - z[k];
+        }
+
+        // pressure added by the ice (i.e. pressure difference between the
+        // current level and the top of the column)
+        EC->pressure(depth, ks, pressure); // FIXME issue #15
+
+        flow_law->hardness_n(E_ij, &pressure[0], ks + 1, &hardness[0]);
+
+        for (int k = 0; k <= ks; ++k) {
+          double dz;
+
+          double u_z = 0.0, v_z = 0.0,
+            u_x = D_x * (west  * (u_ij[k] - u_w[k]) + east  * (u_e[k] - u_ij[k])),
+            u_y = D_y * (south * (u_ij[k] - u_s[k]) + north * (u_n[k] - u_ij[k])),
+            v_x = D_x * (west  * (v_ij[k] - v_w[k]) + east  * (v_e[k] - v_ij[k])),
+            v_y = D_y * (south * (v_ij[k] - v_s[k]) + north * (v_n[k] - v_ij[k]));
+
+          if (k > 0) {
+            dz = z[k+1] - z[k-1];
+            u_z = (u_ij[k+1] - u_ij[k-1]) / dz;
+            v_z = (v_ij[k+1] - v_ij[k-1]) / dz;
+          } else {
+            // use one-sided differences for u_z and v_z on the bottom level
+            dz = z[1] - z[0];
+            u_z = (u_ij[1] - u_ij[0]) / dz;
+            v_z = (v_ij[1] - v_ij[0]) / dz;
+          }
+
+          Sigma[k] = 2.0 * e_to_a_power * hardness[k] * pow(D2(u_x, u_y, u_z, v_x, v_y, v_z), exponent);
+        } // k-loop
+
+        int remaining_levels = Mz - (ks + 1);
+        if (remaining_levels > 0) {
+          ierr = PetscMemzero(&Sigma[ks+1],
+                              remaining_levels*sizeof(double));
+          PISM_CHK(ierr, "PetscMemzero");
+        }
+      }
 
-      int remaining_levels = Mz - (ks + 1);
-      if (remaining_levels > 0) {
-        ierr = PetscMemzero(&Sigma[ks+1],
-                            remaining_levels*sizeof(double));
-        PISM_CHK(ierr, "PetscMemzero");
+      // Maximum speeds (only velocities under the surface).
+      if (mask.icy(i, j)) {
+        for (int k = 0; k <= ks; ++k) {
+          const double
+            u_abs = fabs(u_ij[k]),
+            v_abs = fabs(v_ij[k]);
+          u_max = std::max(u_max, u_abs);
+          v_max = std::max(v_max, v_abs);
+          w_max = std::max(w_max, fabs(w_ij[k]));
+
+          const double denom = u_abs / dx + v_abs / dy;
+          if (denom > 0.0) {
+            dt_max = std::min(dt_max, 1.0 / denom);
+          }
+        }
       }
     }
   } catch (...) {
     loop.failed();
   }
-  loop.check();
+  loop.check(reduction);
+
+  DeferredCFLData cfl;
+
+  cfl.u_max  = reduction.max(u_max);
+  cfl.v_max  = reduction.max(v_max);
+  cfl.w_max  = reduction.max(w_max);
+  cfl.dt_max = reduction.min(dt_max);
+
+  return cfl;
 }
 
 std::string StressBalance::stdout_report() const {
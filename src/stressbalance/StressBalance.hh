@@ -129,12 +129,12 @@ protected:
   virtual void define_model_state_impl(const PIO &output) const;
   virtual void write_model_state_impl(const PIO &output) const;
 
-  virtual void compute_vertical_velocity(const IceModelVec2CellType &mask,
-                                         const IceModelVec3 &u,
-                                         const IceModelVec3 &v,
-                                         const IceModelVec2S *bmr,
-                                         IceModelVec3 &result);
-  virtual void compute_volumetric_strain_heating(const Inputs &inputs);
+  virtual DeferredCFLData compute_vertical_velocity_and_strain_heating(const Inputs &inputs,
+                                                                       const IceModelVec3 &u,
+                                                                       const IceModelVec3 &v,
+                                                                       IceModelVec3 &w,
+                                                                       IceModelVec3 &strain_heating,
+                                                                       GlobalReduction &reduction);
 
   CFLData m_cfl_2d, m_cfl_3d;
 
@@ -17,6 +17,8 @@
 // Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <cassert>
+#include <algorithm>            // std::max, std::min
+#include <vector>
 
 #include "BedSmoother.hh"
 #include "pism/util/Mask.hh"
@@ -27,6 +29,7 @@
 #include "pism/util/error_handling.hh"
 #include "pism/util/pism_const.hh"
 #include "pism/util/Logger.hh"
+#include "pism/util/pism_utilities.hh"
 
 namespace pism {
 namespace stressbalance {
@@ -59,14 +62,6 @@ BedSmoother::BedSmoother(IceGrid::ConstPtr g, int MAX_GHOSTS)
     m_C4.set_attrs("bed_smoother_tool",
                  "polynomial coeff of H^-4, in bed roughness parameterization",
                  "m4", "");
-
-    // allocate Vecs that live on processor 0:
-    m_topgp0 = m_topgsmooth.allocate_proc0_copy();
-    m_topgsmoothp0 = m_topgsmooth.allocate_proc0_copy();
-    m_maxtlp0 = m_maxtl.allocate_proc0_copy();
-    m_C2p0 = m_C2.allocate_proc0_copy();
-    m_C3p0 = m_C3.allocate_proc0_copy();
-    m_C4p0 = m_C4.allocate_proc0_copy();
   }
 
   m_Glen_exponent = m_config->get_double("stress_balance.sia.Glen_exponent"); // choice is SIA; see #285
@@ -139,6 +134,46 @@ void BedSmoother::preprocess_bed(const IceModelVec2S &topg,
   m_Nx = Nx;
   m_Ny = Ny;
 
+  // The parallel implementation needs a halo of width max(Nx, Ny). PETSc requires that
+  // the stencil width does not exceed the size of any sub-domain.
+  const int
+    halo_width = std::max(m_Nx, m_Ny),
+    min_size   = static_cast<int>(GlobalMin(m_grid->com, std::min(m_grid->xm(), m_grid->ym())));
+
+  if (halo_width <= min_size) {
+    if (not m_topg_wide or (int)m_topg_wide->get_stencil_width() < halo_width) {
+      m_topg_wide.reset(new IceModelVec2S);
+      m_topg_wide->create(m_grid, "topg_wide", WITH_GHOSTS, halo_width);
+    }
+
+    // Subtract the minimum to reduce round-off in moments computed by smooth_the_bed().
+    // (Using the minimum makes results independent of the number of processors.)
+    const double topg_min = topg.range().min;
+
+    {
+      IceModelVec::AccessList list{&topg, m_topg_wide.get()};
+      for (Points p(*m_grid); p; p.next()) {
+        const int i = p.i(), j = p.j();
+        (*m_topg_wide)(i, j) = topg(i, j) - topg_min;
+      }
+    }
+    m_topg_wide->update_ghosts();
+
+    smooth_the_bed(topg_min);
+
+    return;
+  }
+
+  // Sub-domains are too small: gather the bed on processor 0 and smooth it there.
+  if (not m_topgp0) {
+    m_topgp0 = m_topgsmooth.allocate_proc0_copy();
+    m_topgsmoothp0 = m_topgsmooth.allocate_proc0_copy();
+    m_maxtlp0 = m_maxtl.allocate_proc0_copy();
+    m_C2p0 = m_C2.allocate_proc0_copy();
+    m_C3p0 = m_C3.allocate_proc0_copy();
+    m_C4p0 = m_C4.allocate_proc0_copy();
+  }
+
   topg.put_on_proc0(*m_topgp0);
   smooth_the_bed_on_proc0();
   // next call *does indeed* fill ghosts in topgsmooth
@@ -153,6 +188,118 @@ void BedSmoother::preprocess_bed(const IceModelVec2S &topg,
 }
 
 
+//! Computes the smoothed bed and coefficients of the roughness parameterization in parallel.
+/*!
+ * Computes the same quantities as smooth_the_bed_on_proc0() and
+ * compute_coefficients_on_proc0(), using local data and a halo of width
+ * max(Nx, Ny).
+ *
+ * The smoothing window is a rectangle (clipped at the edges of the domain), so
+ * sums over it are computed in two passes: over rows, then over columns. This
+ * costs O(Nx + Ny) instead of O(Nx * Ny) operations per grid point.
+ *
+ * Central moments \f$ \fint (b - \bar b)^k \f$, \f$ k = 2, 3, 4 \f$ are
+ * computed using moments \f$ \fint b^k \f$ about zero. To reduce round-off
+ * `m_topg_wide` stores the bed elevation minus its minimum `topg_min`.
+ */
+void BedSmoother::smooth_the_bed(double topg_min) {
+  const int
+    Mx = m_grid->Mx(),
+    My = m_grid->My(),
+    xs = m_grid->xs(),
+    xm = m_grid->xm(),
+    ys = m_grid->ys(),
+    ym = m_grid->ym();
+
+  // Sums over rows of the smoothing window: number of points, sums of b^k for k = 1,2,3,4,
+  // and the maximum.
+  struct RowSums {
+    double n, s1, s2, s3, s4, max;
+  };
+
+  // rows needed to compute sums for locally-owned points
+  const int
+    j_start = std::max(ys - m_Ny, 0),
+    j_end   = std::min(ys + ym + m_Ny, My);
+
+  std::vector<RowSums> rows(xm * (j_end - j_start));
+
+  const IceModelVec2S &b = *m_topg_wide;
+
+  IceModelVec::AccessList list{&b, &m_topgsmooth, &m_maxtl, &m_C2, &m_C3, &m_C4};
+
+  // first pass: sums over rows
+  for (int j = j_start; j < j_end; ++j) {
+    for (int i = xs; i < xs + xm; ++i) {
+      RowSums S = {0.0, 0.0, 0.0, 0.0, 0.0, b(i, j)};
+
+      // do not wrap periodically
+      for (int r = std::max(-m_Nx, -i); r <= std::min(m_Nx, Mx - 1 - i); ++r) {
+        const double
+          v  = b(i + r, j),
+          v2 = v * v;
+        S.n  += 1.0;
+        S.s1 += v;
+        S.s2 += v2;
+        S.s3 += v2 * v;
+        S.s4 += v2 * v2;
+        S.max = std::max(S.max, v);
+      }
+      rows[(j - j_start) * xm + (i - xs)] = S;
+    }
+  }
+
+  // scale the coeffs in Taylor series
+  const double
+    n  = m_Glen_exponent,
+    k  = (n + 2) / n,
+    s2 = k * (2 * n + 2) / (2 * n),
+    s3 = s2 * (3 * n + 2) / (3 * n),
+    s4 = s3 * (4 * n + 2) / (4 * n);
+
+  // second pass: sums over columns
+  for (Points p(*m_grid); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    const double nx = rows[(j - j_start) * xm + (i - xs)].n;
+    double ny = 0.0, S1 = 0.0, S2 = 0.0, S3 = 0.0, S4 = 0.0, max = b(i, j);
+
+    for (int s = std::max(-m_Ny, -j); s <= std::min(m_Ny, My - 1 - j); ++s) {
+      const RowSums &R = rows[(j + s - j_start) * xm + (i - xs)];
+      ny  += 1.0;
+      S1  += R.s1;
+      S2  += R.s2;
+      S3  += R.s3;
+      S4  += R.s4;
+      max  = std::max(max, R.max);
+    }
+
+    // the r=0,s=0 case guarantees count>=1
+    const double
+      count = nx * ny,
+      mean  = S1 / count,
+      M2    = S2 / count,
+      M3    = S3 / count,
+      M4    = S4 / count;
+
+    m_topgsmooth(i, j) = topg_min + mean;
+
+    // maximum elevation of local topography (relative to the smoothed bed), but not below zero
+    m_maxtl(i, j) = std::max(max - mean, 0.0);
+
+    // central moments
+    m_C2(i, j) = (M2 - mean * mean) * s2;
+    m_C3(i, j) = (M3 - mean * (3.0 * M2 - 2.0 * mean * mean)) * s3;
+    m_C4(i, j) = (M4 - mean * (4.0 * M3 - mean * (6.0 * M2 - 3.0 * mean * mean))) * s4;
+  }
+
+  m_topgsmooth.update_ghosts();
+  m_maxtl.update_ghosts();
+  m_C2.update_ghosts();
+  m_C3.update_ghosts();
+  m_C4.update_ghosts();
+}
+
 //! Computes the smoothed bed by a simple average over a rectangle of grid points.
 void BedSmoother::smooth_the_bed_on_proc0() {
 
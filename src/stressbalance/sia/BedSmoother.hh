@@ -106,6 +106,9 @@ protected:
 
   double m_Glen_exponent, m_smoothing_range;
 
+  //! bed elevation (relative to its minimum) with a halo of width max(Nx, Ny)
+  IceModelVec2S::Ptr m_topg_wide;
+
   petsc::Vec::Ptr m_topgp0,         //!< original bed elevation on processor 0
     m_topgsmoothp0,   //!< smoothed bed elevation on processor 0
     m_maxtlp0,        //!< maximum elevation at (i,j) of local topography (nearby patch)
@@ -114,6 +117,7 @@ protected:
   virtual void preprocess_bed(const IceModelVec2S &topg,
                               unsigned int Nx_in, unsigned int Ny_in);
 
+  void smooth_the_bed(double topg_min);
   void smooth_the_bed_on_proc0();
   void compute_coefficients_on_proc0();
 };
@@ -45,6 +45,7 @@ static char help[] =
 #include "pism/util/io/io_helpers.hh"
 #include "pism/util/pism_utilities.hh"
 #include "pism/util/IceModelVec2CellType.hh"
+#include "pism/util/BenchmarkReport.hh"
 
 namespace pism {
 
@@ -299,6 +300,8 @@ int main(int argc, char *argv[]) {
     }
 
     options::String output_file("-o", "Set the output file name", "siafd_test_F.nc");
+    options::String benchmark_output("-benchmark_output",
+                                     "JSON file to save SIA solver performance data to");
 
     GridParameters P(config);
     P.Lx = 900e3;
@@ -375,7 +378,7 @@ int main(int argc, char *argv[]) {
 
     // We use SIA_Nonsliding and not SIAFD here because we need the z-component
     // of the ice velocity, which is computed using incompressibility of ice in
-    // StressBalance::compute_vertical_velocity().
+    // StressBalance::compute_vertical_velocity_and_strain_heating().
     SIAFD *sia = new SIAFD(grid);
     ZeroSliding *no_sliding = new ZeroSliding(grid);
 
@@ -399,7 +402,22 @@ int main(int argc, char *argv[]) {
     stressbalance::Inputs inputs;
     inputs.sea_level             = 0.0;
     inputs.melange_back_pressure = &melange_back_pressure;
+
+    const double start_time = GetTime();
     stress_balance.update(inputs, full_update);
+    const double run_time = GetTime() - start_time;
+
+    if (benchmark_output.is_set()) {
+      BenchmarkReport report(com);
+      report.set_string("test", "F");
+      report.set_string("solver", "SIAFD");
+      report.set_number("Mx", grid->Mx());
+      report.set_number("My", grid->My());
+      report.set_number("Mz", grid->Mz());
+      report.set_timer("total_time", run_time);
+      report.set_memory_usage();
+      report.write(benchmark_output);
+    }
 
     // Report errors relative to the exact solution:
     const IceModelVec3
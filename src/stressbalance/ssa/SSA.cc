@@ -348,6 +348,18 @@ std::string SSA::stdout_report() const {
   return m_stdout_ssa;
 }
 
+SSAStatistics::SSAStatistics()
+  : nonlinear_iterations(0),
+    linear_iterations(0),
+    assembly_time(0.0),
+    solve_time(0.0) {
+  // empty
+}
+
+const SSAStatistics& SSA::statistics() const {
+  return m_statistics;
+}
+
 
 //! \brief Set the initial guess of the SSA velocity.
 void SSA::set_initial_guess(const IceModelVec2V &guess) {
@@ -76,6 +76,20 @@ private:
 class SSA;
 typedef SSA * (*SSAFactory)(IceGrid::ConstPtr);
 
+//! Performance counters of an SSA solver, accumulated over all solves.
+struct SSAStatistics {
+  SSAStatistics();
+
+  //! Picard (SSAFD) or Newton (SSAFEM) iterations
+  unsigned int nonlinear_iterations;
+  //! Krylov iterations
+  unsigned int linear_iterations;
+  //! local wall-clock time spent assembling matrices and residuals, in seconds
+  double assembly_time;
+  //! local wall-clock time spent in linear solvers, in seconds
+  double solve_time;
+};
+
 
 //! PISM's SSA solver.
 /*!
@@ -120,6 +134,8 @@ public:
 
   virtual std::string stdout_report() const;
 
+  const SSAStatistics& statistics() const;
+
   const IceModelVec2V& driving_stress() const;
 protected:
   virtual void define_model_state_impl(const PIO &output) const;
@@ -138,6 +154,8 @@ protected:
 
   std::string m_stdout_ssa;
 
+  SSAStatistics m_statistics;
+
   // objects used by the SSA solver (internally)
   petsc::DM::Ptr  m_da;               // dof=2 DA
   IceModelVec2V m_velocity_global; // global vector for solution
@@ -18,6 +18,7 @@
 
 #include <cassert>
 #include <stdexcept>
+#include <algorithm>            // std::max
 
 #include "SSAFD.hh"
 #include "SSAFD_diagnostics.hh"
@@ -32,6 +33,7 @@
 #include "pism/stressbalance/StressBalance.hh"
 #include "pism/geometry/Geometry.hh"
 #include "pism/util/pism_utilities.hh"
+#include "pism/util/pism_const.hh"
 
 namespace pism {
 namespace stressbalance {
@@ -96,6 +98,18 @@ SSAFD::SSAFD(IceGrid::ConstPtr g)
 
   m_scaling = 1.0e9;  // comparable to typical beta for an ice stream;
 
+  m_use_active_set = m_config->get_boolean("stress_balance.ssa.fd.active_set");
+  m_use_refinement = m_config->get_boolean("stress_balance.ssa.fd.iterative_refinement");
+
+  if (m_use_active_set) {
+    m_pinned_values.create(m_grid, "pinned_values", WITHOUT_GHOSTS);
+    m_pinned_values.set_attrs("internal",
+                              "known SSA velocity values at nodes fixed by Dirichlet B.C.",
+                              "m s-1", "");
+
+    m_b_active.create(m_grid, "right_hand_side_active", WITHOUT_GHOSTS);
+  }
+
   // The nuH viewer:
   m_view_nuh = false;
   m_nuh_viewer_size = 300;
@@ -123,6 +137,38 @@ SSAFD::SSAFD(IceGrid::ConstPtr g)
     // Use the initial residual norm.
     ierr = KSPConvergedDefaultSetUIRNorm(m_KSP);
     PISM_CHK(ierr, "KSPConvergedDefaultSetUIRNorm");
+
+    if (m_use_refinement) {
+      ierr = KSPCreate(m_grid->com, m_refinement_KSP.rawptr());
+      PISM_CHK(ierr, "KSPCreate");
+
+      ierr = KSPSetOptionsPrefix(m_refinement_KSP, "ssafd_refinement_");
+      PISM_CHK(ierr, "KSPSetOptionsPrefix");
+
+      PC pc;
+      ierr = KSPGetPC(m_refinement_KSP, &pc);
+      PISM_CHK(ierr, "KSPGetPC");
+
+      // This default can be overridden using command-line options (e.g.
+      // -ssafd_refinement_pc_type bjacobi).
+      ierr = PCSetType(pc, PCSHELL);
+      PISM_CHK(ierr, "PCSetType");
+
+      ierr = PCShellSetContext(pc, this);
+      PISM_CHK(ierr, "PCShellSetContext");
+
+      ierr = PCShellSetSetUp(pc, refinement_pc_setup_callback);
+      PISM_CHK(ierr, "PCShellSetSetUp");
+
+      ierr = PCShellSetApply(pc, refinement_pc_apply_callback);
+      PISM_CHK(ierr, "PCShellSetApply");
+
+      ierr = PCShellSetName(pc, "SSAFD single precision block Jacobi ILU(0)");
+      PISM_CHK(ierr, "PCShellSetName");
+
+      ierr = KSPSetFromOptions(m_refinement_KSP);
+      PISM_CHK(ierr, "KSPSetFromOptions");
+    }
   }
 }
 
@@ -138,7 +184,7 @@ void SSAFD::pc_setup_bjacobi() {
   ierr = KSPSetType(m_KSP, KSPGMRES);
   PISM_CHK(ierr, "KSPSetType");
 
-  ierr = KSPSetOperators(m_KSP, m_A, m_A);
+  ierr = KSPSetOperators(m_KSP, system_matrix(), system_matrix());
   PISM_CHK(ierr, "KSPSetOperators");
 
   // Get the PC from the KSP solver:
@@ -165,7 +211,7 @@ void SSAFD::pc_setup_asm() {
   ierr = KSPSetType(m_KSP, KSPGMRES);
   PISM_CHK(ierr, "KSPSetType");
 
-  ierr = KSPSetOperators(m_KSP, m_A, m_A);
+  ierr = KSPSetOperators(m_KSP, system_matrix(), system_matrix());
   PISM_CHK(ierr, "KSPSetOperators");
 
   // Switch to using the "unpreconditioned" norm.
@@ -225,6 +271,17 @@ void SSAFD::init_impl() {
                "  using PISM-PIK calving-front stress boundary condition ...\n");
   }
 
+  if (m_use_active_set) {
+    m_log->message(2,
+               "  restricting linear systems to nodes not fixed by Dirichlet B.C. ...\n");
+  }
+
+  if (m_use_refinement) {
+    m_log->message(2,
+               "  using mixed precision iterative refinement with inner KSP tolerance %.1e ...\n",
+               m_config->get_double("stress_balance.ssa.fd.iterative_refinement_rtol"));
+  }
+
   m_default_pc_failure_count     = 0;
   m_default_pc_failure_max_count = 5;
 }
@@ -846,6 +903,10 @@ void SSAFD::solve(const Inputs &inputs) {
   {
     assemble_rhs(inputs);
     compute_hardav_staggered(inputs);
+
+    if (m_use_active_set) {
+      update_active_set(inputs);
+    }
   }
 
   for (unsigned int k = 0; k < 3; ++k) {
@@ -928,10 +989,8 @@ void SSAFD::picard_iteration(const Inputs &inputs,
 void SSAFD::picard_manager(const Inputs &inputs,
                            double nuH_regularization,
                            double nuH_iter_failure_underrelax) {
-  PetscErrorCode ierr;
   double   nuH_norm, nuH_norm_change;
-  // ksp_iterations should be a PetscInt because it is used in the
-  // KSPGetIterationNumber() call below
+  // ksp_iterations should be a PetscInt because it is set by ksp_solve()
   PetscInt    ksp_iterations, ksp_iterations_total = 0, outer_iterations;
   KSPConvergedReason  reason;
 
@@ -967,7 +1026,9 @@ void SSAFD::picard_manager(const Inputs &inputs,
     m_nuH_old.copy_from(m_nuH);
 
     // assemble (or re-assemble) matrix, which depends on updated viscosity
+    double start_time = GetTime();
     assemble_matrix(inputs, true, m_A);
+    m_statistics.assembly_time += GetTime() - start_time;
 
     if (very_verbose) {
 
@@ -975,16 +1036,16 @@ void SSAFD::picard_manager(const Inputs &inputs,
     }
 
     // Call PETSc to solve linear system by iterative method; "inner iteration":
-    ierr = KSPSetOperators(m_KSP, m_A, m_A);
-    PISM_CHK(ierr, "KSPSetOperator");
-
-    ierr = KSPSolve(m_KSP, m_b.get_vec(), m_velocity_global.get_vec());
-    PISM_CHK(ierr, "KSPSolve");
+    start_time = GetTime();
+    if (m_use_active_set) {
+      solve_active_system(reason, ksp_iterations);
+    } else {
+      ksp_solve(m_A, m_b.get_vec(), m_velocity_global.get_vec(),
+                reason, ksp_iterations);
+    }
+    m_statistics.solve_time += GetTime() - start_time;
 
     // Check if diverged; report to standard out about iteration
-    ierr = KSPGetConvergedReason(m_KSP, &reason);
-    PISM_CHK(ierr, "KSPGetConvergedReason");
-
     if (reason < 0) {
       // KSP diverged
       m_log->message(1,
@@ -999,11 +1060,11 @@ void SSAFD::picard_manager(const Inputs &inputs,
     }
 
     // report on KSP success; the "inner" iteration is done
-    ierr = KSPGetIterationNumber(m_KSP, &ksp_iterations);
-    PISM_CHK(ierr, "KSPGetIterationNumber");
-
     ksp_iterations_total += ksp_iterations;
 
+    m_statistics.nonlinear_iterations += 1;
+    m_statistics.linear_iterations    += ksp_iterations;
+
     if (very_verbose) {
       snprintf(tempstr, 100, "S:%d,%d: ", (int)ksp_iterations, reason);
       m_stdout_ssa += tempstr;
@@ -1632,6 +1693,528 @@ bool SSAFD::is_marginal(int i, int j, bool ssa_dirichlet_bc) {
   }
 }
 
+//! \brief Solves `A x = b` using m_KSP, using `x` as the initial guess.
+/*!
+ * If iterative refinement is enabled, the system is solved by repeating
+ *
+ * 1. \f$ r = b - A x \f$ (in double precision),
+ * 2. approximately solve \f$ A d = r \f$ using m_refinement_KSP,
+ * 3. \f$ x = x + d \f$
+ *
+ * until \f$ |r| \le \max(\text{rtol}\, |r_0|, \text{atol}) \f$, where rtol
+ * and atol are tolerances of m_KSP (set using `-ssafd_ksp_rtol` and
+ * `-ssafd_ksp_atol`).
+ *
+ * Inner solves use the relative tolerance
+ * `stress_balance.ssa.fd.iterative_refinement_rtol` and a block Jacobi ILU(0)
+ * preconditioner that is factored, stored, and applied in single precision
+ * (see SinglePrecisionILU). Errors introduced by the low precision
+ * preconditioner are corrected by the outer iteration.
+ *
+ * If an inner solve fails this method falls back to solving the system using
+ * m_KSP alone.
+ *
+ * Sets `reason` to the converged reason of the last solve and `iterations` to
+ * the total number of Krylov iterations.
+ */
+void SSAFD::ksp_solve(Mat A, Vec b, Vec x,
+                      KSPConvergedReason &reason, PetscInt &iterations) {
+  PetscErrorCode ierr;
+
+  ierr = KSPSetOperators(m_KSP, A, A);
+  PISM_CHK(ierr, "KSPSetOperators");
+
+  if (not m_use_refinement) {
+    ierr = KSPSolve(m_KSP, b, x);
+    PISM_CHK(ierr, "KSPSolve");
+
+    ierr = KSPGetConvergedReason(m_KSP, &reason);
+    PISM_CHK(ierr, "KSPGetConvergedReason");
+
+    ierr = KSPGetIterationNumber(m_KSP, &iterations);
+    PISM_CHK(ierr, "KSPGetIterationNumber");
+
+    return;
+  }
+
+  const double inner_rtol = m_config->get_double("stress_balance.ssa.fd.iterative_refinement_rtol");
+  const int max_steps = static_cast<int>(m_config->get_double("stress_balance.ssa.fd.iterative_refinement_max_steps"));
+
+  PetscReal rtol, atol, dtol;
+  PetscInt max_it;
+  ierr = KSPGetTolerances(m_KSP, &rtol, &atol, &dtol, &max_it);
+  PISM_CHK(ierr, "KSPGetTolerances");
+
+  ierr = KSPSetTolerances(m_refinement_KSP, std::max(inner_rtol, (double)rtol),
+                          atol, dtol, max_it);
+  PISM_CHK(ierr, "KSPSetTolerances");
+
+  ierr = KSPSetOperators(m_refinement_KSP, A, A);
+  PISM_CHK(ierr, "KSPSetOperators");
+
+  // Work vectors are re-allocated only if the size of the system changed (for
+  // example after an update of the active set).
+  {
+    PetscInt N = 0, N_work = -1;
+    ierr = VecGetSize(b, &N);
+    PISM_CHK(ierr, "VecGetSize");
+
+    if (m_refinement_r.get() != NULL) {
+      ierr = VecGetSize(m_refinement_r, &N_work);
+      PISM_CHK(ierr, "VecGetSize");
+    }
+
+    if (N != N_work) {
+      ierr = VecDestroy(m_refinement_r.rawptr());
+      PISM_CHK(ierr, "VecDestroy");
+
+      ierr = VecDestroy(m_refinement_d.rawptr());
+      PISM_CHK(ierr, "VecDestroy");
+
+      ierr = VecDuplicate(b, m_refinement_r.rawptr());
+      PISM_CHK(ierr, "VecDuplicate");
+
+      ierr = VecDuplicate(b, m_refinement_d.rawptr());
+      PISM_CHK(ierr, "VecDuplicate");
+    }
+  }
+
+  Vec r = m_refinement_r, d = m_refinement_d;
+
+  // r = b - A x
+  ierr = MatMult(A, x, r);
+  PISM_CHK(ierr, "MatMult");
+
+  ierr = VecAYPX(r, -1.0, b);
+  PISM_CHK(ierr, "VecAYPX");
+
+  PetscReal r_norm = 0.0;
+  ierr = VecNorm(r, NORM_2, &r_norm);
+  PISM_CHK(ierr, "VecNorm");
+
+  const double target = std::max(rtol * r_norm, atol);
+
+  reason     = KSP_CONVERGED_RTOL;
+  iterations = 0;
+
+  int step = 0;
+  for (step = 0; step < max_steps and r_norm > target; ++step) {
+    // the correction is small, so zero is a good initial guess
+    ierr = VecSet(d, 0.0);
+    PISM_CHK(ierr, "VecSet");
+
+    ierr = KSPSolve(m_refinement_KSP, r, d);
+    PISM_CHK(ierr, "KSPSolve");
+
+    ierr = KSPGetConvergedReason(m_refinement_KSP, &reason);
+    PISM_CHK(ierr, "KSPGetConvergedReason");
+
+    PetscInt inner_iterations = 0;
+    ierr = KSPGetIterationNumber(m_refinement_KSP, &inner_iterations);
+    PISM_CHK(ierr, "KSPGetIterationNumber");
+    iterations += inner_iterations;
+
+    if (reason < 0) {
+      break;
+    }
+
+    ierr = VecAXPY(x, 1.0, d);
+    PISM_CHK(ierr, "VecAXPY");
+
+    ierr = MatMult(A, x, r);
+    PISM_CHK(ierr, "MatMult");
+
+    ierr = VecAYPX(r, -1.0, b);
+    PISM_CHK(ierr, "VecAYPX");
+
+    ierr = VecNorm(r, NORM_2, &r_norm);
+    PISM_CHK(ierr, "VecNorm");
+  }
+
+  if (reason < 0) {
+    m_log->message(3,
+                   "  SSAFD: inner solve failed (%s); solving in double precision...\n",
+                   KSPConvergedReasons[reason]);
+
+    ierr = KSPSolve(m_KSP, b, x);
+    PISM_CHK(ierr, "KSPSolve");
+
+    ierr = KSPGetConvergedReason(m_KSP, &reason);
+    PISM_CHK(ierr, "KSPGetConvergedReason");
+
+    PetscInt double_iterations = 0;
+    ierr = KSPGetIterationNumber(m_KSP, &double_iterations);
+    PISM_CHK(ierr, "KSPGetIterationNumber");
+    iterations += double_iterations;
+
+    return;
+  }
+
+  if (r_norm > target) {
+    // The Picard iteration tolerates inexact solves, so this is not an error.
+    m_log->message(3,
+                   "  SSAFD: iterative refinement stopped after %d steps;"
+                   " residual norm %e > %e\n", step, r_norm, target);
+  }
+}
+
+PetscErrorCode SSAFD::refinement_pc_setup_callback(PC pc) {
+  try {
+    void *ctx = NULL;
+    PetscErrorCode ierr = PCShellGetContext(pc, &ctx);
+    PISM_CHK(ierr, "PCShellGetContext");
+
+    Mat A = NULL, P = NULL;
+    ierr = PCGetOperators(pc, &A, &P);
+    PISM_CHK(ierr, "PCGetOperators");
+
+    static_cast<SSAFD*>(ctx)->m_refinement_pc.set_up(P);
+  } catch (...) {
+    MPI_Comm com = MPI_COMM_SELF;
+    PetscErrorCode ierr = PetscObjectGetComm((PetscObject)pc, &com); CHKERRQ(ierr);
+    handle_fatal_errors(com);
+    SETERRQ(com, 1, "A PISM callback failed");
+  }
+  return 0;
+}
+
+PetscErrorCode SSAFD::refinement_pc_apply_callback(PC pc, Vec x, Vec y) {
+  try {
+    void *ctx = NULL;
+    PetscErrorCode ierr = PCShellGetContext(pc, &ctx);
+    PISM_CHK(ierr, "PCShellGetContext");
+
+    static_cast<SSAFD*>(ctx)->m_refinement_pc.apply(x, y);
+  } catch (...) {
+    MPI_Comm com = MPI_COMM_SELF;
+    PetscErrorCode ierr = PetscObjectGetComm((PetscObject)pc, &com); CHKERRQ(ierr);
+    handle_fatal_errors(com);
+    SETERRQ(com, 1, "A PISM callback failed");
+  }
+  return 0;
+}
+
+//! Extract and factor the diagonal block of `A` owned by this processor.
+/*!
+ * Entries are converted to single precision *before* the factorization, so
+ * both the factorization and its application are done in single precision.
+ * This halves the memory traffic of the preconditioner compared to PETSc's
+ * (double precision) ILU(0).
+ */
+void SinglePrecisionILU::set_up(Mat A) {
+  PetscErrorCode ierr;
+
+  PetscInt row_start = 0, row_end = 0;
+  ierr = MatGetOwnershipRange(A, &row_start, &row_end);
+  PISM_CHK(ierr, "MatGetOwnershipRange");
+
+  const PetscInt n = row_end - row_start;
+
+  m_row_start.resize(n + 1);
+  m_diagonal.resize(n);
+  m_column.clear();
+  m_value.clear();
+  m_work.resize(n);
+
+  // Copy the diagonal block. Column indices returned by MatGetRow() are
+  // sorted.
+  m_row_start[0] = 0;
+  for (PetscInt k = 0; k < n; ++k) {
+    const PetscInt row = row_start + k;
+
+    PetscInt N = 0;
+    const PetscInt *columns = NULL;
+    const PetscScalar *values = NULL;
+    ierr = MatGetRow(A, row, &N, &columns, &values);
+    PISM_CHK(ierr, "MatGetRow");
+
+    m_diagonal[k] = -1;
+    for (PetscInt m = 0; m < N; ++m) {
+      if (columns[m] < row_start or columns[m] >= row_end) {
+        continue;
+      }
+      if (columns[m] == row) {
+        m_diagonal[k] = m_column.size();
+      }
+      m_column.push_back(columns[m] - row_start);
+      m_value.push_back(values[m]);
+    }
+
+    ierr = MatRestoreRow(A, row, &N, &columns, &values);
+    PISM_CHK(ierr, "MatRestoreRow");
+
+    if (m_diagonal[k] < 0) {
+      throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                    "row %d of the SSAFD matrix has no diagonal entry",
+                                    (int)row);
+    }
+
+    m_row_start[k + 1] = m_column.size();
+  }
+
+  // ILU(0) factorization (the IKJ variant)
+  std::vector<PetscInt> position(n, -1);
+  for (PetscInt i = 0; i < n; ++i) {
+    for (PetscInt p = m_row_start[i]; p < m_row_start[i + 1]; ++p) {
+      position[m_column[p]] = p;
+    }
+
+    for (PetscInt p = m_row_start[i]; p < m_diagonal[i]; ++p) {
+      const PetscInt k = m_column[p];
+      const float l = m_value[p] / m_value[m_diagonal[k]];
+      m_value[p] = l;
+
+      for (PetscInt q = m_diagonal[k] + 1; q < m_row_start[k + 1]; ++q) {
+        const PetscInt j = position[m_column[q]];
+        if (j >= 0) {
+          m_value[j] -= l * m_value[q];
+        }
+      }
+    }
+
+    for (PetscInt p = m_row_start[i]; p < m_row_start[i + 1]; ++p) {
+      position[m_column[p]] = -1;
+    }
+
+    if (m_value[m_diagonal[i]] == 0.0f) {
+      throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                    "zero pivot in row %d of the single precision ILU(0)",
+                                    (int)(row_start + i));
+    }
+  }
+}
+
+//! Compute `y = (LU)^{-1} x` using the single precision factorization.
+void SinglePrecisionILU::apply(Vec x, Vec y) {
+  const PetscInt n = m_diagonal.size();
+
+  {
+    const PetscScalar *X = NULL;
+    PetscErrorCode ierr = VecGetArrayRead(x, &X);
+    PISM_CHK(ierr, "VecGetArrayRead");
+
+    // forward substitution: L z = x
+    for (PetscInt i = 0; i < n; ++i) {
+      float sum = X[i];
+      for (PetscInt p = m_row_start[i]; p < m_diagonal[i]; ++p) {
+        sum -= m_value[p] * m_work[m_column[p]];
+      }
+      m_work[i] = sum;
+    }
+
+    ierr = VecRestoreArrayRead(x, &X);
+    PISM_CHK(ierr, "VecRestoreArrayRead");
+  }
+
+  // backward substitution: U w = z
+  for (PetscInt i = n - 1; i >= 0; --i) {
+    float sum = m_work[i];
+    for (PetscInt p = m_diagonal[i] + 1; p < m_row_start[i + 1]; ++p) {
+      sum -= m_value[p] * m_work[m_column[p]];
+    }
+    m_work[i] = sum / m_value[m_diagonal[i]];
+  }
+
+  petsc::VecArray y_array(y);
+  double *Y = y_array.get();
+  for (PetscInt i = 0; i < n; ++i) {
+    Y[i] = m_work[i];
+  }
+}
+
+//! Matrix of the linear system solved by m_KSP.
+Mat SSAFD::system_matrix() {
+  return m_use_active_set ? m_A_active : m_A;
+}
+
+//! Extract the sub-matrix of `A` corresponding to rows and columns in `is`.
+static void extract_submatrix(Mat A, IS is, MatReuse reuse, Mat *result) {
+  PetscErrorCode ierr;
+#if PETSC_VERSION_GE(3,8,0)
+  ierr = MatCreateSubMatrix(A, is, is, reuse, result);
+  PISM_CHK(ierr, "MatCreateSubMatrix");
+#else
+  ierr = MatGetSubMatrix(A, is, is, reuse, result);
+  PISM_CHK(ierr, "MatGetSubMatrix");
+#endif
+}
+
+//! \brief Splits degrees of freedom into "active" (unknown) and "pinned" (known) ones.
+/*!
+ * Rows of the SSAFD system corresponding to nodes where Dirichlet B.C. are
+ * prescribed (see `bc_mask`) and ice-free nodes when the calving front
+ * boundary condition is used contain one (diagonal) entry equal to
+ * m_scaling. Velocities at these nodes are known: they are equal to the
+ * corresponding entries of the right hand side divided by m_scaling.
+ *
+ * In regional and continental-scale runs most of these nodes are in the open
+ * ocean or on ice-free land, so we solve the system restricted to remaining
+ * ("active") degrees of freedom. This way the cost of Krylov iterations
+ * scales with the ice-covered area instead of the area of the domain.
+ *
+ * Requires an up-to-date right hand side (see assemble_rhs()). The logic
+ * determining pinned nodes has to match assemble_rhs() and assemble_matrix().
+ */
+void SSAFD::update_active_set(const Inputs &inputs) {
+  PetscErrorCode ierr;
+
+  const bool use_cfbc = m_config->get_boolean("stress_balance.calving_front_stress_bc");
+
+  // index of the first locally-owned row (in the PETSc ordering)
+  PetscInt row_start = 0;
+  ierr = VecGetOwnershipRange(m_b.get_vec(), &row_start, NULL);
+  PISM_CHK(ierr, "VecGetOwnershipRange");
+
+  const int
+    xs = m_grid->xs(),
+    xm = m_grid->xm(),
+    ys = m_grid->ys();
+
+  std::vector<PetscInt> active, pinned;
+  active.reserve(2 * xm * m_grid->ym());
+
+  IceModelVec::AccessList list{&m_b, &m_pinned_values};
+
+  if (inputs.bc_values && inputs.bc_mask) {
+    list.add(*inputs.bc_mask);
+  }
+
+  if (use_cfbc) {
+    list.add(m_mask);
+  }
+
+  // Note: Points iterates over locally-owned nodes in the same order as
+  // PETSc's DMDA ordering, so both index sets are sorted.
+  for (Points p(*m_grid); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    const bool known =
+      (inputs.bc_values != NULL and inputs.bc_mask->as_int(i, j) == 1) or
+      (use_cfbc and ice_free(m_mask.as_int(i, j)));
+
+    // row corresponding to the u component
+    const PetscInt row = row_start + 2 * ((j - ys) * xm + (i - xs));
+
+    if (known) {
+      m_pinned_values(i, j) = m_b(i, j) / m_scaling;
+      pinned.push_back(row);
+      pinned.push_back(row + 1);
+    } else {
+      m_pinned_values(i, j) = 0.0;
+      active.push_back(row);
+      active.push_back(row + 1);
+    }
+  }
+
+  const int changed = GlobalSum(m_grid->com, active != m_active_indices ? 1 : 0);
+
+  if (changed == 0 and m_A_active.get() != NULL) {
+    // The splitting did not change: re-use index sets and the reduced matrix.
+    return;
+  }
+
+  m_active_indices = active;
+
+  // The size of the system changed, so data stored in m_KSP is no longer valid.
+  ierr = KSPReset(m_KSP);
+  PISM_CHK(ierr, "KSPReset");
+
+  ierr = MatDestroy(m_A_active.rawptr());
+  PISM_CHK(ierr, "MatDestroy");
+
+  ierr = ISDestroy(m_active_set.rawptr());
+  PISM_CHK(ierr, "ISDestroy");
+
+  ierr = ISDestroy(m_pinned_set.rawptr());
+  PISM_CHK(ierr, "ISDestroy");
+
+  ierr = ISCreateGeneral(m_grid->com, active.size(), active.data(),
+                         PETSC_COPY_VALUES, m_active_set.rawptr());
+  PISM_CHK(ierr, "ISCreateGeneral");
+
+  ierr = ISCreateGeneral(m_grid->com, pinned.size(), pinned.data(),
+                         PETSC_COPY_VALUES, m_pinned_set.rawptr());
+  PISM_CHK(ierr, "ISCreateGeneral");
+
+  // m_A has the right non-zero structure even if it contains values from the
+  // previous solve
+  extract_submatrix(m_A, m_active_set, MAT_INITIAL_MATRIX, m_A_active.rawptr());
+
+  PetscInt N = 0;
+  ierr = ISGetSize(m_active_set, &N);
+  PISM_CHK(ierr, "ISGetSize");
+
+  m_log->message(3,
+                 "  SSAFD: solving for %d out of %d degrees of freedom\n",
+                 (int)N, (int)(2 * m_grid->Mx() * m_grid->My()));
+}
+
+//! \brief Solves the SSAFD system restricted to active degrees of freedom.
+/*!
+ * Uses the matrix assembled by assemble_matrix(), the right hand side from
+ * assemble_rhs(), and splitting computed by update_active_set().
+ *
+ * Uses m_velocity_global as the initial guess and stores the solution there.
+ */
+void SSAFD::solve_active_system(KSPConvergedReason &reason, PetscInt &iterations) {
+  PetscErrorCode ierr;
+
+  extract_submatrix(m_A, m_active_set, MAT_REUSE_MATRIX, m_A_active.rawptr());
+
+  // Move known values to the right hand side: b_active = b - A * x_pinned.
+  ierr = MatMult(m_A, m_pinned_values.get_vec(), m_b_active.get_vec());
+  PISM_CHK(ierr, "MatMult");
+
+  ierr = VecAYPX(m_b_active.get_vec(), -1.0, m_b.get_vec());
+  PISM_CHK(ierr, "VecAYPX");
+
+  // solve for unknown values
+  {
+    Vec b = NULL, x = NULL;
+
+    ierr = VecGetSubVector(m_b_active.get_vec(), m_active_set, &b);
+    PISM_CHK(ierr, "VecGetSubVector");
+
+    ierr = VecGetSubVector(m_velocity_global.get_vec(), m_active_set, &x);
+    PISM_CHK(ierr, "VecGetSubVector");
+
+    // Note: sub-vectors have to be restored even if the solver fails.
+    try {
+      ksp_solve(m_A_active, b, x, reason, iterations);
+    } catch (...) {
+      VecRestoreSubVector(m_velocity_global.get_vec(), m_active_set, &x);
+      VecRestoreSubVector(m_b_active.get_vec(), m_active_set, &b);
+      throw;
+    }
+
+    ierr = VecRestoreSubVector(m_velocity_global.get_vec(), m_active_set, &x);
+    PISM_CHK(ierr, "VecRestoreSubVector");
+
+    ierr = VecRestoreSubVector(m_b_active.get_vec(), m_active_set, &b);
+    PISM_CHK(ierr, "VecRestoreSubVector");
+  }
+
+  // copy known values
+  {
+    Vec x = NULL, x_pinned = NULL;
+
+    ierr = VecGetSubVector(m_velocity_global.get_vec(), m_pinned_set, &x);
+    PISM_CHK(ierr, "VecGetSubVector");
+
+    ierr = VecGetSubVector(m_pinned_values.get_vec(), m_pinned_set, &x_pinned);
+    PISM_CHK(ierr, "VecGetSubVector");
+
+    ierr = VecCopy(x_pinned, x);
+    PISM_CHK(ierr, "VecCopy");
+
+    ierr = VecRestoreSubVector(m_pinned_values.get_vec(), m_pinned_set, &x_pinned);
+    PISM_CHK(ierr, "VecRestoreSubVector");
+
+    ierr = VecRestoreSubVector(m_velocity_global.get_vec(), m_pinned_set, &x);
+    PISM_CHK(ierr, "VecRestoreSubVector");
+  }
+}
+
 void SSAFD::write_system_petsc(const std::string &namepart) {
   PetscErrorCode ierr;
 
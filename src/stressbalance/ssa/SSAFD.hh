@@ -19,16 +19,39 @@
 #ifndef _SSAFD_H_
 #define _SSAFD_H_
 
+#include <vector>
+
 #include "SSA.hh"
 
 #include "pism/util/error_handling.hh"
 #include "pism/util/petscwrappers/Viewer.hh"
 #include "pism/util/petscwrappers/KSP.hh"
 #include "pism/util/petscwrappers/Mat.hh"
+#include "pism/util/petscwrappers/IS.hh"
+#include "pism/util/petscwrappers/Vec.hh"
 
 namespace pism {
 namespace stressbalance {
 
+//! Block Jacobi ILU(0) preconditioner stored and applied in single precision.
+/*!
+ * Used by SSAFD to precondition inner solves of the iterative refinement
+ * (see SSAFD::ksp_solve()).
+ */
+class SinglePrecisionILU {
+public:
+  void set_up(Mat A);
+  void apply(Vec x, Vec y);
+private:
+  //! CSR storage of the factored diagonal block: row pointers, column indices
+  //! and positions of diagonal entries (all local)
+  std::vector<PetscInt> m_row_start, m_column, m_diagonal;
+  //! entries of L (excluding the unit diagonal) and U
+  std::vector<float> m_value;
+  //! work space used by apply()
+  std::vector<float> m_work;
+};
+
 //! PISM's SSA solver: the finite difference implementation.
 class SSAFD : public SSA
 {
@@ -87,6 +110,18 @@ protected:
 
   virtual void fracture_induced_softening(const IceModelVec2S *fracture_density);
 
+  virtual void update_active_set(const Inputs &inputs);
+
+  virtual void solve_active_system(KSPConvergedReason &reason, PetscInt &iterations);
+
+  virtual void ksp_solve(Mat A, Vec b, Vec x,
+                         KSPConvergedReason &reason, PetscInt &iterations);
+
+  static PetscErrorCode refinement_pc_setup_callback(PC pc);
+  static PetscErrorCode refinement_pc_apply_callback(PC pc, Vec x, Vec y);
+
+  Mat system_matrix();
+
   // objects used internally
   IceModelVec2Stag m_hardness, m_nuH, m_nuH_old;
   IceModelVec2 m_work;
@@ -95,6 +130,32 @@ protected:
   IceModelVec2V m_b;            // right hand side
   double m_scaling;
 
+  //! true if linear systems are restricted to degrees of freedom not fixed by
+  //! Dirichlet B.C. (see update_active_set())
+  bool m_use_active_set;
+  //! indices of "active" (unknown) degrees of freedom
+  petsc::IS m_active_set;
+  //! indices of degrees of freedom with known values
+  petsc::IS m_pinned_set;
+  //! local part of m_active_set (used to detect changes)
+  std::vector<PetscInt> m_active_indices;
+  //! the system matrix restricted to active degrees of freedom
+  petsc::Mat m_A_active;
+  //! known velocity values at pinned nodes (zero elsewhere)
+  IceModelVec2V m_pinned_values;
+  //! right hand side corrected using known velocity values
+  IceModelVec2V m_b_active;
+
+  //! true if linear systems are solved using iterative refinement with
+  //! low-accuracy inner Krylov solves (see ksp_solve())
+  bool m_use_refinement;
+  //! solver used for inner solves of the iterative refinement
+  petsc::KSP m_refinement_KSP;
+  //! single precision preconditioner of m_refinement_KSP
+  SinglePrecisionILU m_refinement_pc;
+  //! residual and correction used by the iterative refinement
+  petsc::Vec m_refinement_r, m_refinement_d;
+
   IceModelVec2V m_velocity_old;
 
   unsigned int m_default_pc_failure_count,
@@ -24,6 +24,7 @@
 #include "pism/rheology/FlowLaw.hh"
 #include "pism/util/pism_options.hh"
 #include "pism/util/error_handling.hh"
+#include "pism/util/pism_const.hh"
 #include "pism/util/Vars.hh"
 #include "pism/stressbalance/StressBalance.hh"
 #include "pism/geometry/Geometry.hh"
@@ -71,13 +72,25 @@ SSAFEM::SSAFEM(IceGrid::ConstPtr g)
                                   &m_callback_data);
   PISM_CHK(ierr, "DMDASNESSetFunctionLocal");
 
-  ierr = DMDASNESSetJacobianLocal(*m_da,
-                                  (DMDASNESJacobian)jacobian_callback,
-                                  &m_callback_data);
-  PISM_CHK(ierr, "DMDASNESSetJacobianLocal");
+  m_matrix_free = m_config->get_boolean("stress_balance.ssa.fem.matrix_free");
+  m_mf_jacobi_damping = m_config->get_double("stress_balance.ssa.fem.matrix_free_jacobi_damping");
+  m_mf_n_smoothing_steps = (int)m_config->get_double("stress_balance.ssa.fem.matrix_free_smoothing_steps");
 
-  ierr = DMSetMatType(*m_da, "baij");
-  PISM_CHK(ierr, "DMSetMatType");
+  if (m_mf_n_smoothing_steps < 1) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "stress_balance.ssa.fem.matrix_free_smoothing_steps = %d is invalid"
+                                  " (has to be at least 1)", m_mf_n_smoothing_steps);
+  }
+
+  if (not m_matrix_free) {
+    ierr = DMDASNESSetJacobianLocal(*m_da,
+                                    (DMDASNESJacobian)jacobian_callback,
+                                    &m_callback_data);
+    PISM_CHK(ierr, "DMDASNESSetJacobianLocal");
+
+    ierr = DMSetMatType(*m_da, "baij");
+    PISM_CHK(ierr, "DMSetMatType");
+  }
 
   ierr = DMSetApplicationContext(*m_da, &m_callback_data);
   PISM_CHK(ierr, "DMSetApplicationContext");
@@ -85,6 +98,37 @@ SSAFEM::SSAFEM(IceGrid::ConstPtr g)
   ierr = SNESSetDM(m_snes, *m_da);
   PISM_CHK(ierr, "SNESSetDM");
 
+  if (m_matrix_free) {
+    mf_allocate();
+
+    // The Jacobian is never assembled: SNES calls mf_jacobian_callback() to record the
+    // linearization point and set up the preconditioner.
+    ierr = SNESSetJacobian(m_snes, m_mf_jacobian, m_mf_jacobian,
+                           mf_jacobian_callback, this);
+    PISM_CHK(ierr, "SNESSetJacobian");
+
+    KSP ksp;
+    ierr = SNESGetKSP(m_snes, &ksp);
+    PISM_CHK(ierr, "SNESGetKSP");
+
+    PC pc;
+    ierr = KSPGetPC(ksp, &pc);
+    PISM_CHK(ierr, "KSPGetPC");
+
+    // This default can be overridden using command-line options (e.g. -pc_type jacobi).
+    ierr = PCSetType(pc, PCSHELL);
+    PISM_CHK(ierr, "PCSetType");
+
+    ierr = PCShellSetContext(pc, this);
+    PISM_CHK(ierr, "PCShellSetContext");
+
+    ierr = PCShellSetApply(pc, mf_precondition_callback);
+    PISM_CHK(ierr, "PCShellSetApply");
+
+    ierr = PCShellSetName(pc, "SSAFEM two-level multigrid");
+    PISM_CHK(ierr, "PCShellSetName");
+  }
+
   // Default of maximum 200 iterations; possibly overridden by command line options
   int snes_max_it = 200;
   ierr = SNESSetTolerances(m_snes, PETSC_DEFAULT, PETSC_DEFAULT, PETSC_DEFAULT,
@@ -133,6 +177,11 @@ void SSAFEM::init_impl() {
   m_log->message(2,
                  "  [using the SNES-based finite element method implementation]\n");
 
+  if (m_matrix_free) {
+    m_log->message(2,
+                   "  [using the matrix-free Jacobian and the two-level multigrid preconditioner]\n");
+  }
+
   // process command-line options
   {
     m_dirichletScale = 1.0e9;
@@ -215,9 +264,28 @@ TerminationReason::Ptr SSAFEM::solve_nocache() {
   }
 
   // Solve:
+  const double
+    assembly_time = m_statistics.assembly_time,
+    start_time    = GetTime();
+
   ierr = SNESSolve(m_snes, NULL, m_velocity_global.get_vec());
   PISM_CHK(ierr, "SNESSolve");
 
+  // residual and Jacobian evaluations are counted as "assembly"; everything else is "solve"
+  m_statistics.solve_time += (GetTime() - start_time) - (m_statistics.assembly_time - assembly_time);
+
+  {
+    PetscInt nonlinear_iterations = 0, linear_iterations = 0;
+    ierr = SNESGetIterationNumber(m_snes, &nonlinear_iterations);
+    PISM_CHK(ierr, "SNESGetIterationNumber");
+
+    ierr = SNESGetLinearSolveIterations(m_snes, &linear_iterations);
+    PISM_CHK(ierr, "SNESGetLinearSolveIterations");
+
+    m_statistics.nonlinear_iterations += nonlinear_iterations;
+    m_statistics.linear_iterations    += linear_iterations;
+  }
+
   // See if it worked.
   SNESConvergedReason snes_reason;
   ierr = SNESGetConvergedReason(m_snes, &snes_reason); PISM_CHK(ierr, "SNESGetConvergedReason");
@@ -881,6 +949,116 @@ void SSAFEM::monitor_function(Vector2 const *const *const velocity_global,
 }
 
 
+//! Compute the element-local Jacobian.
+/*!
+  Computes the (2*Nk)*(2*Nk) element-local Jacobian `K` (row-major) given nodal values of
+  coefficients and the velocity at which the Jacobian is evaluated. Velocity values at Dirichlet
+  nodes should be set to prescribed values by the caller. `i, j` identify the element (used in
+  diagnostic messages only).
+*/
+void SSAFEM::element_jacobian(int i, int j,
+                              const Coefficients *coefficients,
+                              const Vector2 *velocity,
+                              double K[2 * fem::q1::n_chi][2 * fem::q1::n_chi]) {
+
+  const unsigned int Nk     = fem::q1::n_chi;
+  const unsigned int Nq_max = fem::MAX_QUADRATURE_SIZE;
+
+  fem::Quadrature &Q = m_quadrature;
+
+  // Number of quadrature points.
+  const unsigned int Nq = Q.n();
+
+  // Jacobian times weights for quadrature.
+  const double* W = Q.weights();
+
+  // Values of the finite element test functions at the quadrature points.
+  // This is an Nq by Nk array of function germs
+  const fem::Germs *test = Q.test_function_values();
+
+  int    mask[Nq_max];
+  double thickness[Nq_max];
+  double tauc[Nq_max];
+  double hardness[Nq_max];
+
+  quad_point_values(Q, coefficients,
+                    mask, thickness, tauc, hardness);
+
+  // Storage for the current solution at quadrature points.
+  Vector2 U[Nq_max], U_x[Nq_max], U_y[Nq_max];
+
+  // Compute the values of the solution at the quadrature points.
+  quadrature_point_values(Q, velocity, U, U_x, U_y);
+
+  // Build the element-local Jacobian.
+  PetscErrorCode ierr = PetscMemzero(K, sizeof(double) * (2 * Nk) * (2 * Nk));
+  PISM_CHK(ierr, "PetscMemzero");
+
+  for (unsigned int q = 0; q < Nq; q++) {
+    const double
+      jw           = W[q],
+      u            = U[q].u,
+      v            = U[q].v,
+      u_x          = U_x[q].u,
+      v_y          = U_y[q].v,
+      u_y_plus_v_x = U_y[q].u + U_x[q].v;
+
+    double eta = 0.0, deta = 0.0, beta = 0.0, dbeta = 0.0;
+    PointwiseNuHAndBeta(thickness[q], hardness[q], mask[q], tauc[q],
+                        U[q], U_x[q], U_y[q],
+                        &eta, &deta, &beta, &dbeta);
+
+    for (unsigned int l = 0; l < Nk; l++) { // Trial functions
+
+      // Current trial function and its derivatives:
+      const fem::Germ &phi = test[q][l];
+
+      // Derivatives of \gamma with respect to u_l and v_l:
+      const double
+        gamma_u = (2.0 * u_x + v_y) * phi.dx + 0.5 * u_y_plus_v_x * phi.dy,
+        gamma_v = 0.5 * u_y_plus_v_x * phi.dx + (u_x + 2.0 * v_y) * phi.dy;
+
+      // Derivatives of \eta = \nu*H with respect to u_l and v_l:
+      const double
+        eta_u = deta * gamma_u,
+        eta_v = deta * gamma_v;
+
+      // Derivatives of the basal shear stress term (\tau_b):
+      const double
+        taub_xu = -dbeta * u * u * phi.val - beta * phi.val,  // x-component, derivative with respect to u_l
+        taub_xv = -dbeta * u * v * phi.val,                   // x-component, derivative with respect to u_l
+        taub_yu = -dbeta * v * u * phi.val,                   // y-component, derivative with respect to v_l
+        taub_yv = -dbeta * v * v * phi.val - beta * phi.val;  // y-component, derivative with respect to v_l
+
+      for (unsigned int k = 0; k < Nk; k++) {   // Test functions
+
+        // Current test function and its derivatives:
+
+        const fem::Germ &psi = test[q][k];
+
+        if (eta == 0) {
+          ierr = PetscPrintf(PETSC_COMM_SELF, "eta=0 i %d j %d q %d k %d\n", i, j, q, k);
+          PISM_CHK(ierr, "PetscPrintf");
+        }
+
+        // u-u coupling
+        K[k*2 + 0][l*2 + 0] += jw * (eta_u * (psi.dx * (4 * u_x + 2 * v_y) + psi.dy * u_y_plus_v_x)
+                                     + eta * (4 * psi.dx * phi.dx + psi.dy * phi.dy) - psi.val * taub_xu);
+        // u-v coupling
+        K[k*2 + 0][l*2 + 1] += jw * (eta_v * (psi.dx * (4 * u_x + 2 * v_y) + psi.dy * u_y_plus_v_x)
+                                     + eta * (2 * psi.dx * phi.dy + psi.dy * phi.dx) - psi.val * taub_xv);
+        // v-u coupling
+        K[k*2 + 1][l*2 + 0] += jw * (eta_u * (psi.dx * u_y_plus_v_x + psi.dy * (2 * u_x + 4 * v_y))
+                                     + eta * (psi.dx * phi.dy + 2 * psi.dy * phi.dx) - psi.val * taub_yu);
+        // v-v coupling
+        K[k*2 + 1][l*2 + 1] += jw * (eta_v * (psi.dx * u_y_plus_v_x + psi.dy * (2 * u_x + 4 * v_y))
+                                     + eta * (psi.dx * phi.dx + 4 * psi.dy * phi.dy) - psi.val * taub_yv);
+
+      } // l
+    } // k
+  } // q
+}
+
 //! Implements the callback for computing the Jacobian.
 /*!
   Compute the Jacobian
@@ -893,8 +1071,7 @@ void SSAFEM::monitor_function(Vector2 const *const *const velocity_global,
 */
 void SSAFEM::compute_local_jacobian(Vector2 const *const *const velocity_global, Mat Jac) {
 
-  const unsigned int Nk     = fem::q1::n_chi;
-  const unsigned int Nq_max = fem::MAX_QUADRATURE_SIZE;
+  const unsigned int Nk = fem::q1::n_chi;
 
   const bool use_cfbc = m_config->get_boolean("stress_balance.calving_front_stress_bc");
 
@@ -907,9 +1084,6 @@ void SSAFEM::compute_local_jacobian(Vector2 const *const *const velocity_global,
   // Start access to Dirichlet data if present.
   fem::DirichletData_Vector dirichlet_data(m_bc_mask, m_bc_values, m_dirichletScale);
 
-  // Storage for the current solution at quadrature points.
-  Vector2 U[Nq_max], U_x[Nq_max], U_y[Nq_max];
-
   // Loop through all the elements.
   int
     xs = m_element_index.xs,
@@ -937,118 +1111,27 @@ void SSAFEM::compute_local_jacobian(Vector2 const *const *const velocity_global,
           continue;
         }
 
-        fem::Quadrature &Q = m_quadrature;
-
-        // Number of quadrature points.
-        const unsigned int Nq = Q.n();
-
-        // Jacobian times weights for quadrature.
-        const double* W = Q.weights();
-
-        // Values of the finite element test functions at the quadrature points.
-        // This is an Nq by Nk array of function germs
-        const fem::Germs *test = Q.test_function_values();
-
-        int    mask[Nq_max];
-        double thickness[Nq_max];
-        double tauc[Nq_max];
-        double hardness[Nq_max];
-
-        {
-          Coefficients coeffs[Nk];
-          m_element.nodal_values(m_coefficients, coeffs);
+        Coefficients coeffs[Nk];
+        m_element.nodal_values(m_coefficients, coeffs);
 
-          quad_point_values(Q, coeffs,
-                            mask, thickness, tauc, hardness);
-        }
+        // Values of the solution at the nodes of the current element.
+        Vector2 velocity_nodal[Nk];
+        // Obtain the value of the solution at the adjacent nodes to the element.
+        m_element.nodal_values(velocity_global, velocity_nodal);
 
-        {
-          // Values of the solution at the nodes of the current element.
-          Vector2 velocity_nodal[Nk];
-          // Obtain the value of the solution at the adjacent nodes to the element.
-          m_element.nodal_values(velocity_global, velocity_nodal);
-
-          // These values now need to be adjusted if some nodes in the element have
-          // Dirichlet data.
-          if (dirichlet_data) {
-            dirichlet_data.enforce(m_element, velocity_nodal);
-            dirichlet_data.constrain(m_element);
-          }
-          // Compute the values of the solution at the quadrature points.
-          quadrature_point_values(Q, velocity_nodal, U, U_x, U_y);
+        // These values now need to be adjusted if some nodes in the element have
+        // Dirichlet data.
+        if (dirichlet_data) {
+          dirichlet_data.enforce(m_element, velocity_nodal);
+          dirichlet_data.constrain(m_element);
         }
 
         // Element-local Jacobian matrix (there are Nk vector valued degrees
         // of freedom per element, for a total of (2*Nk)*(2*Nk) = 16
         // entries in the local Jacobian.
         double K[2*Nk][2*Nk];
-        // Build the element-local Jacobian.
-        ierr = PetscMemzero(K, sizeof(K));
-        PISM_CHK(ierr, "PetscMemzero");
-
-        for (unsigned int q = 0; q < Nq; q++) {
-          const double
-            jw           = W[q],
-            u            = U[q].u,
-            v            = U[q].v,
-            u_x          = U_x[q].u,
-            v_y          = U_y[q].v,
-            u_y_plus_v_x = U_y[q].u + U_x[q].v;
-
-          double eta = 0.0, deta = 0.0, beta = 0.0, dbeta = 0.0;
-          PointwiseNuHAndBeta(thickness[q], hardness[q], mask[q], tauc[q],
-                              U[q], U_x[q], U_y[q],
-                              &eta, &deta, &beta, &dbeta);
-
-          for (unsigned int l = 0; l < Nk; l++) { // Trial functions
+        element_jacobian(i, j, coeffs, velocity_nodal, K);
 
-            // Current trial function and its derivatives:
-            const fem::Germ &phi = test[q][l];
-
-            // Derivatives of \gamma with respect to u_l and v_l:
-            const double
-              gamma_u = (2.0 * u_x + v_y) * phi.dx + 0.5 * u_y_plus_v_x * phi.dy,
-              gamma_v = 0.5 * u_y_plus_v_x * phi.dx + (u_x + 2.0 * v_y) * phi.dy;
-
-            // Derivatives of \eta = \nu*H with respect to u_l and v_l:
-            const double
-              eta_u = deta * gamma_u,
-              eta_v = deta * gamma_v;
-
-            // Derivatives of the basal shear stress term (\tau_b):
-            const double
-              taub_xu = -dbeta * u * u * phi.val - beta * phi.val,  // x-component, derivative with respect to u_l
-              taub_xv = -dbeta * u * v * phi.val,                   // x-component, derivative with respect to u_l
-              taub_yu = -dbeta * v * u * phi.val,                   // y-component, derivative with respect to v_l
-              taub_yv = -dbeta * v * v * phi.val - beta * phi.val;  // y-component, derivative with respect to v_l
-
-            for (unsigned int k = 0; k < Nk; k++) {   // Test functions
-
-              // Current test function and its derivatives:
-
-              const fem::Germ &psi = test[q][k];
-
-              if (eta == 0) {
-                ierr = PetscPrintf(PETSC_COMM_SELF, "eta=0 i %d j %d q %d k %d\n", i, j, q, k);
-                PISM_CHK(ierr, "PetscPrintf");
-              }
-
-              // u-u coupling
-              K[k*2 + 0][l*2 + 0] += jw * (eta_u * (psi.dx * (4 * u_x + 2 * v_y) + psi.dy * u_y_plus_v_x)
-                                           + eta * (4 * psi.dx * phi.dx + psi.dy * phi.dy) - psi.val * taub_xu);
-              // u-v coupling
-              K[k*2 + 0][l*2 + 1] += jw * (eta_v * (psi.dx * (4 * u_x + 2 * v_y) + psi.dy * u_y_plus_v_x)
-                                           + eta * (2 * psi.dx * phi.dy + psi.dy * phi.dx) - psi.val * taub_xv);
-              // v-u coupling
-              K[k*2 + 1][l*2 + 0] += jw * (eta_u * (psi.dx * u_y_plus_v_x + psi.dy * (2 * u_x + 4 * v_y))
-                                           + eta * (psi.dx * phi.dy + 2 * psi.dy * phi.dx) - psi.val * taub_yu);
-              // v-v coupling
-              K[k*2 + 1][l*2 + 1] += jw * (eta_v * (psi.dx * u_y_plus_v_x + psi.dy * (2 * u_x + 4 * v_y))
-                                           + eta * (psi.dx * phi.dx + 4 * psi.dy * phi.dy) - psi.val * taub_yv);
-
-            } // l
-          } // k
-        } // q
         m_element.add_contribution(&K[0][0], Jac);
       } // j
     } // i
@@ -1132,6 +1215,690 @@ void SSAFEM::monitor_jacobian(Mat Jac) {
   PISM_CHK(ierr, "PetscViewerPopFormat");
 }
 
+/** @name Matrix-free Newton steps
+
+   In the matrix-free mode (`stress_balance.ssa.fem.matrix_free`) the fine-grid Jacobian is never
+   assembled. Instead
+
+   - the Jacobian action is computed element by element using cached coefficients
+     (m_coefficients) and the current Newton iterate (m_mf_linearization_point),
+
+   - the Newton step is preconditioned using one V-cycle of a two-level geometric multigrid
+     method: damped Jacobi smoothing on the fine grid and a coarse grid correction on the grid
+     coarsened by the factor of 2 in each direction. The damping parameter and the number of
+     sweeps are set by `stress_balance.ssa.fem.matrix_free_jacobi_damping` and
+     `stress_balance.ssa.fem.matrix_free_smoothing_steps`.
+
+   The coarse grid operator is the Galerkin product @f$ P^T J P @f$, where @f$ P @f$ is the
+   bilinear interpolation from the coarse grid to the fine grid. Because each fine element is
+   contained in exactly one coarse element, this product can be computed one element at a time
+   without assembling @f$ J @f$. This is the only assembled matrix, and it has 1/4 of the rows of
+   @f$ J @f$.
+
+   The coarse problem is solved using a KSP with the prefix `-ssafem_coarse_` (one application of
+   PETSc's algebraic multigrid by default).
+*/
+///@{
+
+//! Round `n/2` down (towards negative infinity).
+static inline int floor_half(int n) {
+  return n >= 0 ? n / 2 : - ((1 - n) / 2);
+}
+
+//! Compute coarse grid indices and interpolation weights corresponding to fine grid index `n`.
+/*!
+  The fine grid node `n` is at the same location as the coarse grid node `n/2` if `n` is even and
+  half-way between `(n-1)/2` and `(n+1)/2` if it is odd.
+ */
+static inline void coarse_weights(int n, int *index, double *weight) {
+  const int n0 = floor_half(n);
+  const double p = n - 2 * n0;
+
+  index[0]  = n0;
+  index[1]  = n0 + 1;
+  weight[0] = 1.0 - 0.5 * p;
+  weight[1] = 0.5 * p;
+}
+
+//! Ownership ranges of the coarse grid.
+/*!
+  Each coarse grid node is owned by the rank owning the fine grid node at the same location. This
+  ensures that all the coarse grid nodes we need are in the stencil-width-1 ghost region.
+ */
+static std::vector<PetscInt> coarse_ownership_ranges(const PetscInt *fine,
+                                                     PetscInt n_procs,
+                                                     PetscInt M_coarse) {
+  std::vector<PetscInt> result(n_procs);
+
+  PetscInt
+    fine_start   = 0,
+    coarse_start = 0;
+  for (PetscInt k = 0; k < n_procs; ++k) {
+    const PetscInt
+      fine_end   = fine_start + fine[k],
+      coarse_end = k == n_procs - 1 ? M_coarse : (fine_end + 1) / 2;
+
+    result[k] = coarse_end - coarse_start;
+
+    fine_start   = fine_end;
+    coarse_start = coarse_end;
+  }
+
+  return result;
+}
+
+//! Allocate storage and create the coarse grid used in the matrix-free mode.
+void SSAFEM::mf_allocate() {
+  PetscErrorCode ierr;
+
+  const unsigned int
+    Mx = m_grid->Mx(),
+    My = m_grid->My();
+
+  const bool
+    x_periodic = m_grid->periodicity() & X_PERIODIC,
+    y_periodic = m_grid->periodicity() & Y_PERIODIC;
+
+  if ((x_periodic and Mx % 2 != 0) or (y_periodic and My % 2 != 0)) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "the matrix-free SSAFEM solver requires an even number of grid"
+                                  " points in periodic directions (got Mx = %d, My = %d)",
+                                  Mx, My);
+  }
+
+  // Coarse grid node n corresponds to the fine grid node 2*n. In the non-periodic case we add a
+  // node to cover the last fine grid node if Mx (My) is even.
+  const PetscInt
+    Mx_coarse = x_periodic ? Mx / 2 : Mx / 2 + 1,
+    My_coarse = y_periodic ? My / 2 : My / 2 + 1;
+
+  {
+    PetscInt n_procs_x = 0, n_procs_y = 0;
+    ierr = DMDAGetInfo(*m_da,
+                       NULL,             // dimension
+                       NULL, NULL, NULL, // grid size
+                       &n_procs_x, &n_procs_y, NULL,
+                       NULL, NULL,       // dof, stencil width
+                       NULL, NULL, NULL, // boundary types
+                       NULL);            // stencil type
+    PISM_CHK(ierr, "DMDAGetInfo");
+
+    const PetscInt *fine_lx = NULL, *fine_ly = NULL;
+    ierr = DMDAGetOwnershipRanges(*m_da, &fine_lx, &fine_ly, NULL);
+    PISM_CHK(ierr, "DMDAGetOwnershipRanges");
+
+    std::vector<PetscInt>
+      lx = coarse_ownership_ranges(fine_lx, n_procs_x, Mx_coarse),
+      ly = coarse_ownership_ranges(fine_ly, n_procs_y, My_coarse);
+
+    for (auto n : lx) {
+      if (n < 1) {
+        throw RuntimeError(PISM_ERROR_LOCATION,
+                           "sub-domains are too small to use the matrix-free SSAFEM solver");
+      }
+    }
+    for (auto n : ly) {
+      if (n < 1) {
+        throw RuntimeError(PISM_ERROR_LOCATION,
+                           "sub-domains are too small to use the matrix-free SSAFEM solver");
+      }
+    }
+
+    // Note: like all DMs created by IceGrid this one is periodic. This is not a problem: in
+    // the non-periodic case we never access "wrapped" ghosts.
+    DM coarse;
+    ierr = DMDACreate2d(m_grid->com,
+                        DM_BOUNDARY_PERIODIC, DM_BOUNDARY_PERIODIC,
+                        DMDA_STENCIL_BOX,
+                        Mx_coarse, My_coarse,
+                        n_procs_x, n_procs_y,
+                        2, 1,     // dof, stencil width
+                        &lx[0], &ly[0],
+                        &coarse);
+    PISM_CHK(ierr, "DMDACreate2d");
+
+#if PETSC_VERSION_GE(3,8,0)
+    ierr = DMSetUp(coarse);
+    PISM_CHK(ierr, "DMSetUp");
+#endif
+
+    m_coarse_da = petsc::DM::Ptr(new petsc::DM(coarse));
+  }
+
+  ierr = DMSetMatType(*m_coarse_da, "baij");
+  PISM_CHK(ierr, "DMSetMatType");
+
+  ierr = DMCreateMatrix(*m_coarse_da, m_coarse_jacobian.rawptr());
+  PISM_CHK(ierr, "DMCreateMatrix");
+
+  ierr = DMCreateGlobalVector(*m_coarse_da, m_coarse_rhs.rawptr());
+  PISM_CHK(ierr, "DMCreateGlobalVector");
+
+  ierr = DMCreateGlobalVector(*m_coarse_da, m_coarse_solution.rawptr());
+  PISM_CHK(ierr, "DMCreateGlobalVector");
+
+  ierr = DMCreateLocalVector(*m_coarse_da, m_coarse_local.rawptr());
+  PISM_CHK(ierr, "DMCreateLocalVector");
+
+  // the coarse grid solver
+  {
+    ierr = KSPCreate(m_grid->com, m_coarse_ksp.rawptr());
+    PISM_CHK(ierr, "KSPCreate");
+
+    ierr = KSPSetOptionsPrefix(m_coarse_ksp, "ssafem_coarse_");
+    PISM_CHK(ierr, "KSPSetOptionsPrefix");
+
+    ierr = KSPSetType(m_coarse_ksp, KSPPREONLY);
+    PISM_CHK(ierr, "KSPSetType");
+
+    PC pc;
+    ierr = KSPGetPC(m_coarse_ksp, &pc);
+    PISM_CHK(ierr, "KSPGetPC");
+
+    ierr = PCSetType(pc, PCGAMG);
+    PISM_CHK(ierr, "PCSetType");
+
+    ierr = KSPSetFromOptions(m_coarse_ksp);
+    PISM_CHK(ierr, "KSPSetFromOptions");
+  }
+
+  // the fine grid operator
+  {
+    const int
+      n_local  = 2 * m_grid->xm() * m_grid->ym(),
+      n_global = 2 * Mx * My;
+
+    ierr = MatCreateShell(m_grid->com, n_local, n_local, n_global, n_global,
+                          this, m_mf_jacobian.rawptr());
+    PISM_CHK(ierr, "MatCreateShell");
+
+    ierr = MatShellSetOperation(m_mf_jacobian, MATOP_MULT,
+                                (void(*)(void))mf_multiply_callback);
+    PISM_CHK(ierr, "MatShellSetOperation");
+
+    ierr = MatShellSetOperation(m_mf_jacobian, MATOP_GET_DIAGONAL,
+                                (void(*)(void))mf_get_diagonal_callback);
+    PISM_CHK(ierr, "MatShellSetOperation");
+
+    ierr = MatSetOption(m_mf_jacobian, MAT_SYMMETRIC, PETSC_TRUE);
+    PISM_CHK(ierr, "MatSetOption");
+  }
+
+  m_mf_linearization_point.create(m_grid, "linearization_point", WITH_GHOSTS);
+  m_mf_input.create(m_grid, "jacobian_input", WITH_GHOSTS);
+  m_mf_diagonal.create(m_grid, "jacobian_diagonal", WITHOUT_GHOSTS);
+
+  ierr = VecDuplicate(m_mf_diagonal.get_vec(), m_mf_inv_diagonal.rawptr());
+  PISM_CHK(ierr, "VecDuplicate");
+
+  ierr = VecDuplicate(m_mf_diagonal.get_vec(), m_mf_work.rawptr());
+  PISM_CHK(ierr, "VecDuplicate");
+}
+
+//! Compute the element-local Jacobian at the linearization point.
+/*!
+  Returns `false` if the element (`i`, `j`) does not contribute (an exterior element in the CFBC
+  case). Marks rows and columns corresponding to ghosts and Dirichlet nodes as invalid in
+  `m_element`.
+ */
+bool SSAFEM::mf_element_jacobian(int i, int j, bool use_cfbc,
+                                 fem::DirichletData_Vector &dirichlet_data,
+                                 double K[2 * fem::q1::n_chi][2 * fem::q1::n_chi]) {
+  const unsigned int Nk = fem::q1::n_chi;
+
+  // Initialize the map from global to element degrees of freedom.
+  m_element.reset(i, j);
+
+  int node_type[Nk];
+  m_element.nodal_values(m_node_type, node_type);
+  // an element is "interior" if all its nodes are interior or boundary
+  const bool interior_element = (node_type[0] < NODE_EXTERIOR and
+                                 node_type[1] < NODE_EXTERIOR and
+                                 node_type[2] < NODE_EXTERIOR and
+                                 node_type[3] < NODE_EXTERIOR);
+
+  if (use_cfbc and (not interior_element)) {
+    // an exterior element in the CFBC case
+    return false;
+  }
+
+  Coefficients coeffs[Nk];
+  m_element.nodal_values(m_coefficients, coeffs);
+
+  Vector2 velocity_nodal[Nk];
+  m_element.nodal_values(m_mf_linearization_point, velocity_nodal);
+
+  if (dirichlet_data) {
+    dirichlet_data.enforce(m_element, velocity_nodal);
+    dirichlet_data.constrain(m_element);
+  }
+
+  element_jacobian(i, j, coeffs, velocity_nodal, K);
+
+  return true;
+}
+
+//! Weight of the identity block in the Jacobian row corresponding to the node (`i`, `j`).
+/*!
+  This is non-zero at Dirichlet nodes only. See DirichletData_Vector::fix_jacobian().
+ */
+double SSAFEM::mf_dirichlet_weight(int i, int j, bool use_cfbc) const {
+  double result = 0.0;
+
+  if (m_bc_mask != NULL and (*m_bc_mask)(i, j) > 0.5) {
+    result += m_dirichletScale;
+  }
+
+  if (use_cfbc and m_node_type(i, j) > 0.5) {
+    result += m_dirichletScale;
+  }
+
+  return result;
+}
+
+//! Record the linearization point, compute the diagonal of the Jacobian and the coarse grid
+//! operator.
+void SSAFEM::mf_setup(Vec x) {
+  PetscErrorCode ierr;
+
+  const unsigned int Nk = fem::q1::n_chi;
+
+  const bool use_cfbc = m_config->get_boolean("stress_balance.calving_front_stress_bc");
+
+  m_mf_linearization_point.copy_from_vec(x);
+
+  m_mf_diagonal.set(0.0);
+
+  ierr = MatZeroEntries(m_coarse_jacobian);
+  PISM_CHK(ierr, "MatZeroEntries");
+
+  {
+    IceModelVec::AccessList list{&m_node_type, &m_coefficients,
+        &m_mf_linearization_point, &m_mf_diagonal};
+
+    if (m_bc_mask != NULL) {
+      list.add(*m_bc_mask);
+    }
+
+    fem::DirichletData_Vector dirichlet_data(m_bc_mask, m_bc_values, m_dirichletScale);
+
+    // Offsets of the element nodes (the same order as in fem::ElementMap).
+    const int
+      di[Nk] = {0, 1, 1, 0},
+      dj[Nk] = {0, 0, 1, 1};
+
+    const int
+      xs = m_element_index.xs,
+      xm = m_element_index.xm,
+      ys = m_element_index.ys,
+      ym = m_element_index.ym;
+
+    ParallelSection loop(m_grid->com);
+    try {
+      for (int j = ys; j < ys + ym; j++) {
+        for (int i = xs; i < xs + xm; i++) {
+          double K[2*Nk][2*Nk];
+          if (not mf_element_jacobian(i, j, use_cfbc, dirichlet_data, K)) {
+            continue;
+          }
+
+          // Remove contributions to rows we don't own and rows and columns of Dirichlet nodes.
+          for (unsigned int k = 0; k < 2*Nk; ++k) {
+            for (unsigned int l = 0; l < 2*Nk; ++l) {
+              if (not (m_element.row_is_valid(k / 2) and m_element.col_is_valid(l / 2))) {
+                K[k][l] = 0.0;
+              }
+            }
+          }
+
+          // diagonal
+          for (unsigned int k = 0; k < Nk; ++k) {
+            int ii = 0, jj = 0;
+            m_element.local_to_global(k, ii, jj);
+
+            if (m_element.row_is_valid(k)) {
+              m_mf_diagonal(ii, jj).u += K[2*k + 0][2*k + 0];
+              m_mf_diagonal(ii, jj).v += K[2*k + 1][2*k + 1];
+            }
+          }
+
+          // The fine element (i, j) is contained in the coarse element (I, J).
+          const int
+            I = floor_half(i),
+            J = floor_half(j);
+
+          // Interpolation from coarse element nodes to fine element nodes.
+          double P[Nk][Nk];
+          for (unsigned int k = 0; k < Nk; ++k) {
+            const double
+              px = i + di[k] - 2 * I,
+              py = j + dj[k] - 2 * J;
+
+            for (unsigned int m = 0; m < Nk; ++m) {
+              const double
+                wx = di[m] == 0 ? 1.0 - 0.5 * px : 0.5 * px,
+                wy = dj[m] == 0 ? 1.0 - 0.5 * py : 0.5 * py;
+              P[k][m] = wx * wy;
+            }
+          }
+
+          // Compute P^T K P.
+          double KP[2*Nk][2*Nk], Kc[2*Nk][2*Nk];
+          for (unsigned int k = 0; k < 2*Nk; ++k) {
+            for (unsigned int n = 0; n < 2*Nk; ++n) {
+              double sum = 0.0;
+              for (unsigned int l = n % 2; l < 2*Nk; l += 2) {
+                sum += K[k][l] * P[l / 2][n / 2];
+              }
+              KP[k][n] = sum;
+            }
+          }
+          for (unsigned int m = 0; m < 2*Nk; ++m) {
+            for (unsigned int n = 0; n < 2*Nk; ++n) {
+              double sum = 0.0;
+              for (unsigned int k = m % 2; k < 2*Nk; k += 2) {
+                sum += P[k / 2][m / 2] * KP[k][n];
+              }
+              Kc[m][n] = sum;
+            }
+          }
+
+          MatStencil coarse_nodes[Nk];
+          for (unsigned int m = 0; m < Nk; ++m) {
+            coarse_nodes[m].i = I + di[m];
+            coarse_nodes[m].j = J + dj[m];
+            coarse_nodes[m].k = 0;
+            coarse_nodes[m].c = 0;
+          }
+
+          ierr = MatSetValuesBlockedStencil(m_coarse_jacobian,
+                                            Nk, coarse_nodes, Nk, coarse_nodes,
+                                            &Kc[0][0], ADD_VALUES);
+          PISM_CHK(ierr, "MatSetValuesBlockedStencil");
+        } // i-loop
+      } // j-loop
+
+      // Dirichlet nodes
+      for (Points p(*m_grid); p; p.next()) {
+        const int i = p.i(), j = p.j();
+
+        const double w = mf_dirichlet_weight(i, j, use_cfbc);
+        if (w == 0.0) {
+          continue;
+        }
+
+        m_mf_diagonal(i, j).u += w;
+        m_mf_diagonal(i, j).v += w;
+
+        int I[2], J[2];
+        double wx[2], wy[2];
+        coarse_weights(i, I, wx);
+        coarse_weights(j, J, wy);
+
+        MatStencil coarse_nodes[Nk];
+        double weights[Nk];
+        for (unsigned int m = 0; m < Nk; ++m) {
+          coarse_nodes[m].i = I[di[m]];
+          coarse_nodes[m].j = J[dj[m]];
+          coarse_nodes[m].k = 0;
+          coarse_nodes[m].c = 0;
+          weights[m] = wx[di[m]] * wy[dj[m]];
+        }
+
+        double Kc[2*Nk][2*Nk];
+        for (unsigned int m = 0; m < 2*Nk; ++m) {
+          for (unsigned int n = 0; n < 2*Nk; ++n) {
+            Kc[m][n] = (m % 2 == n % 2) ? w * weights[m / 2] * weights[n / 2] : 0.0;
+          }
+        }
+
+        ierr = MatSetValuesBlockedStencil(m_coarse_jacobian,
+                                          Nk, coarse_nodes, Nk, coarse_nodes,
+                                          &Kc[0][0], ADD_VALUES);
+        PISM_CHK(ierr, "MatSetValuesBlockedStencil");
+      }
+    } catch (...) {
+      loop.failed();
+    }
+    loop.check();
+  }
+
+  ierr = MatAssemblyBegin(m_coarse_jacobian, MAT_FINAL_ASSEMBLY);
+  PISM_CHK(ierr, "MatAssemblyBegin");
+
+  ierr = MatAssemblyEnd(m_coarse_jacobian, MAT_FINAL_ASSEMBLY);
+  PISM_CHK(ierr, "MatAssemblyEnd");
+
+  ierr = MatSetOption(m_coarse_jacobian, MAT_SYMMETRIC, PETSC_TRUE);
+  PISM_CHK(ierr, "MatSetOption");
+
+  ierr = KSPSetOperators(m_coarse_ksp, m_coarse_jacobian, m_coarse_jacobian);
+  PISM_CHK(ierr, "KSPSetOperators");
+
+  ierr = VecCopy(m_mf_diagonal.get_vec(), m_mf_inv_diagonal);
+  PISM_CHK(ierr, "VecCopy");
+
+  ierr = VecReciprocal(m_mf_inv_diagonal);
+  PISM_CHK(ierr, "VecReciprocal");
+}
+
+//! Compute the action of the Jacobian evaluated at m_mf_linearization_point: `y = J x`.
+void SSAFEM::mf_multiply(Vec x, Vec y) {
+  PetscErrorCode ierr;
+
+  const unsigned int Nk = fem::q1::n_chi;
+
+  const bool use_cfbc = m_config->get_boolean("stress_balance.calving_front_stress_bc");
+
+  m_mf_input.copy_from_vec(x);
+
+  ierr = VecSet(y, 0.0);
+  PISM_CHK(ierr, "VecSet");
+
+  petsc::DMDAVecArray y_array(m_da, y);
+  Vector2 **result = static_cast<Vector2**>(y_array.get());
+
+  IceModelVec::AccessList list{&m_node_type, &m_coefficients,
+      &m_mf_linearization_point, &m_mf_input};
+
+  if (m_bc_mask != NULL) {
+    list.add(*m_bc_mask);
+  }
+
+  fem::DirichletData_Vector dirichlet_data(m_bc_mask, m_bc_values, m_dirichletScale);
+
+  const int
+    xs = m_element_index.xs,
+    xm = m_element_index.xm,
+    ys = m_element_index.ys,
+    ym = m_element_index.ym;
+
+  ParallelSection loop(m_grid->com);
+  try {
+    for (int j = ys; j < ys + ym; j++) {
+      for (int i = xs; i < xs + xm; i++) {
+        double K[2*Nk][2*Nk];
+        if (not mf_element_jacobian(i, j, use_cfbc, dirichlet_data, K)) {
+          continue;
+        }
+
+        Vector2 x_nodal[Nk];
+        m_element.nodal_values(m_mf_input, x_nodal);
+
+        // Columns corresponding to Dirichlet nodes are not used.
+        if (dirichlet_data) {
+          dirichlet_data.enforce_homogeneous(m_element, x_nodal);
+        }
+
+        Vector2 y_nodal[Nk];
+        for (unsigned int k = 0; k < Nk; ++k) {
+          for (unsigned int l = 0; l < Nk; ++l) {
+            y_nodal[k].u += K[2*k + 0][2*l + 0] * x_nodal[l].u + K[2*k + 0][2*l + 1] * x_nodal[l].v;
+            y_nodal[k].v += K[2*k + 1][2*l + 0] * x_nodal[l].u + K[2*k + 1][2*l + 1] * x_nodal[l].v;
+          }
+        }
+
+        m_element.add_contribution(y_nodal, result);
+      } // i-loop
+    } // j-loop
+
+    // Dirichlet nodes
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      const double w = mf_dirichlet_weight(i, j, use_cfbc);
+      if (w != 0.0) {
+        result[j][i] += w * m_mf_input(i, j);
+      }
+    }
+  } catch (...) {
+    loop.failed();
+  }
+  loop.check();
+}
+
+//! Get the diagonal of the Jacobian computed by mf_setup().
+void SSAFEM::mf_get_diagonal(Vec d) {
+  PetscErrorCode ierr = VecCopy(m_mf_diagonal.get_vec(), d);
+  PISM_CHK(ierr, "VecCopy");
+}
+
+//! Perform one damped Jacobi sweep: `z = z + omega * D^{-1} (r - J z)`.
+void SSAFEM::mf_smooth(Vec r, Vec z) {
+  PetscErrorCode ierr;
+
+  mf_multiply(z, m_mf_work);
+
+  ierr = VecAYPX(m_mf_work, -1.0, r);
+  PISM_CHK(ierr, "VecAYPX");
+
+  ierr = VecPointwiseMult(m_mf_work, m_mf_work, m_mf_inv_diagonal);
+  PISM_CHK(ierr, "VecPointwiseMult");
+
+  ierr = VecAXPY(z, m_mf_jacobi_damping, m_mf_work);
+  PISM_CHK(ierr, "VecAXPY");
+}
+
+//! Restrict a fine grid vector to the coarse grid: `coarse = P^T fine`.
+void SSAFEM::mf_restrict(Vec fine, Vec coarse) {
+  PetscErrorCode ierr;
+
+  ierr = VecSet(m_coarse_local, 0.0);
+  PISM_CHK(ierr, "VecSet");
+
+  {
+    petsc::DMDAVecArray
+      fine_array(m_da, fine),
+      coarse_array(m_coarse_da, m_coarse_local);
+
+    Vector2
+      **f = static_cast<Vector2**>(fine_array.get()),
+      **c = static_cast<Vector2**>(coarse_array.get());
+
+    for (Points p(*m_grid); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      int I[2], J[2];
+      double wx[2], wy[2];
+      coarse_weights(i, I, wx);
+      coarse_weights(j, J, wy);
+
+      for (int n = 0; n < 2; ++n) {
+        for (int m = 0; m < 2; ++m) {
+          const double w = wx[m] * wy[n];
+          if (w > 0.0) {
+            c[J[n]][I[m]] += w * f[j][i];
+          }
+        }
+      }
+    }
+  }
+
+  ierr = VecSet(coarse, 0.0);
+  PISM_CHK(ierr, "VecSet");
+
+  ierr = DMLocalToGlobalBegin(*m_coarse_da, m_coarse_local, ADD_VALUES, coarse);
+  PISM_CHK(ierr, "DMLocalToGlobalBegin");
+
+  ierr = DMLocalToGlobalEnd(*m_coarse_da, m_coarse_local, ADD_VALUES, coarse);
+  PISM_CHK(ierr, "DMLocalToGlobalEnd");
+}
+
+//! Interpolate a coarse grid vector to the fine grid and add it: `fine = fine + P coarse`.
+void SSAFEM::mf_prolong_add(Vec coarse, Vec fine) {
+  PetscErrorCode ierr;
+
+  ierr = DMGlobalToLocalBegin(*m_coarse_da, coarse, INSERT_VALUES, m_coarse_local);
+  PISM_CHK(ierr, "DMGlobalToLocalBegin");
+
+  ierr = DMGlobalToLocalEnd(*m_coarse_da, coarse, INSERT_VALUES, m_coarse_local);
+  PISM_CHK(ierr, "DMGlobalToLocalEnd");
+
+  petsc::DMDAVecArray
+    fine_array(m_da, fine),
+    coarse_array(m_coarse_da, m_coarse_local);
+
+  Vector2
+    **f = static_cast<Vector2**>(fine_array.get()),
+    **c = static_cast<Vector2**>(coarse_array.get());
+
+  for (Points p(*m_grid); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    int I[2], J[2];
+    double wx[2], wy[2];
+    coarse_weights(i, I, wx);
+    coarse_weights(j, J, wy);
+
+    for (int n = 0; n < 2; ++n) {
+      for (int m = 0; m < 2; ++m) {
+        const double w = wx[m] * wy[n];
+        if (w > 0.0) {
+          f[j][i] += w * c[J[n]][I[m]];
+        }
+      }
+    }
+  }
+}
+
+//! Apply one V-cycle of the two-level multigrid preconditioner: `z = B r`.
+void SSAFEM::mf_precondition(Vec r, Vec z) {
+  PetscErrorCode ierr;
+
+  // pre-smoothing; the first sweep starts from zero and does not need the Jacobian action
+  ierr = VecPointwiseMult(z, m_mf_inv_diagonal, r);
+  PISM_CHK(ierr, "VecPointwiseMult");
+
+  ierr = VecScale(z, m_mf_jacobi_damping);
+  PISM_CHK(ierr, "VecScale");
+
+  for (int k = 1; k < m_mf_n_smoothing_steps; ++k) {
+    mf_smooth(r, z);
+  }
+
+  // coarse grid correction
+  {
+    mf_multiply(z, m_mf_work);
+
+    ierr = VecAYPX(m_mf_work, -1.0, r);
+    PISM_CHK(ierr, "VecAYPX");
+
+    mf_restrict(m_mf_work, m_coarse_rhs);
+
+    ierr = KSPSolve(m_coarse_ksp, m_coarse_rhs, m_coarse_solution);
+    PISM_CHK(ierr, "KSPSolve");
+
+    mf_prolong_add(m_coarse_solution, z);
+  }
+
+  // post-smoothing
+  for (int k = 0; k < m_mf_n_smoothing_steps; ++k) {
+    mf_smooth(r, z);
+  }
+}
+
+///@}
+
 //!
 PetscErrorCode SSAFEM::function_callback(DMDALocalInfo *info,
                                          Vector2 const *const *const velocity,
@@ -1139,7 +1906,9 @@ PetscErrorCode SSAFEM::function_callback(DMDALocalInfo *info,
                                          CallbackData *fe) {
   try {
     (void) info;
+    const double start_time = GetTime();
     fe->ssa->compute_local_function(velocity, residual);
+    fe->ssa->m_statistics.assembly_time += GetTime() - start_time;
   } catch (...) {
     MPI_Comm com = MPI_COMM_SELF;
     PetscErrorCode ierr = PetscObjectGetComm((PetscObject)fe->da, &com); CHKERRQ(ierr);
@@ -1155,7 +1924,9 @@ PetscErrorCode SSAFEM::jacobian_callback(DMDALocalInfo *info,
   try {
     (void) A;
     (void) info;
+    const double start_time = GetTime();
     fe->ssa->compute_local_jacobian(velocity, J);
+    fe->ssa->m_statistics.assembly_time += GetTime() - start_time;
   } catch (...) {
     MPI_Comm com = MPI_COMM_SELF;
     PetscErrorCode ierr = PetscObjectGetComm((PetscObject)fe->da, &com); CHKERRQ(ierr);
@@ -1165,5 +1936,67 @@ PetscErrorCode SSAFEM::jacobian_callback(DMDALocalInfo *info,
   return 0;
 }
 
+PetscErrorCode SSAFEM::mf_jacobian_callback(SNES snes, Vec x, Mat A, Mat J, void *ctx) {
+  try {
+    (void) A;
+    (void) J;
+    SSAFEM *ssa = static_cast<SSAFEM*>(ctx);
+    const double start_time = GetTime();
+    ssa->mf_setup(x);
+    ssa->m_statistics.assembly_time += GetTime() - start_time;
+  } catch (...) {
+    MPI_Comm com = MPI_COMM_SELF;
+    PetscErrorCode ierr = PetscObjectGetComm((PetscObject)snes, &com); CHKERRQ(ierr);
+    handle_fatal_errors(com);
+    SETERRQ(com, 1, "A PISM callback failed");
+  }
+  return 0;
+}
+
+PetscErrorCode SSAFEM::mf_multiply_callback(Mat A, Vec x, Vec y) {
+  try {
+    SSAFEM *ssa = NULL;
+    PetscErrorCode ierr = MatShellGetContext(A, &ssa);
+    PISM_CHK(ierr, "MatShellGetContext");
+    ssa->mf_multiply(x, y);
+  } catch (...) {
+    MPI_Comm com = MPI_COMM_SELF;
+    PetscErrorCode ierr = PetscObjectGetComm((PetscObject)A, &com); CHKERRQ(ierr);
+    handle_fatal_errors(com);
+    SETERRQ(com, 1, "A PISM callback failed");
+  }
+  return 0;
+}
+
+PetscErrorCode SSAFEM::mf_get_diagonal_callback(Mat A, Vec d) {
+  try {
+    SSAFEM *ssa = NULL;
+    PetscErrorCode ierr = MatShellGetContext(A, &ssa);
+    PISM_CHK(ierr, "MatShellGetContext");
+    ssa->mf_get_diagonal(d);
+  } catch (...) {
+    MPI_Comm com = MPI_COMM_SELF;
+    PetscErrorCode ierr = PetscObjectGetComm((PetscObject)A, &com); CHKERRQ(ierr);
+    handle_fatal_errors(com);
+    SETERRQ(com, 1, "A PISM callback failed");
+  }
+  return 0;
+}
+
+PetscErrorCode SSAFEM::mf_precondition_callback(PC pc, Vec r, Vec z) {
+  try {
+    void *ctx = NULL;
+    PetscErrorCode ierr = PCShellGetContext(pc, &ctx);
+    PISM_CHK(ierr, "PCShellGetContext");
+    static_cast<SSAFEM*>(ctx)->mf_precondition(r, z);
+  } catch (...) {
+    MPI_Comm com = MPI_COMM_SELF;
+    PetscErrorCode ierr = PetscObjectGetComm((PetscObject)pc, &com); CHKERRQ(ierr);
+    handle_fatal_errors(com);
+    SETERRQ(com, 1, "A PISM callback failed");
+  }
+  return 0;
+}
+
 } // end of namespace stressbalance
 } // end of namespace pism
@@ -22,6 +22,9 @@
 #include "SSA.hh"
 #include "pism/util/FETools.hh"
 #include "pism/util/petscwrappers/SNES.hh"
+#include "pism/util/petscwrappers/KSP.hh"
+#include "pism/util/petscwrappers/Mat.hh"
+#include "pism/util/petscwrappers/Vec.hh"
 #include "pism/util/TerminationReason.hh"
 #include "pism/util/Mask.hh"
 
@@ -105,6 +108,11 @@ protected:
 
   void compute_local_jacobian(Vector2 const *const *const velocity, Mat J);
 
+  void element_jacobian(int i, int j,
+                        const Coefficients *coefficients,
+                        const Vector2 *velocity,
+                        double K[2 * fem::q1::n_chi][2 * fem::q1::n_chi]);
+
   virtual void solve(const Inputs &inputs);
 
   TerminationReason::Ptr solve_with_reason(const Inputs &inputs);
@@ -145,8 +153,47 @@ protected:
   // gradient of a periodic function. (See commit ffb4be16.)
   const IceModelVec2S *m_driving_stress_x;
   const IceModelVec2S *m_driving_stress_y;
+
+  //! True if the Newton step uses the matrix-free Jacobian and the two-level preconditioner.
+  bool m_matrix_free;
+  //! Shell matrix applying the Jacobian evaluated at m_mf_linearization_point.
+  petsc::Mat m_mf_jacobian;
+  //! Velocity at which the Jacobian is evaluated (the current Newton iterate).
+  IceModelVec2V m_mf_linearization_point;
+  //! Ghosted copy of the vector the Jacobian is applied to.
+  IceModelVec2V m_mf_input;
+  //! Diagonal of the Jacobian and its reciprocal (used by the Jacobi smoother).
+  IceModelVec2V m_mf_diagonal;
+  petsc::Vec m_mf_inv_diagonal;
+  //! Work space for the smoother.
+  petsc::Vec m_mf_work;
+  //! Jacobi damping parameter.
+  double m_mf_jacobi_damping;
+  //! Number of damped Jacobi sweeps before and after the coarse grid correction.
+  int m_mf_n_smoothing_steps;
+  //! The coarse grid (the fine grid coarsened by the factor of 2 in each direction).
+  petsc::DM::Ptr m_coarse_da;
+  //! Galerkin coarse-grid Jacobian; the only assembled matrix in the matrix-free mode.
+  petsc::Mat m_coarse_jacobian;
+  petsc::KSP m_coarse_ksp;
+  petsc::Vec m_coarse_rhs;
+  petsc::Vec m_coarse_solution;
+  petsc::Vec m_coarse_local;
 private:
   void cache_residual_cfbc(const Inputs &inputs);
+
+  void mf_allocate();
+  bool mf_element_jacobian(int i, int j, bool use_cfbc,
+                           fem::DirichletData_Vector &dirichlet_data,
+                           double K[2 * fem::q1::n_chi][2 * fem::q1::n_chi]);
+  double mf_dirichlet_weight(int i, int j, bool use_cfbc) const;
+  void mf_setup(Vec x);
+  void mf_multiply(Vec x, Vec y);
+  void mf_get_diagonal(Vec d);
+  void mf_smooth(Vec r, Vec z);
+  void mf_restrict(Vec fine, Vec coarse);
+  void mf_prolong_add(Vec coarse, Vec fine);
+  void mf_precondition(Vec r, Vec z);
   void monitor_jacobian(Mat Jac);
   void monitor_function(Vector2 const *const *const velocity_global,
                         Vector2 const *const *const residual_global);
@@ -160,6 +207,12 @@ static PetscErrorCode function_callback(DMDALocalInfo *info,
   static PetscErrorCode jacobian_callback(DMDALocalInfo *info,
                                           Vector2 const *const *const xg,
                                           Mat A, Mat J, CallbackData *fe);
+
+  //! Callbacks used in the matrix-free mode.
+  static PetscErrorCode mf_jacobian_callback(SNES snes, Vec x, Mat A, Mat J, void *ctx);
+  static PetscErrorCode mf_multiply_callback(Mat A, Vec x, Vec y);
+  static PetscErrorCode mf_get_diagonal_callback(Mat A, Vec d);
+  static PetscErrorCode mf_precondition_callback(PC pc, Vec r, Vec z);
 };
 
 
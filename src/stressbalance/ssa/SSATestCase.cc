@@ -25,6 +25,8 @@
 #include "pism/util/pism_options.hh"
 #include "pism/util/io/io_helpers.hh"
 #include "pism/util/pism_utilities.hh"
+#include "pism/util/pism_const.hh"
+#include "pism/util/BenchmarkReport.hh"
 #include "pism/stressbalance/StressBalance.hh"
 
 namespace pism {
@@ -38,7 +40,8 @@ SSATestCase::SSATestCase(Context::Ptr ctx, int Mx, int My,
     m_grid(IceGrid::Shallow(m_ctx, Lx, Ly, 0.0, 0.0, Mx, My, registration, periodicity)),
     m_sys(ctx->unit_system()),
     m_geometry(m_grid),
-    m_ssa(NULL) {
+    m_ssa(NULL),
+    m_run_time(0.0) {
 
   const unsigned int WIDE_STENCIL = m_config->get_double("grid.max_stencil_width");
 
@@ -124,7 +127,9 @@ void SSATestCase::run() {
   inputs.bc_values             = &m_bc_values;
 
   bool full_update = true;
+  const double start_time = GetTime();
   m_ssa->update(inputs, full_update);
+  m_run_time += GetTime() - start_time;
 }
 
 //! Report on the generated solution
@@ -218,6 +223,37 @@ void SSATestCase::report(const std::string &testname) {
                 convert(m_sys, gmaxverr, "m second-1", "m year-1"),
                 convert(m_sys, gavuerr, "m second-1", "m year-1"),
                 convert(m_sys, gavverr, "m second-1", "m year-1"));
+
+  report_benchmark(testname);
+}
+
+//! Save solver performance data to a JSON file (if requested).
+void SSATestCase::report_benchmark(const std::string &testname) {
+
+  options::String filename("-benchmark_output", "JSON file to save SSA solver performance data to");
+
+  if (not filename.is_set()) {
+    return;
+  }
+
+  m_ctx->log()->message(2, "Also writing performance data to '%s'...\n", filename->c_str());
+
+  const SSAStatistics &stats = m_ssa->statistics();
+
+  BenchmarkReport report(m_com);
+
+  report.set_string("test", testname);
+  report.set_string("solver", dynamic_cast<SSAFEM*>(m_ssa) != NULL ? "SSAFEM" : "SSAFD");
+  report.set_number("Mx", m_grid->Mx());
+  report.set_number("My", m_grid->My());
+  report.set_number("nonlinear_iterations", stats.nonlinear_iterations);
+  report.set_number("linear_iterations", stats.linear_iterations);
+  report.set_timer("assembly_time", stats.assembly_time);
+  report.set_timer("solve_time", stats.solve_time);
+  report.set_timer("total_time", m_run_time);
+  report.set_memory_usage();
+
+  report.write(filename);
 }
 
 void SSATestCase::report_netcdf(const std::string &testname,
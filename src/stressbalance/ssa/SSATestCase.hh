@@ -85,6 +85,8 @@ protected:
                      double avg_u,
                      double avg_v);
 
+  void report_benchmark(const std::string &testname);
+
   MPI_Comm m_com;
   const Context::Ptr m_ctx;
   const Config::Ptr m_config;
@@ -104,6 +106,9 @@ protected:
   Geometry m_geometry;
 
   SSA *m_ssa;
+
+  //! wall-clock time spent in run(), in seconds
+  double m_run_time;
 };
 
 } // end of namespace stressbalance
@@ -22,6 +22,7 @@
 #include "pism/util/iceModelVec.hh"
 #include "pism/util/IceModelVec2CellType.hh"
 #include "pism/util/pism_utilities.hh"
+#include "pism/util/GlobalReduction.hh"
 
 namespace pism {
 
@@ -31,6 +32,25 @@ CFLData::CFLData() {
   w_max = 0.0;
 }
 
+DeferredCFLData::DeferredCFLData()
+  : dt_max(-1), u_max(-1), v_max(-1), w_max(-1) {
+  // empty
+}
+
+CFLData DeferredCFLData::get(const GlobalReduction &reduction) const {
+  CFLData result;
+
+  if (dt_max >= 0) {
+    result.dt_max = MaxTimestep(reduction[dt_max]);
+  }
+
+  result.u_max = u_max >= 0 ? reduction[u_max] : 0.0;
+  result.v_max = v_max >= 0 ? reduction[v_max] : 0.0;
+  result.w_max = w_max >= 0 ? reduction[w_max] : 0.0;
+
+  return result;
+}
+
 //! Compute the maximum velocities for time-stepping and reporting to user.
 /*!
 Computes the maximum magnitude of the components \f$u,v,w\f$ of the 3D velocity.
@@ -43,6 +63,21 @@ CFLData max_timestep_cfl_3d(const IceModelVec2S &ice_thickness,
                             const IceModelVec3 &u3,
                             const IceModelVec3 &v3,
                             const IceModelVec3 &w3) {
+  GlobalReduction reduction(ice_thickness.get_grid()->com);
+
+  DeferredCFLData result = max_timestep_cfl_3d(ice_thickness, cell_type, u3, v3, w3,
+                                               reduction);
+  reduction.resolve();
+
+  return result.get(reduction);
+}
+
+DeferredCFLData max_timestep_cfl_3d(const IceModelVec2S &ice_thickness,
+                                    const IceModelVec2CellType &cell_type,
+                                    const IceModelVec3 &u3,
+                                    const IceModelVec3 &v3,
+                                    const IceModelVec3 &w3,
+                                    GlobalReduction &reduction) {
 
   IceGrid::ConstPtr grid = ice_thickness.get_grid();
   Config::ConstPtr config = grid->ctx()->config();
@@ -89,14 +124,14 @@ CFLData max_timestep_cfl_3d(const IceModelVec2S &ice_thickness,
   } catch (...) {
     loop.failed();
   }
-  loop.check();
+  loop.check(reduction);
 
-  CFLData result;
+  DeferredCFLData result;
 
-  result.u_max = GlobalMax(grid->com, u_max);
-  result.v_max = GlobalMax(grid->com, v_max);
-  result.w_max = GlobalMax(grid->com, w_max);
-  result.dt_max = MaxTimestep(GlobalMin(grid->com, dt_max));
+  result.u_max  = reduction.max(u_max);
+  result.v_max  = reduction.max(v_max);
+  result.w_max  = reduction.max(w_max);
+  result.dt_max = reduction.min(dt_max);
 
   return result;
 }
@@ -114,6 +149,18 @@ CFLData max_timestep_cfl_3d(const IceModelVec2S &ice_thickness,
 CFLData max_timestep_cfl_2d(const IceModelVec2S &ice_thickness,
                             const IceModelVec2CellType &cell_type,
                             const IceModelVec2V &velocity) {
+  GlobalReduction reduction(ice_thickness.get_grid()->com);
+
+  DeferredCFLData result = max_timestep_cfl_2d(ice_thickness, cell_type, velocity, reduction);
+  reduction.resolve();
+
+  return result.get(reduction);
+}
+
+DeferredCFLData max_timestep_cfl_2d(const IceModelVec2S &ice_thickness,
+                                    const IceModelVec2CellType &cell_type,
+                                    const IceModelVec2V &velocity,
+                                    GlobalReduction &reduction) {
 
   IceGrid::ConstPtr grid = ice_thickness.get_grid();
   Config::ConstPtr config = grid->ctx()->config();
@@ -145,12 +192,11 @@ CFLData max_timestep_cfl_2d(const IceModelVec2S &ice_thickness,
     }
   }
 
-  CFLData result;
+  DeferredCFLData result;
 
-  result.u_max = GlobalMax(grid->com, u_max);
-  result.v_max = GlobalMax(grid->com, v_max);
-  result.w_max = 0.0;
-  result.dt_max = MaxTimestep(GlobalMin(grid->com, dt_max));
+  result.u_max  = reduction.max(u_max);
+  result.v_max  = reduction.max(v_max);
+  result.dt_max = reduction.min(dt_max);
 
   return result;
 }
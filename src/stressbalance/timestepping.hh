@@ -28,6 +28,7 @@ class IceModelVec2S;
 class IceModelVec2CellType;
 class IceModelVec2V;
 class IceModelVec3;
+class GlobalReduction;
 
 struct CFLData {
   CFLData();
@@ -35,6 +36,15 @@ struct CFLData {
   double u_max, v_max, w_max;
 };
 
+//! Indices of CFL quantities registered with a GlobalReduction.
+struct DeferredCFLData {
+  DeferredCFLData();
+  //! Get results. Call after `reduction.resolve()`.
+  CFLData get(const GlobalReduction &reduction) const;
+
+  int dt_max, u_max, v_max, w_max;
+};
+
 /*! @brief Compute the max. time step according to the CFL condition (within the volume of the
     ice). */
 /*!
@@ -49,6 +59,17 @@ CFLData max_timestep_cfl_3d(const IceModelVec2S &ice_thickness,
                             const IceModelVec3 &v3,
                             const IceModelVec3 &w3);
 
+/*!
+ * @brief Same as max_timestep_cfl_3d() above, but registers local contributions with
+ * `reduction` instead of communicating.
+ */
+DeferredCFLData max_timestep_cfl_3d(const IceModelVec2S &ice_thickness,
+                                    const IceModelVec2CellType &cell_type,
+                                    const IceModelVec3 &u3,
+                                    const IceModelVec3 &v3,
+                                    const IceModelVec3 &w3,
+                                    GlobalReduction &reduction);
+
 /*! @brief Compute the max. time step according to the CFL condition (within the ice, 2D). */
 /*!
  * Returns the maximum time step along with maximum speeds along x and y directions within the
@@ -58,6 +79,15 @@ CFLData max_timestep_cfl_2d(const IceModelVec2S &ice_thickness,
                             const IceModelVec2CellType &cell_type,
                             const IceModelVec2V &velocity);
 
+/*!
+ * @brief Same as max_timestep_cfl_2d() above, but registers local contributions with
+ * `reduction` instead of communicating.
+ */
+DeferredCFLData max_timestep_cfl_2d(const IceModelVec2S &ice_thickness,
+                                    const IceModelVec2CellType &cell_type,
+                                    const IceModelVec2V &velocity,
+                                    GlobalReduction &reduction);
+
 } // end of namespace pism
 
 
@@ -0,0 +1,135 @@
+/* Copyright (C) 2018 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cmath>                // std::isfinite
+#include <cstdio>
+#include <vector>
+#include <sys/resource.h>       // getrusage()
+
+#include "BenchmarkReport.hh"
+#include "error_handling.hh"
+#include "pism_utilities.hh"
+
+namespace pism {
+
+BenchmarkReport::BenchmarkReport(MPI_Comm com)
+  : m_com(com) {
+
+  int size = 1;
+  MPI_Comm_size(m_com, &size);
+
+  set_number("ranks", size);
+  set_string("revision", PISM_Revision);
+}
+
+void BenchmarkReport::set_number(const std::string &name, double value) {
+  m_numbers[name] = value;
+}
+
+void BenchmarkReport::set_string(const std::string &name, const std::string &value) {
+  m_strings[name] = value;
+}
+
+//! Record the maximum over all ranks of the time `local_time`, in seconds.
+void BenchmarkReport::set_timer(const std::string &name, double local_time) {
+  set_number(name, GlobalMax(m_com, local_time));
+}
+
+//! Record the maximum and the total resident set size high-water mark, in MiB.
+void BenchmarkReport::set_memory_usage() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+#ifdef __APPLE__
+  // ru_maxrss is in bytes
+  const double max_rss = usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+  // ru_maxrss is in kilobytes
+  const double max_rss = usage.ru_maxrss / 1024.0;
+#endif
+
+  set_number("memory_max_per_rank_MiB", GlobalMax(m_com, max_rss));
+  set_number("memory_total_MiB", GlobalSum(m_com, max_rss));
+}
+
+//! Escape a string so that it can be used as a JSON string literal.
+static std::string json_string(const std::string &input) {
+  std::string result = "\"";
+  for (auto c : input) {
+    switch (c) {
+    case '"':
+      result += "\\\"";
+      break;
+    case '\\':
+      result += "\\\\";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        // control characters have to be escaped
+        char buffer[8];
+        snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned int)c);
+        result += buffer;
+      } else {
+        result += c;
+      }
+    }
+  }
+  return result + "\"";
+}
+
+//! Write collected data to `filename` as a JSON object (on rank 0).
+/*!
+ * JSON has no representation for NaN and infinity, so non-finite numbers are written as
+ * `null`.
+ */
+void BenchmarkReport::write(const std::string &filename) const {
+  int rank = 0;
+  MPI_Comm_rank(m_com, &rank);
+
+  if (rank != 0) {
+    return;
+  }
+
+  FILE *f = fopen(filename.c_str(), "w");
+  if (f == NULL) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION, "failed to open '%s' for writing",
+                                  filename.c_str());
+  }
+
+  std::vector<std::string> entries;
+  for (auto p : m_strings) {
+    entries.push_back("  " + json_string(p.first) + ": " + json_string(p.second));
+  }
+
+  char buffer[64];
+  for (auto p : m_numbers) {
+    if (std::isfinite(p.second)) {
+      snprintf(buffer, sizeof(buffer), "%.9g", p.second);
+    } else {
+      snprintf(buffer, sizeof(buffer), "null");
+    }
+    entries.push_back("  " + json_string(p.first) + ": " + buffer);
+  }
+
+  fprintf(f, "{\n%s\n}\n", join(entries, ",\n").c_str());
+
+  fclose(f);
+}
+
+} // end of namespace pism
@@ -0,0 +1,54 @@
+/* Copyright (C) 2018 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _BENCHMARKREPORT_H_
+#define _BENCHMARKREPORT_H_
+
+#include <map>
+#include <string>
+
+#include <mpi.h>
+
+namespace pism {
+
+//! Collects results of a benchmark run and saves them as a JSON object.
+/*!
+ * Used by test executables (`ssa_testi`, `siafd_test`, ...) to record
+ * performance data; see `util/stressbalance_benchmark.py`.
+ */
+class BenchmarkReport {
+public:
+  BenchmarkReport(MPI_Comm com);
+
+  void set_number(const std::string &name, double value);
+  void set_string(const std::string &name, const std::string &value);
+
+  void set_timer(const std::string &name, double local_time);
+  void set_memory_usage();
+
+  void write(const std::string &filename) const;
+private:
+  MPI_Comm m_com;
+  std::map<std::string, double> m_numbers;
+  std::map<std::string, std::string> m_strings;
+};
+
+} // end of namespace pism
+
+#endif /* _BENCHMARKREPORT_H_ */
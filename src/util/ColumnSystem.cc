@@ -288,6 +288,29 @@ void columnSystemCtx::coarse_to_fine(const IceModelVec3 &coarse, int i, int j,
   m_interp->coarse_to_fine(array, m_ks, fine);
 }
 
+//! Copy interpolated velocity components from a system using the same fine grid.
+/*!
+  Use this to avoid interpolating the 3D velocity field more than once per column if
+  several column systems are solved in the same sweep. `other` has to be initialized
+  (using the same column) first.
+ */
+void columnSystemCtx::copy_velocity(const columnSystemCtx &other) {
+  if (other.m_z.size() != m_z.size() or other.m_dz != m_dz) {
+    throw RuntimeError(PISM_ERROR_LOCATION,
+                       "cannot copy velocity: fine vertical grids do not match");
+  }
+
+  if (other.m_i != m_i or other.m_j != m_j) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "cannot copy velocity: column (%d, %d) != (%d, %d)",
+                                  other.m_i, other.m_j, m_i, m_j);
+  }
+
+  m_u = other.m_u;
+  m_v = other.m_v;
+  m_w = other.m_w;
+}
+
 void columnSystemCtx::init_fine_grid(const std::vector<double>& storage_grid) {
   // Compute m_dz as the minimum vertical spacing in the coarse
   // grid:
@@ -366,4 +389,36 @@ void columnSystemCtx::save_to_file(const std::string &filename,
   m_solver->save_system_with_solution(filename, m_z.size(), x);
 }
 
+/*!
+ * Re-build lists of icy and ice-free columns.
+ *
+ * @param[in] ice_thickness ice thickness
+ * @param[in] dz vertical grid spacing of the fine grid used by column systems
+ */
+void ColumnIndex::update(const IceModelVec2S &ice_thickness, double dz) {
+  m_icy.clear();
+  m_ice_free.clear();
+
+  IceModelVec::AccessList list(ice_thickness);
+
+  for (Points p(*ice_thickness.get_grid()); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    // this matches the computation of ks in columnSystemCtx::init_column()
+    if (floor(ice_thickness(i, j) / dz) > 0.0) {
+      m_icy.push_back({i, j});
+    } else {
+      m_ice_free.push_back({i, j});
+    }
+  }
+}
+
+const std::vector<ColumnIndex::Column>& ColumnIndex::icy() const {
+  return m_icy;
+}
+
+const std::vector<ColumnIndex::Column>& ColumnIndex::ice_free() const {
+  return m_ice_free;
+}
+
 } // end of namespace pism
@@ -183,6 +183,34 @@ protected:
   void init_fine_grid(const std::vector<double>& storage_grid);
 
   void coarse_to_fine(const IceModelVec3 &coarse, int i, int j, double* fine) const;
+
+  void copy_velocity(const columnSystemCtx &other);
+};
+
+class IceModelVec2S;
+
+//! Compact lists of owned columns that do and do not contain ice.
+/*!
+  A column contains ice if the ice thickness is at least one (fine) vertical grid spacing,
+  i.e. if `columnSystemCtx::ks() > 0`. Column solvers iterate over icy() only. Columns in
+  ice_free() get a constant column in a separate (cheap) pass.
+
+  Both lists use the order of `Points` (`i` varies fastest), which matches the memory layout
+  of IceModelVec3.
+ */
+class ColumnIndex {
+public:
+  struct Column {
+    int i, j;
+  };
+
+  void update(const IceModelVec2S &ice_thickness, double dz);
+
+  const std::vector<Column>& icy() const;
+  const std::vector<Column>& ice_free() const;
+private:
+  std::vector<Column> m_icy;
+  std::vector<Column> m_ice_free;
 };
 
 } // end of namespace pism
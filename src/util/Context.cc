@@ -24,6 +24,7 @@
 #include "Time.hh"
 #include "Logger.hh"
 #include "pism/util/EnthalpyConverter.hh"
+#include "pism/util/io/ForcingFile.hh"
 
 namespace pism {
 
@@ -48,6 +49,7 @@ public:
   std::string prefix;
   Profiling profiling;
   LoggerPtr logger;
+  ForcingFileRegistry forcing_files;
 };
 
 Context::Context(MPI_Comm c, UnitsSystemPtr sys,
@@ -110,6 +112,11 @@ const Profiling& Context::profiling() const {
   return m_impl->profiling;
 }
 
+//! Forcing files shared by fields using this context (see ForcingFile::open()).
+ForcingFileRegistry& Context::forcing_files() const {
+  return m_impl->forcing_files;
+}
+
 Context::ConstLoggerPtr Context::log() const {
   return m_impl->logger;
 }
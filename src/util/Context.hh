@@ -36,6 +36,7 @@ class EnthalpyConverter;
 class Time;
 class Profiling;
 class Logger;
+class ForcingFileRegistry;
 
 class Context {
 public:
@@ -66,6 +67,7 @@ public:
   ConstTimePtr time() const;
   const std::string& prefix() const;
   const Profiling& profiling() const;
+  ForcingFileRegistry& forcing_files() const;
 
   ConstLoggerPtr log() const;
   LoggerPtr log();
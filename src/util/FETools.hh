@@ -322,6 +322,18 @@ public:
   void mark_row_invalid(int k);
   void mark_col_invalid(int k);
 
+  //! Return `true` if the row corresponding to local degree of freedom `k` is not marked as
+  //! "invalid".
+  bool row_is_valid(int k) const {
+    return m_row[k].k != 1;
+  }
+
+  //! Return `true` if the column corresponding to local degree of freedom `k` is not marked as
+  //! "invalid".
+  bool col_is_valid(int k) const {
+    return m_col[k].k != 1;
+  }
+
   //! Convert a local degree of freedom index `k` to a global degree of freedom index (`i`,`j`).
   void local_to_global(int k, int &i, int &j) const {
     i = m_i + m_i_offset[k];
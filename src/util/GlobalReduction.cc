@@ -0,0 +1,148 @@
+/* Copyright (C) 2018 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <algorithm>            // std::max, std::min
+
+#include "GlobalReduction.hh"
+#include "error_handling.hh"
+
+namespace pism {
+
+/*!
+ * Combines (value, operation) pairs element-wise. The operation is stored as a double
+ * next to the value it applies to; it is the same on all ranks.
+ */
+static void combine(void *input, void *input_output, int *length, MPI_Datatype *type) {
+  (void) type;
+
+  const double *in = static_cast<double*>(input);
+  double *inout    = static_cast<double*>(input_output);
+
+  for (int k = 0; k < *length; ++k) {
+    const double a = in[2 * k];
+    double &b = inout[2 * k];
+
+    switch (static_cast<int>(inout[2 * k + 1])) {
+    case 0:                     // REDUCE_MAX
+      b = std::max(a, b);
+      break;
+    case 1:                     // REDUCE_MIN
+      b = std::min(a, b);
+      break;
+    default:                    // REDUCE_SUM
+      b += a;
+      break;
+    }
+  }
+}
+
+GlobalReduction::GlobalReduction(MPI_Comm com)
+  : m_com(com), m_failure_flag(-1), m_resolved(false) {
+  // empty
+}
+
+unsigned int GlobalReduction::add(double value, Operation op) {
+  if (m_resolved) {
+    throw RuntimeError(PISM_ERROR_LOCATION,
+                       "cannot add a contribution to a global reduction after resolve()");
+  }
+
+  m_data.push_back(value);
+  m_data.push_back(op);
+
+  return m_data.size() / 2 - 1;
+}
+
+//! Register the local maximum; returns the index of the result.
+unsigned int GlobalReduction::max(double local) {
+  return add(local, REDUCE_MAX);
+}
+
+//! Register the local minimum; returns the index of the result.
+unsigned int GlobalReduction::min(double local) {
+  return add(local, REDUCE_MIN);
+}
+
+//! Register the local sum; returns the index of the result.
+unsigned int GlobalReduction::sum(double local) {
+  return add(local, REDUCE_SUM);
+}
+
+//! Register the failure flag of a parallel section. See ParallelSection::check().
+void GlobalReduction::add_failure_flag(bool failed) {
+  if (m_failure_flag < 0) {
+    m_failure_flag = add(failed ? 1.0 : 0.0, REDUCE_MAX);
+  } else if (failed) {
+    m_data[2 * m_failure_flag] = 1.0;
+  }
+}
+
+//! Perform all registered reductions using one `MPI_Allreduce` call.
+void GlobalReduction::resolve() {
+  if (m_resolved) {
+    return;
+  }
+
+  const int N = m_data.size() / 2;
+
+  if (N > 0) {
+    MPI_Datatype pair;
+    MPI_Op op;
+
+    int err = MPI_Type_contiguous(2, MPI_DOUBLE, &pair);
+    PISM_C_CHK(err, 0, "MPI_Type_contiguous");
+    err = MPI_Type_commit(&pair);
+    PISM_C_CHK(err, 0, "MPI_Type_commit");
+    err = MPI_Op_create(combine, 1, &op);
+    PISM_C_CHK(err, 0, "MPI_Op_create");
+
+    std::vector<double> result(m_data.size());
+    err = MPI_Allreduce(&m_data[0], &result[0], N, pair, op, m_com);
+
+    MPI_Op_free(&op);
+    MPI_Type_free(&pair);
+
+    PISM_C_CHK(err, 0, "MPI_Allreduce");
+
+    m_data = result;
+  }
+
+  m_resolved = true;
+
+  if (m_failure_flag >= 0 and m_data[2 * m_failure_flag] > 0.0) {
+    throw RuntimeError(PISM_ERROR_LOCATION, "Failure in a parallel section. See error messages above for more.");
+  }
+}
+
+//! Get the result of a reduction registered earlier. Valid after resolve() only.
+double GlobalReduction::operator[](unsigned int index) const {
+  if (not m_resolved) {
+    throw RuntimeError(PISM_ERROR_LOCATION,
+                       "global reduction results are not available before resolve()");
+  }
+
+  if (2 * index >= m_data.size()) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "invalid global reduction index: %u", index);
+  }
+
+  return m_data[2 * index];
+}
+
+} // end of namespace pism
@@ -0,0 +1,72 @@
+/* Copyright (C) 2018 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GLOBALREDUCTION_H_
+#define _GLOBALREDUCTION_H_
+
+#include <mpi.h>
+#include <vector>
+
+namespace pism {
+
+//! @brief Combines several global reductions (max, min, sum) into one `MPI_Allreduce` call.
+/*!
+ * Each reduction is latency-bound, so computing several scalars (maximum speeds, time step
+ * restrictions, areas and volumes, etc) using one call saves time on large process counts.
+ *
+ * Usage:
+ *
+ *     GlobalReduction reduction(com);
+ *     unsigned int u = reduction.max(u_max_local);
+ *     unsigned int dt = reduction.min(dt_max_local);
+ *     loop.check(reduction);      // optional: defer a ParallelSection check
+ *     reduction.resolve();        // communication happens here
+ *     double u_max = reduction[u];
+ *
+ * `resolve()` throws if one of the deferred parallel sections failed on any rank.
+ */
+class GlobalReduction {
+public:
+  GlobalReduction(MPI_Comm com);
+
+  unsigned int max(double local);
+  unsigned int min(double local);
+  unsigned int sum(double local);
+
+  void add_failure_flag(bool failed);
+
+  void resolve();
+
+  double operator[](unsigned int index) const;
+private:
+  enum Operation {REDUCE_MAX = 0, REDUCE_MIN = 1, REDUCE_SUM = 2};
+
+  unsigned int add(double value, Operation op);
+
+  MPI_Comm m_com;
+  //! (value, operation) pairs
+  std::vector<double> m_data;
+  //! index of the parallel section failure flag (or -1 if there is none)
+  int m_failure_flag;
+  bool m_resolved;
+};
+
+} // end of namespace pism
+
+#endif /* _GLOBALREDUCTION_H_ */
@@ -18,6 +18,7 @@
  */
 
 #include "error_handling.hh"
+#include "GlobalReduction.hh"
 #include <petsc.h>
 
 #include <stdexcept>
@@ -213,4 +214,12 @@ void ParallelSection::check() {
   }
 }
 
+//! @brief Defer the check until `reduction` is resolved, avoiding a separate reduction.
+/*!
+ * GlobalReduction::resolve() throws if this section failed on any rank.
+ */
+void ParallelSection::check(GlobalReduction &reduction) {
+  reduction.add_failure_flag(m_failed);
+}
+
 } // end of namespace pism
@@ -64,11 +64,14 @@ public:
   ErrorLocation m_location;
 };
 
+class GlobalReduction;
+
 class ParallelSection {
 public:
   ParallelSection(MPI_Comm com);
   ~ParallelSection();
   void check();
+  void check(GlobalReduction &reduction);
   void failed();
   void reset();
 private:
@@ -31,6 +31,57 @@
 
 namespace pism {
 
+//! Copy records [n, n + count) of `source` to records [m, m + count) of `target`.
+/*!
+ * Both Vecs store `dof` records. `source` and `target` may be the same Vec if m <= n.
+ */
+static void copy_records(::Vec source, unsigned int n, ::Vec target, unsigned int m,
+                         unsigned int count, unsigned int dof) {
+  PetscInt size = 0;
+  PetscErrorCode ierr = VecGetLocalSize(target, &size);
+  PISM_CHK(ierr, "VecGetLocalSize");
+
+  if (source == target) {
+    petsc::VecArray data(target);
+    double *a = data.get();
+
+    for (PetscInt k = 0; k < size / (PetscInt)dof; ++k) {
+      for (unsigned int r = 0; r < count; ++r) {
+        a[k * dof + m + r] = a[k * dof + n + r];
+      }
+    }
+  } else {
+    petsc::VecArray
+      input(source),
+      output(target);
+    const double *a = input.get();
+    double *b = output.get();
+
+    for (PetscInt k = 0; k < size / (PetscInt)dof; ++k) {
+      for (unsigned int r = 0; r < count; ++r) {
+        b[k * dof + m + r] = a[k * dof + n + r];
+      }
+    }
+  }
+}
+
+//! Copy a 2D field `source` to record `n` of `target` (which has `dof` records).
+static void store_record(::Vec source, ::Vec target, unsigned int n, unsigned int dof) {
+  PetscInt size = 0;
+  PetscErrorCode ierr = VecGetLocalSize(source, &size);
+  PISM_CHK(ierr, "VecGetLocalSize");
+
+  petsc::VecArray
+    input(source),
+    output(target);
+  const double *a = input.get();
+  double *b = output.get();
+
+  for (PetscInt k = 0; k < size; ++k) {
+    b[k * dof + n] = a[k];
+  }
+}
+
 IceModelVec2T::IceModelVec2T() : IceModelVec2S() {
   m_has_ghosts           = false;
   m_array3                 = NULL;
@@ -41,6 +92,9 @@ IceModelVec2T::IceModelVec2T() : IceModelVec2S() {
   m_period               = 0;
   m_reference_time       = 0.0;
   m_n_evaluations_per_year = 53;
+  m_prefetch               = false;
+  m_next_first             = 0;
+  m_next_N                 = 0;
 
   m_da3.reset();
 }
@@ -106,8 +160,6 @@ void IceModelVec2T::end_access() const {
 
 void IceModelVec2T::init(const std::string &fname, unsigned int period, double reference_time) {
 
-  const Logger &log = *m_grid->ctx()->log();
-
   m_filename         = fname;
   m_period         = period;
   m_reference_time = reference_time;
@@ -115,7 +167,9 @@ void IceModelVec2T::init(const std::string &fname, unsigned int period, double r
   // We find the variable in the input file and
   // try to find the corresponding time dimension.
 
-  PIO nc(m_grid->com, "guess_mode", m_filename, PISM_READONLY);
+  m_file = ForcingFile::open(m_grid, m_filename);
+
+  const PIO &nc = m_file->file();
   std::string name_found;
   bool exists, found_by_standard_name;
   nc.inq_var(m_metadata[0].get_name(), m_metadata[0].get_string("standard_name"),
@@ -145,22 +199,12 @@ void IceModelVec2T::init(const std::string &fname, unsigned int period, double r
 
   if (time_found) {
     // we're found the time dimension
-    TimeseriesMetadata time_dimension(dimname, dimname, m_grid->ctx()->unit_system());
-
-    time_dimension.set_string("units", m_grid->ctx()->time()->units_string());
-    io::read_timeseries(nc, time_dimension,
-                        *m_grid->ctx()->time(), log, m_time);
-
-    std::string bounds_name = nc.get_att_text(dimname, "bounds");
+    std::vector<double> time_bounds;
+    m_file->read_time(dimname, m_time, time_bounds);
 
     if (m_time.size() > 1) {
-      if (not bounds_name.empty()) {
-        // read time bounds data from a file
-        TimeBoundsMetadata tb(bounds_name, dimname, m_grid->ctx()->unit_system());
-        tb.set_string("units", time_dimension.get_string("units"));
-
-        io::read_time_bounds(nc, tb, *m_grid->ctx()->time(),
-                             log, m_time_bounds);
+      if (not time_bounds.empty()) {
+        m_time_bounds = time_bounds;
 
         // time bounds data overrides the time variable: we make t[j] be the
         // right end-point of the j-th interval
@@ -205,6 +249,16 @@ void IceModelVec2T::init(const std::string &fname, unsigned int period, double r
 
     // read periodic data right away (we need to hold it all in memory anyway)
     update(0);
+  } else if (m_grid->ctx()->config()->get_boolean("climate_forcing.prefetch") and
+             m_time.size() > (size_t)m_n_records) {
+    // prefetching makes sense only if not all records fit in the buffer
+    m_prefetch = true;
+
+    PetscErrorCode ierr = DMCreateGlobalVector(*m_da3, m_v3_next.rawptr());
+    PISM_CHK(ierr, "DMCreateGlobalVector");
+
+    ierr = DMCreateGlobalVector(*m_da, m_v_next.rawptr());
+    PISM_CHK(ierr, "DMCreateGlobalVector");
   }
 }
 
@@ -253,6 +307,9 @@ void IceModelVec2T::update(double t, double dt) {
 
     // just return if we have all the data we need:
     if (t >= t0 && t + dt <= t1) {
+      if (m_prefetch) {
+        prefetch(t);
+      }
       return;
     }
   }
@@ -299,6 +356,8 @@ void IceModelVec2T::update(unsigned int start) {
 
   unsigned int missing = std::min(m_n_records, time_size - start);
 
+  const bool buffer_was_empty = (m_N == 0);
+
   if (start == static_cast<unsigned int>(m_first)) {
     // nothing to do
     return;
@@ -344,24 +403,118 @@ void IceModelVec2T::update(unsigned int start) {
     m_report_range = true;
   }
 
-  PIO nc(m_grid->com, "guess_mode", m_filename, PISM_READONLY);
+  // use prefetched records, if any
+  unsigned int prefetched = 0;
+  if (m_prefetch and (not buffer_was_empty) and start != m_next_first) {
+    // the window jumped: prefetched records (if any) are not used
+    log->message(2,
+                 "  PISM WARNING: prefetching of \"%s\" (short_name = %s) stalled:\n"
+                 "                the buffer moved to record %d instead of %d;\n"
+                 "                discarding %d prefetched records and reading %d records synchronously...\n",
+                 metadata().get_string("long_name").c_str(), m_name.c_str(),
+                 start, m_next_first, m_next_N, missing);
+  } else if (m_prefetch and (not buffer_was_empty)) {
+    prefetched = std::min(m_next_N, missing);
+
+    copy_records(m_v3_next, 0, m_v3, kept, prefetched, m_n_records);
+
+    // keep prefetched records that were not used yet: they belong to the next block
+    m_next_N -= prefetched;
+    copy_records(m_v3_next, prefetched, m_v3_next, 0, m_next_N, m_n_records);
+
+    if (prefetched < missing) {
+      log->message(2,
+                   "  PISM WARNING: prefetching of \"%s\" (short_name = %s) stalled:\n"
+                   "                reading %d of %d records synchronously...\n",
+                   metadata().get_string("long_name").c_str(), m_name.c_str(),
+                   missing - prefetched, missing);
+    }
+  }
+
+  if (prefetched < missing) {
+    const bool allow_extrapolation = m_grid->ctx()->config()->get_boolean("grid.allow_extrapolation");
+
+    for (unsigned int j = prefetched; j < missing; ++j) {
+      {
+        petsc::VecArray tmp_array(m_v);
+        m_file->read_record(m_metadata[0], start + j,
+                            m_report_range, allow_extrapolation,
+                            tmp_array.get());
+      }
+
+      m_grid->ctx()->log()->message(5, " %s: reading entry #%02d, year %s...\n",
+                                    m_name.c_str(),
+                                    start + j,
+                                    t->date(m_time[start + j]).c_str());
+
+      set_record(kept + j);
+    }
+  }
+
+  // start prefetching the next block
+  if (prefetched == 0) {
+    m_next_N = 0;
+  }
+  m_next_first = m_first + m_N;
+}
+
+//! Read some of the records following the ones in the buffer into the second buffer.
+/*!
+ * Reads just enough records so that the whole next block is available by the time the
+ * model reaches the end of the current buffer, assuming that update() is called at least
+ * once per record.
+ */
+void IceModelVec2T::prefetch(double t) {
+  const unsigned int time_size = m_time.size();
+
+  if (m_next_first >= time_size) {
+    // nothing to prefetch: the buffer contains the last record
+    return;
+  }
+
+  const unsigned int
+    n_records = std::min(m_n_records, time_size - m_next_first);
+
+  if (m_next_N >= n_records) {
+    // the next block is ready
+    return;
+  }
+
+  // find the record containing t and the number of records left in the buffer
+  unsigned int
+    last    = m_first + (m_N - 1),
+    current = m_first;
+  {
+    auto i = lower_bound(m_time_bounds.begin(), m_time_bounds.end(), t);
+    if (i != m_time_bounds.end()) {
+      current = std::max((unsigned int)((i - m_time_bounds.begin() - 1) / 2), current);
+    }
+  }
+  const unsigned int
+    records_left = last - std::min(current, last) + 1,
+    missing      = n_records - m_next_N,
+    N            = (missing + records_left - 1) / records_left;
+
+  Logger::ConstPtr log = m_grid->ctx()->log();
+  Time::ConstPtr time = m_grid->ctx()->time();
 
   const bool allow_extrapolation = m_grid->ctx()->config()->get_boolean("grid.allow_extrapolation");
 
-  for (unsigned int j = 0; j < missing; ++j) {
+  for (unsigned int j = 0; j < N; ++j) {
+    const unsigned int index = m_next_first + m_next_N;
+
     {
-      petsc::VecArray tmp_array(m_v);
-      io::regrid_spatial_variable(m_metadata[0], *m_grid, nc, start + j, CRITICAL,
-                                  m_report_range, allow_extrapolation,
-                                  0.0, tmp_array.get());
+      petsc::VecArray tmp_array(m_v_next);
+      m_file->read_record(m_metadata[0], index,
+                          false, allow_extrapolation,
+                          tmp_array.get());
     }
 
-    m_grid->ctx()->log()->message(5, " %s: reading entry #%02d, year %s...\n",
-                                  m_name.c_str(),
-                                  start + j,
-                                  t->date(m_time[start + j]).c_str());
+    log->message(5, " %s: prefetching entry #%02d, year %s...\n",
+                 m_name.c_str(), index, time->date(m_time[index]).c_str());
 
-    set_record(kept + j);
+    store_record(m_v_next, m_v3_next, m_next_N, m_n_records);
+    m_next_N += 1;
   }
 }
 
@@ -21,6 +21,7 @@
 
 #include "iceModelVec.hh"
 #include "MaxTimestep.hh"
+#include "io/ForcingFile.hh"
 
 namespace pism {
 
@@ -34,12 +35,24 @@ namespace pism {
   If requests (calls to update()) go in sequence, every records should be read
   only once.
 
+  All IceModelVec2T instances reading from the same file share it (see ForcingFile), so
+  the file is opened and its time axis is read once.
+
   Note that this class is optimized for use with a PDD scheme -- it stores
   records so that data corresponding to a grid point are stored in adjacent
   memory locations.
 
   IceModelVec2T is always global (%i.e. has no ghosts).
 
+  If `climate_forcing.prefetch` is set and the file contains more records than fit in
+  the buffer, the next block of records is read into a second buffer ahead of time, a
+  few records during each update() call that does not need new data. Records that were
+  not prefetched by the time they are needed (or were prefetched but are not used
+  because the buffer jumped to a different block) are read synchronously; this is
+  reported in the log. Note that prefetching reads are still collective and blocking:
+  they spread the cost of reading a block over many time steps, they do not overlap it
+  with computation.
+
   Both versions of interp() use piecewise-constant interpolation and
   extrapolate (by a constant) outside the available range.
 */
@@ -72,6 +85,7 @@ protected:
   std::vector<double> m_time,             //!< all the times available in filename
     m_time_bounds;                //!< time bounds
   std::string m_filename;         //!< file to read (regrid) from
+  ForcingFile::Ptr m_file;        //!< shared access to m_filename
   petsc::DM::Ptr m_da3;
   petsc::Vec m_v3;                       //!< a 3D Vec used to store records
   mutable void ***m_array3;
@@ -86,8 +100,20 @@ protected:
   unsigned int m_period;        // in years
   double m_reference_time;      // in seconds
 
+  //! true if the next block of records is read ahead of time
+  bool m_prefetch;
+  //! storage for the next block of records (used if prefetching)
+  petsc::Vec m_v3_next;
+  //! storage for one record read during prefetching
+  petsc::Vec m_v_next;
+  //! in-file index of the first record in `m_v3_next`
+  unsigned int m_next_first;
+  //! number of records in `m_v3_next` that were read already
+  unsigned int m_next_N;
+
   double*** get_array3();
   virtual void update(unsigned int start);
+  void prefetch(double t);
   virtual void discard(int N);
   virtual double average(int i, int j);
   virtual void set_record(int n);
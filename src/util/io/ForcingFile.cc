@@ -0,0 +1,156 @@
+/* Copyright (C) 2018 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <sstream>
+
+#include "ForcingFile.hh"
+#include "io_helpers.hh"
+#include "LocalInterpCtx.hh"
+#include "pism/util/VariableMetadata.hh"
+#include "pism/util/Time.hh"
+#include "pism/util/Logger.hh"
+#include "pism/util/Context.hh"
+#include "pism/util/pism_utilities.hh"
+
+namespace pism {
+
+//! Get the shared instance for `filename` (opening the file if necessary).
+/*!
+ * This is a collective operation: all ranks in the grid's communicator have to call it.
+ */
+ForcingFile::Ptr ForcingFile::open(IceGrid::ConstPtr grid, const std::string &filename) {
+  // A grid cannot be destroyed while a ForcingFile using it exists, so the grid address is
+  // a valid key.
+  auto key = std::make_pair(grid.get(), filename);
+
+  auto &files = grid->ctx()->forcing_files().files;
+
+  Ptr result = files[key].lock();
+
+  if (not result) {
+    result = Ptr(new ForcingFile(grid, filename));
+    files[key] = result;
+  }
+
+  return result;
+}
+
+ForcingFile::ForcingFile(IceGrid::ConstPtr grid, const std::string &filename)
+  : m_grid(grid), m_file(grid->com, "guess_mode", filename, PISM_READONLY) {
+  // empty
+}
+
+ForcingFile::~ForcingFile() {
+  // remove expired entries (including this one); m_grid is still valid here, so the
+  // registry is too
+  auto &files = m_grid->ctx()->forcing_files().files;
+
+  auto it = files.begin();
+  while (it != files.end()) {
+    if (it->second.expired()) {
+      it = files.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+const PIO& ForcingFile::file() const {
+  return m_file;
+}
+
+//! Read the time axis `dimension_name` and its bounds (if present).
+/*!
+ * Times are converted to the units used by the model time. `time_bounds` is empty if the
+ * time dimension has only one record or does not have the "bounds" attribute.
+ *
+ * Results are cached, so the time axis is read once no matter how many variables use it.
+ */
+void ForcingFile::read_time(const std::string &dimension_name,
+                            std::vector<double> &times,
+                            std::vector<double> &time_bounds) {
+  auto it = m_time.find(dimension_name);
+
+  if (it == m_time.end()) {
+    const Time &time = *m_grid->ctx()->time();
+    const Logger &log = *m_grid->ctx()->log();
+    units::System::Ptr sys = m_grid->ctx()->unit_system();
+
+    TimeAxis axis;
+
+    TimeseriesMetadata time_dimension(dimension_name, dimension_name, sys);
+
+    time_dimension.set_string("units", time.units_string());
+    io::read_timeseries(m_file, time_dimension, time, log, axis.times);
+
+    std::string bounds_name = m_file.get_att_text(dimension_name, "bounds");
+
+    if (axis.times.size() > 1 and not bounds_name.empty()) {
+      TimeBoundsMetadata tb(bounds_name, dimension_name, sys);
+      tb.set_string("units", time_dimension.get_string("units"));
+
+      io::read_time_bounds(m_file, tb, time, log, axis.bounds);
+    }
+
+    it = m_time.insert(std::make_pair(dimension_name, axis)).first;
+  }
+
+  times       = it->second.times;
+  time_bounds = it->second.bounds;
+}
+
+//! Read a record of a (critical) spatial variable, re-using interpolation weights.
+/*!
+ * Interpolation contexts are shared by all variables with the same dimensions and
+ * vertical levels.
+ */
+void ForcingFile::read_record(SpatialVariableMetadata &variable, unsigned int record,
+                              bool report_range, bool allow_extrapolation,
+                              double *output) {
+  bool exists = false, found_by_standard_name = false;
+  std::string name_found;
+  m_file.inq_var(variable.get_name(), variable.get_string("standard_name"),
+                 exists, name_found, found_by_standard_name);
+
+  LocalInterpCtx *lic = NULL;
+  if (exists) {
+    const std::vector<double> &levels = variable.get_levels();
+
+    std::ostringstream key;
+    key << join(m_file.inq_vardims(name_found), ",");
+    for (auto z : levels) {
+      key << ";" << z;
+    }
+
+    auto it = m_interpolation.find(key.str());
+    if (it == m_interpolation.end()) {
+      auto context = io::interpolation_context(m_file, name_found, *m_grid, levels,
+                                               allow_extrapolation);
+      it = m_interpolation.insert(std::make_pair(key.str(), context)).first;
+    }
+    lic = it->second.get();
+  }
+
+  // if the variable was not found this will stop with an error message
+  io::regrid_spatial_variable(variable, *m_grid, m_file, record, CRITICAL,
+                              report_range, allow_extrapolation,
+                              0.0, lic, output);
+}
+
+} // end of namespace pism
@@ -0,0 +1,98 @@
+/* Copyright (C) 2018 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _FORCINGFILE_H_
+#define _FORCINGFILE_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "pism/util/IceGrid.hh"
+#include "PIO.hh"
+
+namespace pism {
+
+class SpatialVariableMetadata;
+class LocalInterpCtx;
+class ForcingFile;
+
+//! Open forcing files, by grid and file name.
+/*!
+ * Owned by the Context, which outlives all the grids (and so all the ForcingFile
+ * instances) using it. Uses weak pointers so that a file is closed once all the fields that
+ * read from it are gone.
+ */
+class ForcingFileRegistry {
+public:
+  std::map<std::pair<const IceGrid*, std::string>, std::weak_ptr<ForcingFile> > files;
+};
+
+//! @brief A file containing time-dependent forcing fields, shared by all the fields read from it.
+/*!
+ * Couplers reading several variables from the same file (and IceModelVec2T instances
+ * reading records of the same variable in blocks) use this class to avoid re-opening the
+ * file, re-reading its time axis, and re-computing interpolation weights.
+ *
+ * The file stays open as long as there is at least one reference to it. Instances are
+ * shared by file name and grid: use ForcingFile::open() to get one.
+ */
+class ForcingFile {
+public:
+  typedef std::shared_ptr<ForcingFile> Ptr;
+
+  static Ptr open(IceGrid::ConstPtr grid, const std::string &filename);
+
+  ~ForcingFile();
+
+  const PIO& file() const;
+
+  void read_time(const std::string &dimension_name,
+                 std::vector<double> &times,
+                 std::vector<double> &time_bounds);
+
+  void read_record(SpatialVariableMetadata &variable, unsigned int record,
+                   bool report_range, bool allow_extrapolation,
+                   double *output);
+private:
+  ForcingFile(IceGrid::ConstPtr grid, const std::string &filename);
+
+  // m_grid has to be declared first: it keeps the Context (and so the registry) alive
+  // until m_file is closed.
+  IceGrid::ConstPtr m_grid;
+  PIO m_file;
+
+  struct TimeAxis {
+    std::vector<double> times, bounds;
+  };
+  //! time axes, by dimension name
+  std::map<std::string, TimeAxis> m_time;
+
+  //! interpolation contexts, by the list of dimensions of a variable
+  std::map<std::string, std::shared_ptr<LocalInterpCtx> > m_interpolation;
+
+  // disable copying and assignments
+  ForcingFile(const ForcingFile &other);
+  ForcingFile & operator=(const ForcingFile &);
+};
+
+} // end of namespace pism
+
+#endif /* _FORCINGFILE_H_ */
@@ -444,20 +444,29 @@ static void put_vec(const PIO &nc, const IceGrid &grid, const std::string &var_n
   }
 }
 
+/*!
+ * Uses the interpolation context `lic` if it is not NULL (it has to be created for this
+ * variable, file and grid); creates one otherwise.
+ */
 static void regrid_vec_generic(const PIO &file, const IceGrid &grid,
                                const std::string &variable_name,
                                const std::vector<double> &zlevels_out,
                                unsigned int t_start,
                                bool fill_missing,
                                double default_value,
+                               LocalInterpCtx *lic,
                                double *output) {
   const int X = 1, Y = 2, Z = 3; // indices, just for clarity
 
   try {
-    grid_info gi(file, variable_name, grid.ctx()->unit_system(), grid.registration());
-    LocalInterpCtx lic(gi, grid, zlevels_out);
+    std::unique_ptr<LocalInterpCtx> lic_storage;
+    if (lic == NULL) {
+      grid_info gi(file, variable_name, grid.ctx()->unit_system(), grid.registration());
+      lic_storage.reset(new LocalInterpCtx(gi, grid, zlevels_out));
+      lic = lic_storage.get();
+    }
 
-    std::vector<double> &buffer = lic.buffer;
+    std::vector<double> &buffer = lic->buffer;
 
     const unsigned int t_count = 1;
     std::vector<unsigned int> start, count, imap;
@@ -465,9 +474,9 @@ static void regrid_vec_generic(const PIO &file, const IceGrid &grid,
                             grid.ctx()->unit_system(),
                             variable_name,
                             t_start, t_count,
-                            lic.start[X], lic.count[X],
-                            lic.start[Y], lic.count[Y],
-                            lic.start[Z], lic.count[Z],
+                            lic->start[X], lic->count[X],
+                            lic->start[Y], lic->count[Y],
+                            lic->start[Z], lic->count[Z],
                             start, count, imap);
 
     bool mapped_io = use_mapped_io(file, grid.ctx()->unit_system(), variable_name);
@@ -493,7 +502,7 @@ static void regrid_vec_generic(const PIO &file, const IceGrid &grid,
     }
 
     // interpolate
-    regrid(grid, zlevels_out, &lic, output);
+    regrid(grid, zlevels_out, lic, output);
   } catch (RuntimeError &e) {
     e.add_context("reading variable '%s' (using linear interpolation) from '%s'",
                   variable_name.c_str(), file.inq_filename().c_str());
@@ -505,13 +514,13 @@ static void regrid_vec_generic(const PIO &file, const IceGrid &grid,
 //! interpolation to put it on the grid defined by "grid" and zlevels_out.
 static void regrid_vec(const PIO &nc, const IceGrid &grid, const std::string &var_name,
                        const std::vector<double> &zlevels_out,
-                       unsigned int t_start, double *output) {
+                       unsigned int t_start, LocalInterpCtx *lic, double *output) {
   regrid_vec_generic(nc, grid,
                      var_name,
                      zlevels_out,
                      t_start,
                      false, 0.0,
-                     output);
+                     lic, output);
 }
 
 /** Regrid `var_name` from a file, replacing missing values with `default_value`.
@@ -521,6 +530,7 @@ static void regrid_vec(const PIO &nc, const IceGrid &grid, const std::string &va
  * @param zlevels_out vertical levels of the resulting grid
  * @param t_start time index of the record to regrid
  * @param default_value default value to replace `_FillValue` with
+ * @param lic interpolation context (optional, can be NULL)
  * @param[out] output resulting interpolated field
  */
 static void regrid_vec_fill_missing(const PIO &nc, const IceGrid &grid,
@@ -528,13 +538,14 @@ static void regrid_vec_fill_missing(const PIO &nc, const IceGrid &grid,
                                     const std::vector<double> &zlevels_out,
                                     unsigned int t_start,
                                     double default_value,
+                                    LocalInterpCtx *lic,
                                     double *output) {
   regrid_vec_generic(nc, grid,
                      var_name,
                      zlevels_out,
                      t_start,
                      true, default_value,
-                     output);
+                     lic, output);
 }
 
 //! Define a NetCDF variable corresponding to a VariableMetadata object.
@@ -878,6 +889,30 @@ static void check_grid_overlap(const grid_info &input, const IceGrid &internal,
   }
 }
 
+//! Create the interpolation context for reading `variable_name` from `file` onto `grid`.
+/*!
+ * Checks the input grid. Set `allow_extrapolation` to skip checking if the input domain
+ * covers the computational domain.
+ *
+ * The result can be used to read all the records of all variables using the same
+ * dimensions (see regrid_spatial_variable()).
+ */
+std::shared_ptr<LocalInterpCtx> interpolation_context(const PIO &file,
+                                                      const std::string &variable_name,
+                                                      const IceGrid &grid,
+                                                      const std::vector<double> &levels,
+                                                      bool allow_extrapolation) {
+  grid_info input_grid(file, variable_name, grid.ctx()->unit_system(), grid.registration());
+
+  check_input_grid(input_grid);
+
+  if (not allow_extrapolation) {
+    check_grid_overlap(input_grid, grid, levels);
+  }
+
+  return std::shared_ptr<LocalInterpCtx>(new LocalInterpCtx(input_grid, grid, levels));
+}
+
 void regrid_spatial_variable(SpatialVariableMetadata &variable,
                              const IceGrid& grid, const PIO &file,
                              unsigned int t_start, RegriddingFlag flag,
@@ -885,6 +920,22 @@ void regrid_spatial_variable(SpatialVariableMetadata &variable,
                              bool allow_extrapolation,
                              double default_value,
                              double *output) {
+  regrid_spatial_variable(variable, grid, file, t_start, flag, report_range,
+                          allow_extrapolation, default_value, NULL, output);
+}
+
+/*!
+ * If `lic` is not NULL, uses it instead of creating an interpolation context. In this
+ * case the input grid is not checked (see interpolation_context()).
+ */
+void regrid_spatial_variable(SpatialVariableMetadata &variable,
+                             const IceGrid& grid, const PIO &file,
+                             unsigned int t_start, RegriddingFlag flag,
+                             bool report_range,
+                             bool allow_extrapolation,
+                             double default_value,
+                             LocalInterpCtx *lic,
+                             double *output) {
   const Logger &log = *grid.ctx()->log();
 
   units::System::Ptr sys = variable.unit_system();
@@ -899,7 +950,7 @@ void regrid_spatial_variable(SpatialVariableMetadata &variable,
 
   if (exists) {                      // the variable was found successfully
 
-    {
+    if (lic == NULL) {
       grid_info input_grid(file, name_found, sys, grid.registration());
 
       check_input_grid(input_grid);
@@ -916,9 +967,9 @@ void regrid_spatial_variable(SpatialVariableMetadata &variable,
                   file.inq_filename().c_str());
 
       regrid_vec_fill_missing(file, grid, name_found, levels,
-                              t_start, default_value, output);
+                              t_start, default_value, lic, output);
     } else {
-      regrid_vec(file, grid, name_found, levels, t_start, output);
+      regrid_vec(file, grid, name_found, levels, t_start, lic, output);
     }
 
     // Now we need to get the units string from the file and convert
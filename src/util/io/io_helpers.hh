@@ -22,6 +22,7 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <mpi.h>
 
 #include "IO_Flags.hh"
@@ -39,6 +40,7 @@ class Time;
 class Logger;
 class Context;
 class Config;
+class LocalInterpCtx;
 
 namespace io {
 
@@ -55,6 +57,21 @@ void regrid_spatial_variable(SpatialVariableMetadata &var,
                              bool allow_extrapolation,
                              double default_value, double *output);
 
+void regrid_spatial_variable(SpatialVariableMetadata &var,
+                             const IceGrid& grid, const PIO &nc,
+                             unsigned int t_start,
+                             RegriddingFlag flag, bool do_report_range,
+                             bool allow_extrapolation,
+                             double default_value,
+                             LocalInterpCtx *lic,
+                             double *output);
+
+std::shared_ptr<LocalInterpCtx> interpolation_context(const PIO &file,
+                                                      const std::string &variable_name,
+                                                      const IceGrid &grid,
+                                                      const std::vector<double> &levels,
+                                                      bool allow_extrapolation);
+
 void read_spatial_variable(const SpatialVariableMetadata &var,
                            const IceGrid& grid, const PIO &nc,
                            unsigned int time, double *output);
@@ -22,13 +22,30 @@
 #include <petscsys.h>
 #include <mpi.h>
 #include <cstdio>
+#include <cstring>
 
 #include "pism/util/error_handling.hh"
 
 namespace pism {
 namespace petsc {
 
-Initializer::Initializer(int argc, char **argv, const char *help) {
+//! Returns true if command-line options request a feature that needs MPI_THREAD_MULTIPLE.
+/*!
+ * MPI has to be initialized before the configuration is read, so only the command line is
+ * checked here: setting `bed_deformation.lc.asynchronous` in a configuration file does not
+ * request MPI_THREAD_MULTIPLE (BedDeformLC falls back to synchronous updates).
+ */
+static bool needs_mpi_threads(int argc, char **argv) {
+  for (int k = 1; k < argc; ++k) {
+    if (strcmp(argv[k], "-bed_def_lc_asynchronous") == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Initializer::Initializer(int argc, char **argv, const char *help)
+  : m_finalize_mpi(false) {
 
   PetscErrorCode ierr = 0;
   PetscBool initialized = PETSC_FALSE;
@@ -37,6 +54,17 @@ Initializer::Initializer(int argc, char **argv, const char *help) {
   PISM_CHK(ierr, "PetscInitialized");
 
   if (initialized == PETSC_FALSE) {
+    int mpi_initialized = 0;
+    MPI_Initialized(&mpi_initialized);
+
+    // PETSc initializes MPI without thread support. Initialize it here if we need more.
+    // (PETSc does not finalize MPI in this case, so we have to do it ourselves.)
+    if (not mpi_initialized and needs_mpi_threads(argc, argv)) {
+      int provided = MPI_THREAD_SINGLE;
+      MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+      m_finalize_mpi = true;
+    }
+
     ierr = PetscInitialize(&argc, &argv, NULL, help);
     PISM_CHK(ierr, "PetscInitialize");
 
@@ -56,6 +84,10 @@ Initializer::~Initializer() {
     // there is nothing we can do if this fails
     ierr = PetscFinalize(); CHKERRCONTINUE(ierr);
   }
+
+  if (m_finalize_mpi) {
+    MPI_Finalize();
+  }
 }
 
 } // end of namespace petsc
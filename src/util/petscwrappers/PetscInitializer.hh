@@ -29,6 +29,9 @@ class Initializer {
 public:
   Initializer(int argc, char **argv, const char *help);
   ~Initializer();
+private:
+  //! true if MPI was initialized by the constructor (and not by PETSc)
+  bool m_finalize_mpi;
 };
 
 } // end of namespace petsc
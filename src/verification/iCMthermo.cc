@@ -94,6 +94,12 @@ void IceCompModel::energy_step() {
     inputs.check();             // make sure all data members were set
   }
 
+  if (fused_age_sweep()) {
+    // update age in the same sweep over columns (IceModel::step() skips the separate age
+    // update in this case)
+    inputs.age_model = m_age_model;
+  }
+
   if ((m_testname == 'F') || (m_testname == 'G')) {
     // Compute compensatory strain heating (fills strain_heating3_comp).
     getCompSourcesTestFG();
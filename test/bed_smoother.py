@@ -115,7 +115,7 @@ def bed_smoother_test():
 
     stored_range = {}
     stored_range["topg"] = [-500.0, 500.0]
-    stored_range["topg_smoothed"] = [-372.9924735817933, 372.9924735817933]
+    stored_range["topg_smoothed"] = [-372.9924735817934, 372.99247358179343]
     stored_range["theta"] = [0.7147300652935706, 0.9884843647808601]
 
     computed_range = {}
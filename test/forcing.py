@@ -0,0 +1,197 @@
+import PISM
+import numpy as np
+import netCDF4
+import os
+
+"""Tests of IceModelVec2T (time-dependent forcing fields)."""
+
+ctx = PISM.Context()
+
+# the default calendar is "365_day"
+year = 365 * 86400.0
+n_records = 24
+buffer_size = 5
+
+
+def allocate_grid():
+    return PISM.IceGrid_Shallow(ctx.ctx, 1e5, 1e5, 0, 0, 5, 7, PISM.CELL_CORNER, PISM.NOT_PERIODIC)
+
+
+def exact(name_index, k, i, j):
+    "Value of the record k of the field name_index at the grid point (i, j)."
+    return 1000.0 * k + 10.0 * i + j + 0.25 * name_index
+
+
+def create_forcing(grid, filename, names):
+    "Create a file containing n_records yearly records of each field in names."
+    nc = netCDF4.Dataset(filename, "w")
+
+    x = np.array(grid.x())
+    y = np.array(grid.y())
+
+    nc.createDimension("x", len(x))
+    nc.createDimension("y", len(y))
+    nc.createDimension("time", None)
+    nc.createDimension("nv", 2)
+
+    nc.createVariable("x", "f8", ("x",))[:] = x
+    nc.variables["x"].units = "m"
+    nc.createVariable("y", "f8", ("y",))[:] = y
+    nc.variables["y"].units = "m"
+
+    time = nc.createVariable("time", "f8", ("time",))
+    time.units = "seconds since 1-1-1"
+    time.calendar = "365_day"
+    time.bounds = "time_bounds"
+    time_bounds = nc.createVariable("time_bounds", "f8", ("time", "nv"))
+
+    k = np.arange(n_records)
+    time[:] = (k + 0.5) * year
+    time_bounds[:, 0] = k * year
+    time_bounds[:, 1] = (k + 1) * year
+
+    for n, name in enumerate(names):
+        var = nc.createVariable(name, "f8", ("time", "y", "x"))
+        var.units = "m"
+        for r in range(n_records):
+            var[r, :, :] = [[exact(n, r, i, j) for i in range(len(x))] for j in range(len(y))]
+
+    nc.close()
+
+
+def allocate_field(grid, name):
+    field = PISM.IceModelVec2T()
+    field.set_n_records(buffer_size)
+    field.create(grid, name)
+    field.set_attrs("forcing", name, "m", "")
+    return field
+
+
+def values(field):
+    grid = field.get_grid()
+    result = {}
+    with PISM.vec.Access(nocomm=[field]):
+        for (i, j) in grid.points():
+            result[(i, j)] = field[i, j]
+    return result
+
+
+# times (in years) at which fields are updated: a sequence of short steps, a jump
+# forward (the buffer moves to a block that does not follow the current one), a jump
+# back, and then a few more short steps
+update_times = (list(np.arange(0.0, 12.0, 0.25)) + [18.0, 2.0] +
+                list(np.arange(2.25, 23.0, 0.5)))
+dt = 0.25
+
+
+def read_forcing(filename, names, prefetch):
+    """Read fields in names from filename, calling update() and interp() at
+    update_times. Returns values at every time."""
+    config = ctx.config
+    old_prefetch = config.get_boolean("climate_forcing.prefetch")
+    config.set_boolean("climate_forcing.prefetch", prefetch)
+
+    grid = allocate_grid()
+
+    try:
+        fields = [allocate_field(grid, name) for name in names]
+        for field in fields:
+            field.init(filename, 0, 0.0)
+
+        result = []
+        for t in update_times:
+            for field in fields:
+                field.update(t * year, dt * year)
+                field.interp((t + 0.5 * dt) * year)
+            result.append([values(field) for field in fields])
+    finally:
+        config.set_boolean("climate_forcing.prefetch", old_prefetch)
+
+    return result
+
+
+def check_exact(result):
+    for t, fields in zip(update_times, result):
+        k = int(np.floor(t + 0.5 * dt))
+        for n, field in enumerate(fields):
+            for (i, j), value in field.items():
+                assert abs(value - exact(n, k, i, j)) < 1e-9
+
+
+def prefetching_test():
+    """Results with and without prefetching are identical (bitwise) and match values
+    in the file, including after jumps of the buffer."""
+    filename = "forcing_prefetch.nc"
+    grid = allocate_grid()
+    create_forcing(grid, filename, ["a"])
+
+    try:
+        without = read_forcing(filename, ["a"], prefetch=False)
+        with_prefetch = read_forcing(filename, ["a"], prefetch=True)
+
+        assert with_prefetch == without
+        check_exact(with_prefetch)
+    finally:
+        os.remove(filename)
+
+
+def two_fields_test():
+    """Two fields read from the same file match the values in the file and the results
+    of reading each field on its own."""
+    filename = "forcing_two_fields.nc"
+    grid = allocate_grid()
+    create_forcing(grid, filename, ["a", "b"])
+
+    try:
+        for prefetch in [False, True]:
+            both = read_forcing(filename, ["a", "b"], prefetch)
+            a = read_forcing(filename, ["a"], prefetch)
+            b = read_forcing(filename, ["b"], prefetch)
+
+            assert [fields[0] for fields in both] == [fields[0] for fields in a]
+            assert [fields[1] for fields in both] == [fields[0] for fields in b]
+            check_exact(both)
+    finally:
+        os.remove(filename)
+
+
+def sharing_test():
+    """Fields using the same file and grid share the open file; it is closed once all of
+    them are gone."""
+    filename = "forcing_sharing.nc"
+    grid = allocate_grid()
+    create_forcing(grid, filename, ["a"])
+
+    try:
+        a = allocate_field(grid, "a")
+        a.init(filename, 0, 0.0)
+
+        # Replace the file with a different one (with "b" stored as "a"). The old file
+        # stays open, so a field sharing it still reads the old values...
+        create_forcing(grid, filename + ".tmp", ["b", "a"])
+        os.rename(filename + ".tmp", filename)
+
+        b = allocate_field(grid, "a")
+        b.init(filename, 0, 0.0)
+
+        t = 3.0
+        for field in [a, b]:
+            field.update(t * year, dt * year)
+            field.interp((t + 0.5 * dt) * year)
+
+        for field in [a, b]:
+            for (i, j), value in values(field).items():
+                assert value == exact(0, 3, i, j)
+
+        # ... while once both fields are gone the new file is opened.
+        del a, b
+
+        c = allocate_field(grid, "a")
+        c.init(filename, 0, 0.0)
+        c.update(t * year, dt * year)
+        c.interp((t + 0.5 * dt) * year)
+
+        for (i, j), value in values(c).items():
+            assert value == exact(1, 3, i, j)
+    finally:
+        os.remove(filename)
@@ -0,0 +1,121 @@
+import PISM
+
+"""Tests of the incremental iceberg detection in IcebergRemover.
+
+The first call of IcebergRemover::update() always labels connected components of the
+whole ice-covered area. Later calls use local checks of cells that changed and label
+components only if a change may have created an iceberg. Here we compare results of
+the incremental path (two calls) to full labeling (one call of a new IcebergRemover)."""
+
+ctx = PISM.Context()
+
+H0 = 200.0                      # ice thickness, meters
+grounded_bed = 100.0            # bed elevation of grounded cells, meters
+floating_bed = -1000.0          # bed elevation of floating cells, meters
+
+
+def allocate_grid():
+    return PISM.IceGrid_Shallow(ctx.ctx, 1e5, 1e5, 0, 0, 11, 11, PISM.CELL_CORNER, PISM.NOT_PERIODIC)
+
+
+def allocate_geometry(grid):
+    geometry = PISM.Geometry(grid)
+
+    geometry.cell_area.set(grid.dx() * grid.dy())
+    geometry.latitude.set(0.0)
+    geometry.longitude.set(0.0)
+    geometry.sea_level_elevation.set(0.0)
+    geometry.ice_area_specific_volume.set(0.0)
+
+    return geometry
+
+
+def set_state(geometry, ice, grounded):
+    """Set ice thickness to H0 at points in `ice` and zero elsewhere. Points in `grounded`
+    have the bed above sea level."""
+    grid = geometry.ice_thickness.get_grid()
+
+    with PISM.vec.Access(nocomm=[geometry.ice_thickness, geometry.bed_elevation]):
+        for (i, j) in grid.points():
+            geometry.ice_thickness[i, j] = H0 if (i, j) in ice else 0.0
+            geometry.bed_elevation[i, j] = grounded_bed if (i, j) in grounded else floating_bed
+
+    geometry.ensure_consistency(0.0)
+
+
+def remove_icebergs(states):
+    """Apply states (ice, grounded) in sequence, calling IcebergRemover::update() after
+    each one. Returns the resulting ice thickness."""
+    grid = allocate_grid()
+    geometry = allocate_geometry(grid)
+
+    remover = PISM.IcebergRemover(grid)
+    remover.init()
+
+    for ice, grounded in states:
+        set_state(geometry, ice, grounded)
+        remover.update(geometry.cell_type, geometry.ice_thickness)
+
+    result = PISM.IceModelVec2S()
+    result.create(grid, "thk", PISM.WITHOUT_GHOSTS)
+    result.copy_from(geometry.ice_thickness)
+
+    return result
+
+
+def compare(states):
+    "Compare incremental labeling (all states) to full labeling (last state only)."
+    incremental = remove_icebergs(states)
+    full = remove_icebergs(states[-1:])
+
+    diff = PISM.IceModelVec2S()
+    diff.create(incremental.get_grid(), "difference", PISM.WITHOUT_GHOSTS)
+    incremental.add(-1.0, full, diff)
+
+    assert diff.norm(PISM.PETSc.NormType.NORM_INFINITY) == 0.0
+
+    return full
+
+
+def ice_volume(thickness):
+    return thickness.sum()
+
+
+def isolated_grounded_cell_becomes_floating_test():
+    "A grounded cell with no icy neighbors becomes floating (a one-cell iceberg)"
+    ice = [(5, 5), (1, 1), (1, 2)]
+    grounded = [(5, 5), (1, 1), (1, 2)]
+
+    result = compare([(ice, grounded),
+                      (ice, [(1, 1), (1, 2)])])
+
+    # the new iceberg at (5, 5) is removed
+    assert ice_volume(result) == 2 * H0
+
+
+def grounded_cell_with_floating_neighbors_becomes_floating_test():
+    "A grounded cell with floating neighbors becomes floating; no grounded ice is left"
+    ice = [(5, 5), (5, 6), (6, 5)]
+
+    result = compare([(ice, [(5, 5)]),
+                      (ice, [])])
+
+    assert ice_volume(result) == 0.0
+
+
+def ungrounding_next_to_grounded_ice_test():
+    "A grounded cell next to grounded ice becomes floating (no icebergs)"
+    ice = [(5, 5), (5, 6), (6, 5), (4, 5)]
+
+    result = compare([(ice, [(5, 5), (4, 5)]),
+                      (ice, [(4, 5)])])
+
+    assert ice_volume(result) == len(ice) * H0
+
+
+def isolated_grounded_cell_is_removed_test():
+    "An isolated grounded cell becomes ice-free"
+    result = compare([([(5, 5), (1, 1)], [(5, 5), (1, 1)]),
+                      ([(1, 1)], [(5, 5), (1, 1)])])
+
+    assert ice_volume(result) == H0
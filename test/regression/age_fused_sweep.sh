@@ -0,0 +1,45 @@
+#!/bin/bash
+
+# Check that updating age in the same column sweep as the energy model (-age_fused_sweep)
+# gives the same age as the separate age update.
+#
+# pisms uses the enthalpy model (which fuses the sweep); pismv uses the temperature-based
+# model (which updates age separately when asked to do it during the energy step).
+
+PISM_PATH=$1
+MPIEXEC=$2
+PISM_SOURCE_DIR=$3
+
+# List of files to remove when done:
+files="age-separate.nc age-fused.nc age-verif-separate.nc age-verif-fused.nc"
+
+rm -f $files
+
+set -e
+
+mpi="$MPIEXEC -n 2"
+
+options="-Mx 21 -My 21 -Mz 31 -Lz 5000 -energy enthalpy -age -y 2000 -verbose 1 -o_size big"
+${mpi} $PISM_PATH/pisms ${options} -o age-separate.nc
+${mpi} $PISM_PATH/pisms ${options} -age_fused_sweep -o age-fused.nc
+
+options="-test G -Mx 21 -My 21 -Mz 31 -age -y 1000 -verbose 1 -o_size big"
+${mpi} $PISM_PATH/pismv ${options} -o age-verif-separate.nc
+${mpi} $PISM_PATH/pismv ${options} -age_fused_sweep -o age-verif-fused.nc
+
+set +e
+
+# Compare results:
+$PISM_PATH/nccmp.py -t 1e-6 -v age,enthalpy age-separate.nc age-fused.nc
+if [ $? != 0 ];
+then
+    exit 1
+fi
+
+$PISM_PATH/nccmp.py -t 1e-6 -v age,temp age-verif-separate.nc age-verif-fused.nc
+if [ $? != 0 ];
+then
+    exit 1
+fi
+
+rm -f $files; exit 0
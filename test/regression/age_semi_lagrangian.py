@@ -0,0 +1,67 @@
+#!/usr/bin/env python
+
+# Compare the age computed using the semi-Lagrangian scheme to the one computed using the
+# default (upwinding) scheme.
+#
+# The energy balance model is disabled, so the semi-Lagrangian run is not restricted by the
+# 3D CFL condition. Both schemes are first order, so results are compared using a loose
+# tolerance.
+
+from sys import exit, argv, stderr
+from os import system
+from numpy import abs, squeeze
+
+try:
+    from netCDF4 import Dataset as NC
+except:
+    print "netCDF4 is not installed!"
+    exit(1)
+
+pism_path = argv[1]
+mpiexec = argv[2]
+
+stderr.write("Testing: semi-Lagrangian age transport.\n")
+
+files = ["age-sl-input.nc", "age-sl-explicit.nc", "age-sl-semi-lagrangian.nc"]
+
+grid = "-Mx 31 -My 31 -Mz 31 -Lz 5000"
+
+cmd = "%s %s/pisms -eisII A %s -y 3000 -verbose 1 -o %s" % (mpiexec, pism_path, grid, files[0])
+stderr.write(cmd + '\n')
+if system(cmd) != 0:
+    exit(1)
+
+options = "-energy none -age -y 2000 -verbose 1 -o_size big"
+for (output, extra) in [(files[1], ""), (files[2], "-age_semi_lagrangian")]:
+    cmd = "%s %s/pismr -i %s %s %s -o %s" % (mpiexec, pism_path, files[0], options, extra, output)
+    stderr.write(cmd + '\n')
+    if system(cmd) != 0:
+        exit(1)
+
+
+def age(filename):
+    "Return age (in years) and ice thickness."
+    nc = NC(filename)
+    result = squeeze(nc.variables['age'][:]), squeeze(nc.variables['thk'][:])
+    nc.close()
+    return result
+
+age_explicit, H = age(files[1])
+age_sl, _ = age(files[2])
+
+# compare in columns with at least 1000 m of ice
+mask = H > 1000.0
+a = age_explicit[mask]
+b = age_sl[mask]
+
+mean_difference = abs(a.mean() - b.mean()) / a.mean()
+max_difference = abs(a - b).max() / a.max()
+
+stderr.write("relative difference of mean age: %f\n" % mean_difference)
+stderr.write("maximum difference relative to maximum age: %f\n" % max_difference)
+
+if mean_difference > 0.05 or max_difference > 0.2:
+    exit(1)
+
+system("rm -f " + " ".join(files))
+exit(0)
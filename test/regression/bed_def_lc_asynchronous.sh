@@ -0,0 +1,80 @@
+#!/bin/bash
+
+# Compare asynchronous Lingle-Clark bed deformation updates to synchronous ones.
+#
+# In the asynchronous mode the bed elevation lags by one bed deformation update, but
+# pending updates are finished before anything is saved. With the stress balance disabled
+# ice thickness does not depend on the bed elevation, so saved fields have to match the
+# synchronous run (the lag is visible between saves only).
+#
+# Extra files are saved every 5 updates, so that the asynchronous run does not finish every
+# update right away.
+#
+# With the SIA ice thickness does depend on the bed elevation. Pending updates are finished
+# before saving and the model uses them right away, so asynchronous results depend on
+# output times (see bed_deformation.lc.asynchronous). These runs (one with extra files
+# saved every 500 years, one every 100 years) are compared to the synchronous run using a
+# relative tolerance.
+
+PISM_PATH=$1
+MPIEXEC=$2
+PISM_SOURCE_DIR=$3
+
+# List of files to remove when done:
+files="out0.nc sync.nc async.nc ex-sync.nc ex-async.nc sia-sync.nc sia-async-500.nc sia-async-100.nc ex-sia-*.nc"
+
+rm -f $files
+
+set -e
+
+mpi="$MPIEXEC -n 2"
+pisms="$PISM_PATH/pisms"
+pismr="$PISM_PATH/pismr"
+
+# time step length
+dt=100
+# use a non-square grid
+Mx=21
+My=31
+options="-bed_def lc -bed_def_lc_elastic_model -extra_times 500 -extra_vars dbdt,topg,thk -stress_balance none -energy none -calendar none -bed_deformation.update_interval 1 -max_dt ${dt}"
+
+grid="-Lz 5000 -Mz 3 -Mx ${Mx} -My ${My}"
+
+# create the input file
+${mpi} ${pisms} ${grid} -y 1000 -o out0.nc -verbose 1
+
+${mpi} ${pismr} ${options} -bootstrap ${grid} -i out0.nc -o sync.nc -extra_file ex-sync.nc -ys 0 -ye 2000
+${mpi} ${pismr} ${options} -bed_def_lc_asynchronous -bootstrap ${grid} -i out0.nc -o async.nc -extra_file ex-async.nc -ys 0 -ye 2000
+
+sia_options="-bed_def lc -bed_def_lc_elastic_model -extra_vars topg,thk -stress_balance sia -energy none -calendar none -bed_deformation.update_interval 1 -max_dt ${dt}"
+
+${mpi} ${pismr} ${sia_options} -bootstrap ${grid} -i out0.nc -o sia-sync.nc -extra_file ex-sia-sync.nc -extra_times 500 -ys 0 -ye 2000
+${mpi} ${pismr} ${sia_options} -bed_def_lc_asynchronous -bootstrap ${grid} -i out0.nc -o sia-async-500.nc -extra_file ex-sia-async-500.nc -extra_times 500 -ys 0 -ye 2000
+${mpi} ${pismr} ${sia_options} -bed_def_lc_asynchronous -bootstrap ${grid} -i out0.nc -o sia-async-100.nc -extra_file ex-sia-async-100.nc -extra_times 100 -ys 0 -ye 2000
+
+set +e
+
+# Compare results:
+$PISM_PATH/nccmp.py -t 1e-12 -v dbdt,topg ex-sync.nc ex-async.nc
+if [ $? != 0 ];
+then
+    exit 1
+fi
+
+$PISM_PATH/nccmp.py -t 1e-12 -v dbdt,topg sync.nc async.nc
+if [ $? != 0 ];
+then
+    exit 1
+fi
+
+# Asynchronous SIA runs are not identical to the synchronous one (or to each other).
+for output in sia-async-500.nc sia-async-100.nc;
+do
+    $PISM_PATH/nccmp.py -r -t 1e-2 -v thk,topg sia-sync.nc ${output}
+    if [ $? != 0 ];
+    then
+        exit 1
+    fi
+done
+
+rm -f $files; exit 0
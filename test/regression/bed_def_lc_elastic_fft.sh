@@ -0,0 +1,43 @@
+#!/bin/bash
+
+# Compare the elastic response of the Lingle-Clark bed deformation model computed using FFT
+# to the one computed using direct 2D convolution.
+
+PISM_PATH=$1
+MPIEXEC=$2
+PISM_SOURCE_DIR=$3
+
+# List of files to remove when done:
+files="out0.nc direct.nc fft.nc lc_load_response_*.nc"
+
+rm -f $files
+
+set -e
+
+mpi="$MPIEXEC -n 2"
+pisms="$PISM_PATH/pisms"
+pismr="$PISM_PATH/pismr"
+
+# use a non-square grid
+Mx=21
+My=31
+options="-bed_def lc -bed_def_lc_elastic_model -stress_balance none -energy none -calendar none -bed_deformation.update_interval 1 -max_dt 100"
+
+grid="-Lz 5000 -Mz 3 -Mx ${Mx} -My ${My}"
+
+# create the input file
+${mpi} ${pisms} ${grid} -y 1000 -o out0.nc -verbose 1
+
+${mpi} ${pismr} ${options} -bed_def_lc_elastic_model_fft false -bootstrap ${grid} -i out0.nc -o direct.nc -ys 0 -ye 500
+${mpi} ${pismr} ${options} -bed_def_lc_elastic_model_fft true -bootstrap ${grid} -i out0.nc -o fft.nc -ys 0 -ye 500
+
+set +e
+
+# Compare results:
+$PISM_PATH/nccmp.py -t 1e-6 -v topg,dbdt direct.nc fft.nc
+if [ $? != 0 ];
+then
+    exit 1
+fi
+
+rm -f $files; exit 0
@@ -0,0 +1,43 @@
+#!/bin/bash
+
+# Check that the Lingle-Clark bed deformation model produces the same results on one and
+# three MPI processes. The second run reads the elastic load response matrix saved by the
+# first one.
+
+PISM_PATH=$1
+MPIEXEC=$2
+PISM_SOURCE_DIR=$3
+
+# List of files to remove when done:
+files="out0.nc serial.nc parallel.nc lc_load_response_*.nc"
+
+rm -f $files
+
+set -e
+
+pisms="$PISM_PATH/pisms"
+pismr="$PISM_PATH/pismr"
+
+# use a non-square grid
+Mx=21
+My=31
+options="-bed_def lc -bed_def_lc_elastic_model -bed_def_lc_elastic_model_cache -stress_balance none -energy none -calendar none -bed_deformation.update_interval 1 -max_dt 100"
+
+grid="-Lz 5000 -Mz 3 -Mx ${Mx} -My ${My}"
+
+# create the input file
+$MPIEXEC -n 2 ${pisms} ${grid} -y 1000 -o out0.nc -verbose 1
+
+$MPIEXEC -n 1 ${pismr} ${options} -bootstrap ${grid} -i out0.nc -o serial.nc -ys 0 -ye 500
+$MPIEXEC -n 3 ${pismr} ${options} -bootstrap ${grid} -i out0.nc -o parallel.nc -ys 0 -ye 500
+
+set +e
+
+# Compare results:
+$PISM_PATH/nccmp.py -t 1e-6 -v topg,dbdt,viscous_bed_displacement serial.nc parallel.nc
+if [ $? != 0 ];
+then
+    exit 1
+fi
+
+rm -f $files; exit 0
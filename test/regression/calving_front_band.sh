@@ -0,0 +1,38 @@
+#!/bin/bash
+
+# Check that restricting calving front retreat computations to the narrow band near the
+# calving front does not change results. Uses eigen-calving on an advancing and calving
+# ice shelf (the front moves during the run) on 2 MPI processes.
+
+PISM_PATH=$1
+MPIEXEC=$2
+PISM_SOURCE_DIR=$3
+
+# List of files to remove when done:
+files="circular_input.nc band.nc whole_domain.nc"
+
+rm -f $files
+
+set -e
+set -x
+
+python ${PISM_SOURCE_DIR}/examples/marine/circular/circular_dirichlet.py \
+       -Mx 51 -My 51 -o circular_input.nc
+
+options="-i circular_input.nc -bootstrap -Mx 51 -My 51 -Mz 3 -Lz 1500 \
+ -stress_balance ssa -ssa_method fd -ssa_dirichlet_bc -cfbc -part_grid -energy none \
+ -calving eigen_calving -eigen_calving_K 1e15 -calving_cfl -y 100 -verbose 1"
+
+$MPIEXEC -n 2 $PISM_PATH/pismr $options -o band.nc
+$MPIEXEC -n 2 $PISM_PATH/pismr $options -calving_narrow_band false -o whole_domain.nc
+
+set +e
+
+# Compare results:
+$PISM_PATH/nccmp.py -v thk,mask,ice_area_specific_volume band.nc whole_domain.nc
+if [ $? != 0 ];
+then
+    exit 1
+fi
+
+rm -f $files; exit 0
@@ -0,0 +1,109 @@
+#!/usr/bin/env python
+
+# Compares results of the fused explicit sub-step of the 'routing' hydrology model to
+# results obtained using separate (field-based) passes. The discretization is the same,
+# so water thicknesses, the water velocity, and the boundary mass accounting should
+# match up to rounding errors.
+
+import subprocess
+import shutil
+import shlex
+import os
+from sys import exit
+from netCDF4 import Dataset as NC
+import numpy as np
+
+
+def process_arguments():
+    from argparse import ArgumentParser
+    parser = ArgumentParser()
+    parser.add_argument("PISM_PATH")
+    parser.add_argument("MPIEXEC")
+    parser.add_argument("PISM_SOURCE_DIR")
+
+    return parser.parse_args()
+
+
+def copy_input(opts):
+    shutil.copy(os.path.join(opts.PISM_SOURCE_DIR, "test/test_hydrology/inputforP_regression.nc"), ".")
+
+
+# (value of hydrology.fused_explicit_step, output file, extra file, time series file)
+runs = [("yes", "routing-fused.nc", "ex-routing-fused.nc", "ts-routing-fused.nc"),
+        ("no",  "routing-fields.nc", "ex-routing-fields.nc", "ts-routing-fields.nc")]
+
+
+def run_pism(opts, fused, output, extra, ts):
+    cmd = ("%s -n 2 %s/pismr -i inputforP_regression.nc -bootstrap -Mx 21 -My 21 -Mz 11 -Lz 4000 "
+           "-hydrology routing -hydrology_fused_explicit_step %s "
+           "-hydrology_use_const_bmelt -hydrology_const_bmelt 3.1689e-9 -hydrology_null_strip_width 20e3 "
+           "-y 0.08333333333333 -max_dt 0.01 -no_mass -energy none -stress_balance ssa+sia -ssa_dirichlet_bc "
+           "-extra_file %s -extra_times 0.08333333333333 -extra_vars bwat,tillwat,bwatvel "
+           "-ts_file %s -ts_times 0:0.01:0.08333333333333 "
+           "-ts_vars hydro_ice_free_land_loss,hydro_ocean_loss,hydro_negative_thickness_gain,hydro_null_strip_loss "
+           "-o %s") % (opts.MPIEXEC, opts.PISM_PATH, fused, extra, ts, output)
+
+    print cmd
+    if subprocess.call(shlex.split(cmd)) != 0:
+        print "PISM failed (hydrology.fused_explicit_step = %s)" % fused
+        exit(1)
+
+
+def compare(file1, file2, variables, tolerance):
+    "Compare variables in two files; differences are relative to the maximum absolute value."
+    nc1 = NC(file1)
+    nc2 = NC(file2)
+
+    success = True
+    for name in variables:
+        var1 = np.array(nc1.variables[name][:], dtype=np.float64)
+        var2 = np.array(nc2.variables[name][:], dtype=np.float64)
+
+        scale = max(np.max(np.abs(var1)), np.max(np.abs(var2)))
+        diff = np.max(np.abs(var1 - var2))
+        if scale > 0.0:
+            diff /= scale
+
+        print "%s: max |value| = %e, relative difference = %e" % (name, scale, diff)
+        if diff > tolerance:
+            print "  FAIL: %s differs (tolerance: %e)" % (name, tolerance)
+            success = False
+
+    nc1.close()
+    nc2.close()
+
+    return success
+
+
+def cleanup():
+    files = ["inputforP_regression.nc"]
+    for run in runs:
+        files += list(run[1:])
+    for fname in files:
+        os.remove(fname)
+
+if __name__ == "__main__":
+    opts = process_arguments()
+
+    print "Copying input files..."
+    copy_input(opts)
+
+    for fused, output, extra, ts in runs:
+        print "Running PISM (hydrology.fused_explicit_step = %s)..." % fused
+        run_pism(opts, fused, output, extra, ts)
+
+    _, output1, extra1, ts1 = runs[0]
+    _, output2, extra2, ts2 = runs[1]
+
+    print "Comparing results..."
+    success = True
+    success &= compare(output1, output2, ["bwat", "tillwat"], 1e-12)
+    success &= compare(extra1, extra2, ["bwatvel[0]", "bwatvel[1]"], 1e-10)
+    success &= compare(ts1, ts2, ["hydro_ice_free_land_loss", "hydro_ocean_loss",
+                                  "hydro_negative_thickness_gain", "hydro_null_strip_loss"], 1e-10)
+
+    if not success:
+        exit(1)
+
+    print "Cleaning up..."
+    cleanup()
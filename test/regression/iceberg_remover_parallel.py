@@ -0,0 +1,133 @@
+#!/usr/bin/env python
+
+"""Check that iceberg removal (parallel connected component labeling) produces the same
+results on 1, 2, 3 and 4 MPI processes. Icebergs and ice shelves in the input file cross
+sub-domain boundaries; one of the icebergs is a "C" whose ends are connected only through
+other sub-domains."""
+
+import subprocess
+import shlex
+import os
+from sys import exit
+from netCDF4 import Dataset as NC
+import numpy as np
+
+M = 41
+L = 200e3                       # half-width of the domain, meters
+H0 = 500.0                      # ice thickness, meters
+
+
+def process_arguments():
+    from argparse import ArgumentParser
+    parser = ArgumentParser()
+    parser.add_argument("PISM_PATH")
+    parser.add_argument("MPIEXEC")
+    parser.add_argument("PISM_SOURCE_DIR")
+
+    return parser.parse_args()
+
+
+def geometry():
+    """Returns ice thickness, bed elevation, and the mask of cells that have to keep
+    their ice (grounded ice and ice shelves attached to it)."""
+    thk = np.zeros((M, M))
+    topg = np.zeros((M, M)) - 1000.0
+    kept = np.zeros((M, M), dtype=bool)
+
+    c = M // 2
+    for j in range(M):
+        for i in range(M):
+            d = max(abs(i - c), abs(j - c))
+            # grounded island in the middle
+            if d <= 3:
+                topg[j, i] = 100.0
+                kept[j, i] = True
+            # an ice shelf attached to it, crossing the whole domain
+            if j == c and abs(i - c) <= 10:
+                kept[j, i] = True
+            # a ring-shaped iceberg
+            if d == 15:
+                thk[j, i] = H0
+            # a "C"-shaped iceberg
+            if d == 12 and not (i > c and abs(j - c) <= 2):
+                thk[j, i] = H0
+
+    # a grounded cell next to the edge of the domain with an attached shelf
+    topg[M - 3, c] = 100.0
+    kept[M - 3, c - 8:c + 9] = True
+
+    thk[kept] = H0
+
+    return thk, topg, kept
+
+
+def create_input(filename):
+    thk, topg, _ = geometry()
+
+    x = np.linspace(-L, L, M)
+
+    nc = NC(filename, 'w')
+    nc.createDimension("x", M)
+    nc.createDimension("y", M)
+
+    for name in ["x", "y"]:
+        var = nc.createVariable(name, 'f8', (name,))
+        var.units = "m"
+        var[:] = x
+
+    def add(name, units, data):
+        var = nc.createVariable(name, 'f8', ("y", "x"))
+        var.units = units
+        var[:] = data
+
+    add("thk", "m", thk)
+    add("topg", "m", topg)
+    add("climatic_mass_balance", "kg m-2 s-1", np.zeros((M, M)))
+    add("ice_surface_temp", "K", np.zeros((M, M)) + 260.0)
+
+    nc.close()
+
+
+def run_pism(opts, N, output):
+    cmd = "%s -n %d %s/pismr -i icebergs_input.nc -bootstrap -Mx %d -My %d -Mz 3 -Lz 1000 -kill_icebergs -stress_balance none -energy none -ys 0 -ye 1 -max_dt 1 -verbose 1 -o %s" % (opts.MPIEXEC, N, opts.PISM_PATH, M, M, output)
+
+    print cmd
+    if subprocess.call(shlex.split(cmd)) != 0:
+        print "PISM failed (%d processes)" % N
+        exit(1)
+
+
+def read_thickness(filename):
+    nc = NC(filename)
+    result = np.squeeze(nc.variables["thk"][:])
+    nc.close()
+    return result
+
+
+if __name__ == "__main__":
+    opts = process_arguments()
+
+    outputs = dict((N, "icebergs_%d.nc" % N) for N in [1, 2, 3, 4])
+
+    print "Creating the input file..."
+    create_input("icebergs_input.nc")
+
+    for N in sorted(outputs.keys()):
+        run_pism(opts, N, outputs[N])
+
+    serial = read_thickness(outputs[1])
+
+    _, _, kept = geometry()
+
+    if np.any(serial[~kept] != 0.0) or np.any(serial[kept] <= 0.0):
+        print "Serial run: icebergs were not removed correctly"
+        exit(1)
+
+    for N in sorted(outputs.keys()):
+        if np.any(read_thickness(outputs[N]) != serial):
+            print "Ice thickness on %d processes differs from the serial run" % N
+            exit(1)
+
+    print "Cleaning up..."
+    for filename in ["icebergs_input.nc"] + outputs.values():
+        os.remove(filename)
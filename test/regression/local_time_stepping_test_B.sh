@@ -0,0 +1,94 @@
+#!/bin/bash
+
+PISM_PATH=$1
+MPIEXEC=$2
+
+# Test name:
+echo "Test: local time stepping matches the global-step run and takes steps longer than the explicit limit."
+# The list of files to delete when done.
+files="lts-global.nc lts-multirate.nc ts-lts-global.nc ts-lts-multirate.nc"
+
+rm -f $files
+GRID="-Mx 31 -My 31 -Mz 31 -y 5000 -ys 1000"
+OPTS="-test B -o_size small -verbose 1 -ts_times 1000:10:6000 -ts_vars dt,max_diffusivity"
+
+set -x
+
+# reference: every cell uses the global (CFL and diffusivity limited) time step
+$MPIEXEC -n 2 $PISM_PATH/pismv $GRID $OPTS -o lts-global.nc \
+         -ts_file ts-lts-global.nc || exit 1
+
+# cells limiting the time step are sub-cycled; the global step is up to 4 times longer
+$MPIEXEC -n 2 $PISM_PATH/pismv $GRID $OPTS -o lts-multirate.nc \
+         -local_time_stepping -local_time_stepping_max_level 2 \
+         -ts_file ts-lts-multirate.nc || exit 1
+
+set +x
+
+/usr/bin/env python <<EOF2
+from sys import exit
+from numpy import fabs
+try:
+    from netCDF3 import Dataset
+except:
+    from netCDF4 import Dataset
+
+def thickness(filename):
+    nc = Dataset(filename, 'r')
+    result = nc.variables['thk'][-1]
+    nc.close()
+    return result
+
+def step_ratio(filename, dx, dy):
+    "Ratio of the time step length to the explicit (diffusivity) limit."
+    nc = Dataset(filename, 'r')
+    dt = nc.variables['dt'][:] * 365.2421988 * 86400 # years to seconds
+    D_max = nc.variables['max_diffusivity'][:]
+    nc.close()
+    # see IceModel::max_timestep_diffusivity()
+    dt_explicit = 0.12 * 2.0 / (D_max * (1.0 / dx**2 + 1.0 / dy**2))
+    return (dt / dt_explicit)[D_max > 0]
+
+success = True
+
+# difference between the two runs
+H_global = thickness("lts-global.nc")
+H_multirate = thickness("lts-multirate.nc")
+
+max_diff = fabs(H_global - H_multirate).max()
+mean_diff = fabs(H_global - H_multirate).mean()
+H_max = H_global.max()
+
+print "thickness difference: max %f m, mean %f m (max thickness %f m)" % (max_diff, mean_diff, H_max)
+if max_diff > 0.02 * H_max or mean_diff > 0.002 * H_max:
+    print "  FAIL: local time stepping deviates from the global-step run"
+    success = False
+
+# time step lengths relative to the explicit limit
+nc = Dataset("lts-global.nc", 'r')
+x = nc.variables['x'][:]
+y = nc.variables['y'][:]
+nc.close()
+dx = x[1] - x[0]
+dy = y[1] - y[0]
+
+global_ratio = step_ratio("ts-lts-global.nc", dx, dy)
+multirate_ratio = step_ratio("ts-lts-multirate.nc", dx, dy)
+
+print "dt / (explicit limit): global run max %f, multirate run max %f" % (global_ratio.max(), multirate_ratio.max())
+if global_ratio.max() > 1.01:
+    print "  FAIL: the global-step run exceeded the explicit limit"
+    success = False
+if multirate_ratio.max() < 1.5:
+    print "  FAIL: local time stepping did not take steps longer than the explicit limit"
+    success = False
+
+exit(0 if success else 1)
+EOF2
+
+if [ $? != 0 ];
+then
+    exit 1
+fi
+
+rm -f $files; exit 0
@@ -0,0 +1,68 @@
+#!/bin/bash
+
+PISM_PATH=$1
+MPIEXEC=$2
+
+# Test name:
+echo "Test: semi-implicit SIA reproduces the exact solution of test B."
+# The list of files to delete when done.
+files="errors-sia-explicit.nc errors-sia-implicit.nc"
+
+rm -f $files
+GRID="-Mx 31 -My 31 -Mz 31 -y 5000 -ys 1000"
+OPTS="-test B -o_size none -verbose 1"
+
+set -x
+
+# reference: explicit SIA with the usual diffusivity time step restriction
+$MPIEXEC -n 2 $PISM_PATH/pismv $GRID $OPTS -report_file errors-sia-explicit.nc || exit 1
+
+# Note: -max_dt 100 exceeds the explicit (diffusivity) time step restriction.
+$MPIEXEC -n 2 $PISM_PATH/pismv $GRID $OPTS -implicit_sia -max_dt 100 \
+         -report_file errors-sia-implicit.nc || exit 1
+
+set +x
+
+/usr/bin/env python <<EOF2
+from sys import exit
+try:
+    from netCDF3 import Dataset
+except:
+    from netCDF4 import Dataset
+
+def errors(filename):
+    nc = Dataset(filename, 'r')
+    result = dict((name, abs(nc.variables[name][-1]))
+                  for name in ["relative_volume", "maximum_thickness",
+                               "average_thickness", "relative_max_eta"])
+    nc.close()
+    return result
+
+explicit = errors("errors-sia-explicit.nc")
+implicit = errors("errors-sia-implicit.nc")
+
+# Absolute bounds on errors relative to the exact solution and bounds
+# relative to the explicit run (the semi-implicit scheme is first order
+# in time and uses 100-year steps, so its errors may be somewhat larger).
+absolute = {"relative_volume" : 1.0,     # percent
+            "maximum_thickness" : 100.0, # meters
+            "average_thickness" : 10.0,  # meters
+            "relative_max_eta" : 0.05}
+
+success = True
+for name in sorted(absolute.keys()):
+    limit = min(absolute[name], 2.0 * explicit[name] + 0.1 * absolute[name])
+    print "%s: explicit %f, implicit %f, limit %f" % (name, explicit[name], implicit[name], limit)
+    if implicit[name] > limit:
+        print "  FAIL: %s error exceeds %f" % (name, limit)
+        success = False
+
+exit(0 if success else 1)
+EOF2
+
+if [ $? != 0 ];
+then
+    exit 1
+fi
+
+rm -f $files; exit 0
@@ -0,0 +1,77 @@
+#!/bin/bash
+
+# SSAFD verification test I: mixed precision iterative refinement (single precision ILU(0)
+# preconditioner for inner solves) reproduces the double precision solve.
+
+PISM_PATH=$1
+MPIEXEC=$2
+MPIEXEC_COMMAND="$MPIEXEC -n 2"
+PISM_SOURCE_DIR=$3
+EXT=""
+if [ $# -ge 4 ] && [ "$4" == "-python" ]
+then
+  PYTHONEXEC=$5
+  MPIEXEC_COMMAND="$MPIEXEC_COMMAND $PYTHONEXEC"
+  PYTHONPATH=${PISM_PATH}/site-packages:${PYTHONPATH}
+  PISM_PATH=${PISM_SOURCE_DIR}/examples/python/ssa_tests
+  EXT=".py"
+fi
+
+# List of files to remove when done:
+files="foo-fd-i-double.nc foo-fd-i-double.nc~ foo-fd-i-mixed.nc foo-fd-i-mixed.nc~ test-I-out-mixed.txt"
+
+rm -f $files
+
+set -e
+set -x
+
+OPTS="-ssa_method fd -ssa_rtol 5e-07 -ssafd_ksp_rtol 1e-10 -Mx 5 -My 61"
+
+# double precision solves
+$MPIEXEC_COMMAND $PISM_PATH/ssa_testi${EXT} $OPTS -verbose 1 -o foo-fd-i-double.nc
+
+# mixed precision iterative refinement
+$MPIEXEC_COMMAND $PISM_PATH/ssa_testi${EXT} $OPTS -verbose 2 -o foo-fd-i-mixed.nc \
+                 -ssafd_iterative_refinement > test-I-out-mixed.txt
+
+set +e
+
+# Make sure that iterative refinement was used:
+grep -q "using mixed precision iterative refinement" test-I-out-mixed.txt || exit 1
+
+# Compare velocities. Both runs solve each linear system to the relative tolerance
+# -ssafd_ksp_rtol 1e-10; the difference between solutions is bounded by this tolerance
+# times the condition number of the system, so allow a relative difference of 1e-6.
+/usr/bin/env python <<EOF2
+from sys import exit
+from numpy import fabs
+try:
+    from netCDF3 import Dataset
+except:
+    from netCDF4 import Dataset
+
+def velocity(filename):
+    nc = Dataset(filename, 'r')
+    result = [nc.variables[name][:] for name in ["ubar", "vbar"]]
+    nc.close()
+    return result
+
+double = velocity("foo-fd-i-double.nc")
+mixed = velocity("foo-fd-i-mixed.nc")
+
+scale = max(fabs(double[0]).max(), fabs(double[1]).max())
+diff = max(fabs(double[0] - mixed[0]).max(), fabs(double[1] - mixed[1]).max())
+
+print "max. velocity difference: %e m/year (max. velocity %e m/year)" % (diff, scale)
+if diff > 1e-6 * scale:
+    print "  FAIL: mixed precision and double precision solutions differ"
+    exit(1)
+exit(0)
+EOF2
+
+if [ $? != 0 ];
+then
+    exit 1
+fi
+
+rm -f $files; exit 0
@@ -0,0 +1,51 @@
+#!/bin/bash
+
+# SSAFEM verification test I regression test (matrix-free Newton steps)
+
+PISM_PATH=$1
+MPIEXEC=$2
+MPIEXEC_COMMAND="$MPIEXEC -n 2"
+PISM_SOURCE_DIR=$3
+EXT=""
+if [ $# -ge 4 ] && [ "$4" == "-python" ]
+then
+  PYTHONEXEC=$5
+  MPIEXEC_COMMAND="$MPIEXEC_COMMAND $PYTHONEXEC"
+  PYTHONPATH=${PISM_PATH}/site-packages:${PYTHONPATH}
+  PISM_PATH=${PISM_SOURCE_DIR}/examples/python/ssa_tests
+  EXT=".py"
+fi
+
+# List of files to remove when done:
+files="foo-fem-mf-i.nc foo-fem-mf-i.nc~ test-I-out-fem-mf.txt"
+
+rm -f $files
+
+set -e
+
+OPTS="-verbose 1 -ssa_method fem -ssafem_matrix_free -o foo-fem-mf-i.nc -Mx 5"
+
+# do stuff
+$MPIEXEC_COMMAND $PISM_PATH/ssa_testi${EXT} -My 61 $OPTS > test-I-out-fem-mf.txt
+$MPIEXEC_COMMAND $PISM_PATH/ssa_testi${EXT} -My 121 $OPTS >> test-I-out-fem-mf.txt
+
+set +e
+
+# Check results:
+diff test-I-out-fem-mf.txt -  <<END-OF-OUTPUT
+NUMERICAL ERRORS in velocity relative to exact solution:
+velocity  :  maxvector   prcntavvec      maxu      maxv       avu       avv
+               16.2024      0.14888   16.2024    0.7544    1.1522    0.0513
+NUM ERRORS DONE
+NUMERICAL ERRORS in velocity relative to exact solution:
+velocity  :  maxvector   prcntavvec      maxu      maxv       avu       avv
+                4.2045      0.03669    4.2045    0.1967    0.2838    0.0134
+NUM ERRORS DONE
+END-OF-OUTPUT
+
+if [ $? != 0 ];
+then
+    exit 1
+fi
+
+rm -f $files; exit 0
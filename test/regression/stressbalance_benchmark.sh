@@ -0,0 +1,47 @@
+#!/bin/bash
+
+# Runs a (small) stress balance benchmark and checks that results are
+# saved in a valid JSON file.
+
+PISM_PATH=$1
+MPIEXEC=$2
+PISM_SOURCE_DIR=$3
+
+# List of files to remove when done:
+files="stressbalance_benchmark.json"
+
+rm -f $files
+
+set -e
+set -x
+
+${PISM_SOURCE_DIR}/util/stressbalance_benchmark.py \
+  --bin-dir ${PISM_PATH} --mpiexec ${MPIEXEC} \
+  --solvers ssafd,ssafem,siafd --sizes 31 --ranks 1,2 \
+  --output stressbalance_benchmark.json
+
+set +e
+
+# Check results:
+/usr/bin/env python <<EOF_PYTHON
+import json, sys
+
+results = json.load(open("stressbalance_benchmark.json"))["benchmarks"]
+
+if len(results) != 6:
+    sys.exit(1)
+
+for r in results:
+    for key in ["solver", "ranks", "total_time", "memory_max_per_rank_MiB"]:
+        if key not in r:
+            sys.exit(1)
+    if r["solver"] != "SIAFD" and r["nonlinear_iterations"] <= 0:
+        sys.exit(1)
+EOF_PYTHON
+
+if [ $? != 0 ];
+then
+    exit 1
+fi
+
+rm -f $files; exit 0
@@ -72,14 +72,16 @@ def generate_config():
     nc.close()
 
 
-def run_pism(opts):
-    cmd = "%s %s/pismr -config_override testPconfig.nc -i inputforP_regression.nc -bootstrap -Mx %d -My %d -Mz 11 -Lz 4000 -hydrology distributed -report_mass_accounting -y 0.08333333333333 -max_dt 0.01 -no_mass -energy none -stress_balance ssa+sia -ssa_dirichlet_bc -o end.nc" % (opts.MPIEXEC, opts.PISM_PATH, 21, 21)
+def run_pism(opts, method, output):
+    cmd = "%s %s/pismr -config_override testPconfig.nc -i inputforP_regression.nc -bootstrap -Mx %d -My %d -Mz 11 -Lz 4000 -hydrology distributed -hydrology_time_integration %s -report_mass_accounting -y 0.08333333333333 -max_dt 0.01 -no_mass -energy none -stress_balance ssa+sia -ssa_dirichlet_bc -o %s" % (opts.MPIEXEC, opts.PISM_PATH, 21, 21, method, output)
 
     print cmd
-    subprocess.call(shlex.split(cmd))
+    if subprocess.call(shlex.split(cmd)) != 0:
+        print "PISM failed (time integration method: %s)" % method
+        exit(1)
 
 
-def check_drift(file1, file2):
+def check_drift(file1, file2, tolerance):
     nc1 = NC(file1)
     nc2 = NC(file2)
 
@@ -103,13 +105,22 @@ def check_drift(file1, file2):
     for name in drift.keys():
         rel_diff = np.abs(stored_drift[name] - drift[name]) / stored_drift[name]
 
-        if rel_diff > 1e-3:
+        if rel_diff > tolerance:
             print "Stored and computed drifts in %s differ: %f != %f" % (name, stored_drift[name], drift[name])
             exit(1)
 
 
+# Time integration methods, output files, and relative tolerances used to compare drifts
+# to stored ones (computed using the explicit method). Implicit methods use longer time
+# steps (limited by -max_dt), so their results differ from explicit ones by the time
+# discretization error; Crank-Nicolson is second order and should be closer.
+methods = [("explicit",       "end.nc",    1e-3),
+           ("backward_euler", "end-be.nc", 5e-2),
+           ("crank_nicolson", "end-cn.nc", 2e-2)]
+
+
 def cleanup():
-    for fname in ("inputforP_regression.nc", "testPconfig.nc", "end.nc"):
+    for fname in ["inputforP_regression.nc", "testPconfig.nc"] + [m[1] for m in methods]:
         os.remove(fname)
 
 if __name__ == "__main__":
@@ -121,11 +132,12 @@ if __name__ == "__main__":
     print "Generating the -config_override file..."
     generate_config()
 
-    print "Running PISM..."
-    run_pism(opts)
+    for method, output, tolerance in methods:
+        print "Running PISM (%s)..." % method
+        run_pism(opts, method, output)
 
-    print "Checking the drift..."
-    check_drift("inputforP_regression.nc", "end.nc")
+        print "Checking the drift..."
+        check_drift("inputforP_regression.nc", output, tolerance)
 
     print "Cleaning up..."
     cleanup()
@@ -45,7 +45,7 @@ big_events = ["basal_yield_stress",
 small_events = {}
 small_events["energy"] = ["ice_energy", "btu"];
 small_events["stress_balance"] = ["stress_balance.shallow", "stress_balance.modifier",
-                                  "stress_balance.strain_heat", "stress_balance.vertical_velocity"]
+                                  "stress_balance.vertical_velocity_and_strain_heat"]
 small_events["stress_balance.modifier"] = ["sia.bed_smoother",
                                            "sia.gradient", "sia.flux", "sia.valocity"]
 small_events["io"] = ["io.backup", "io.extra_file", "io.model_state"]
@@ -0,0 +1,121 @@
+#!/usr/bin/env python
+
+"""Stress balance benchmark.
+
+Runs SSA verification test executables (ssa_testi and friends) and
+siafd_test for a range of grid sizes and MPI rank counts and collects
+performance data (assembly and solve times, nonlinear and Krylov
+iteration counts, memory high-water marks) saved by each run using the
+-benchmark_output option. All results are written to one JSON file.
+
+Example:
+
+    stressbalance_benchmark.py --bin-dir ~/pism/bin --sizes 61,121,241 \\
+        --ranks 1,2,4 --output benchmark.json
+
+Extra options are passed to all test executables, so the same sweep can
+be used to compare solver options:
+
+    stressbalance_benchmark.py --solvers ssafd -- -ssafd_active_set
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+# executable and options corresponding to each solver
+SOLVERS = {"ssafd": ("ssa_testi", ["-ssa_method", "fd"]),
+           "ssafem": ("ssa_testi", ["-ssa_method", "fem"]),
+           "siafd": ("siafd_test", [])}
+
+
+def grid_options(solver, size):
+    "Grid size options for a given solver."
+    if solver == "siafd":
+        return ["-Mx", str(size), "-My", str(size)]
+    # test I is a y-dependent ice stream; its domain is narrow in x
+    return ["-Mx", str(max(size // 10, 5)), "-My", str(size)]
+
+
+def run(args, solver, size, ranks, extra_options):
+    "Run one benchmark case and return its results (a dict)."
+    executable, options = SOLVERS[solver]
+
+    with tempfile.NamedTemporaryFile(suffix=".json", delete=False) as f:
+        report = f.name
+    output = report.replace(".json", ".nc")
+
+    command = args.mpiexec.split() + ["-n", str(ranks),
+                                      os.path.join(args.bin_dir, executable)]
+    command += options + grid_options(solver, size)
+    command += ["-verbose", "1", "-o", output, "-benchmark_output", report]
+    command += extra_options
+
+    print("# " + " ".join(command))
+    sys.stdout.flush()
+
+    try:
+        with open(os.devnull, "w") as devnull:
+            subprocess.check_call(command, stdout=devnull)
+
+        with open(report) as f:
+            result = json.load(f)
+    finally:
+        for filename in [report, output]:
+            if os.path.exists(filename):
+                os.remove(filename)
+
+    result["options"] = " ".join(extra_options)
+
+    return result
+
+
+def parse_list(string):
+    return [x.strip() for x in string.split(",") if len(x.strip()) > 0]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--bin-dir", default=".",
+                        help="directory containing PISM test executables")
+    parser.add_argument("--mpiexec", default="mpiexec",
+                        help="MPI launcher (including its options)")
+    parser.add_argument("--solvers", default="ssafd,ssafem,siafd",
+                        help="comma-separated list of solvers (%s)" % ",".join(sorted(SOLVERS.keys())))
+    parser.add_argument("--sizes", default="61,121,241",
+                        help="comma-separated list of grid sizes")
+    parser.add_argument("--ranks", default="1,2,4",
+                        help="comma-separated list of MPI rank counts")
+    parser.add_argument("--output", default="stressbalance_benchmark.json",
+                        help="output file name")
+    parser.add_argument("extra_options", nargs="*",
+                        help="options passed to test executables (use -- to separate them)")
+
+    args = parser.parse_args()
+
+    solvers = parse_list(args.solvers)
+    for s in solvers:
+        if s not in SOLVERS:
+            parser.error("unknown solver: %s" % s)
+
+    results = []
+    for solver in solvers:
+        for size in [int(x) for x in parse_list(args.sizes)]:
+            for ranks in [int(x) for x in parse_list(args.ranks)]:
+                results.append(run(args, solver, size, ranks, args.extra_options))
+
+    with open(args.output, "w") as f:
+        json.dump({"benchmarks": results}, f, indent=2, sort_keys=True)
+        f.write("\n")
+
+    print("# Saved %d results to %s" % (len(results), args.output))
+
+
+if __name__ == "__main__":
+    main()